@@ -1,5 +1,6 @@
 #include <elle/Buffer.hh>
 
+#include <atomic>
 #include <bitset>
 #include <iomanip>
 #include <iostream>
@@ -13,12 +14,14 @@
 #include <elle/finally.hh>
 #include <elle/format/hexadecimal.hh>
 #include <elle/log.hh>
+#include <elle/printf.hh>
 
 ELLE_LOG_COMPONENT("elle.Buffer");
 
 namespace
 {
-  constexpr auto elle_buffer_initial_size = elle::Buffer::Size(sizeof(void*));
+  std::atomic<elle::Buffer::Size> allocation_count{0};
+  std::atomic<elle::Buffer::Size> reallocation_count{0};
 
   // FIXME: std::string_view.
   // FIXME: make sure uint32_t is large enough.
@@ -147,31 +150,27 @@ namespace elle
   | Buffer |
   `-------*/
 
+  constexpr Buffer::Size Buffer::inline_capacity;
+
   // Note that an empty buffer has a valid pointer to a memory region with
   // a size of zero.
   Buffer::Buffer()
     : _size(0)
-    , _capacity(elle_buffer_initial_size)
-    , _contents(static_cast<Byte*>(malloc(elle_buffer_initial_size)))
+    , _capacity(inline_capacity)
+    , _contents(this->_inline)
+    , _allocator(nullptr)
+  {}
+
+  Buffer::Buffer(Allocator& allocator)
+    : Buffer()
   {
-    if (this->_contents == nullptr)
-      throw std::bad_alloc();
+    this->_allocator = &allocator;
   }
 
   Buffer::Buffer(void const* data, Buffer::Size size)
-    : _size(0)
-    , _capacity(0)
-    , _contents(nullptr)
+    : Buffer()
   {
-    if (size == 0)
-    {
-      this->_capacity = elle_buffer_initial_size;
-      if ((this->_contents =
-           static_cast<Byte*>(::malloc(_capacity))) == nullptr)
-        throw std::bad_alloc();
-    }
-    else
-      this->append(data, size);
+    this->append(data, size);
   }
 
   Buffer::Buffer(char const* data)
@@ -183,21 +182,17 @@ namespace elle
   {}
 
   Buffer::Buffer(Buffer&& other)
-    : _size(0)
-    , _capacity(0)
-    , _contents(nullptr)
+    : Buffer()
   {
     (*this) = std::move(other);
   }
 
   Buffer::Buffer(Buffer const& source)
-    : _size(source._size)
-    , _capacity(source._size)
-    , _contents(static_cast<Byte*>(::malloc(this->_capacity)))
+    : Buffer()
   {
-    if (!this->_contents)
-      throw std::bad_alloc();
-    memcpy(this->_contents, source._contents, this->_size);
+    this->reserve(source._size);
+    memcpy(this->_contents, source._contents, source._size);
+    this->_size = source._size;
   }
 
   Buffer::Buffer(ConstWeakBuffer const& source)
@@ -207,32 +202,40 @@ namespace elle
   Buffer&
   Buffer::operator = (Buffer&& other)
   {
-    ::free(this->_contents);
+    if (this == &other)
+      return *this;
+    this->_free();
+    this->_allocator = other._allocator;
+    if (other._inlined())
+      memcpy(this->_inline, other._inline, other._size);
+    else
+    {
+      this->_contents = other._contents;
+      this->_capacity = other._capacity;
+      other._contents = other._inline;
+      other._capacity = inline_capacity;
+    }
     this->_size = other._size;
-    this->_capacity = other._capacity;
-    this->_contents = other._contents;
-    // XXX: this cost a lot !
-    other._contents = static_cast<Byte*>(malloc(elle_buffer_initial_size));
     other._size = 0;
-    other._capacity = elle_buffer_initial_size;
     return *this;
   }
 
   Buffer::~Buffer()
   {
-    ::free(this->_contents);
+    this->_free();
   }
 
   void
-  Buffer::capacity(SizeArg capacity_)
+  Buffer::capacity(SizeArg capacity)
   {
-    auto const capacity = std::max(capacity_, elle_buffer_initial_size);
-    auto tmp = ::realloc(this->_contents, capacity);
-    if (tmp == nullptr)
-      throw std::bad_alloc();
-    this->_contents = static_cast<Byte*>(tmp);
-    this->_capacity = capacity;
-    this->_size = std::min(this->_size, capacity);
+    this->_reallocate(capacity);
+  }
+
+  void
+  Buffer::reserve(Size capacity)
+  {
+    if (this->_capacity < capacity)
+      this->_reallocate(capacity);
   }
 
   void Buffer::append(void const* data, Buffer::Size size)
@@ -254,14 +257,7 @@ namespace elle
   Buffer::size(SizeArg size)
   {
     if (this->_capacity < size)
-    {
-      auto capacity = Buffer::_next_size(size);
-      auto tmp = ::realloc(_contents, capacity);
-      if (tmp == nullptr)
-        throw std::bad_alloc();
-      this->_contents = static_cast<Byte*>(tmp);
-      this->_capacity = capacity;
-    }
+      this->_reallocate(Buffer::_next_size(size));
     this->_size = size;
   }
 
@@ -274,17 +270,96 @@ namespace elle
   Buffer::ContentPair
   Buffer::release()
   {
-    Byte* new_contents = static_cast<Byte*>(::malloc(elle_buffer_initial_size));
-    if (new_contents == nullptr)
-      throw std::bad_alloc{};
-
+    // Only malloc'd memory can be handed over to a MallocDeleter.
+    if (this->_inlined() || this->_allocator)
+    {
+      auto data = static_cast<Byte*>(
+        ::malloc(std::max(this->_size, Size(1))));
+      if (data == nullptr)
+        throw std::bad_alloc{};
+      memcpy(data, this->_contents, this->_size);
+      auto res = ContentPair{ContentPtr{data}, this->_size};
+      this->_free();
+      this->_size = 0;
+      return res;
+    }
     auto res = ContentPair{ContentPtr{this->_contents}, this->_size};
-    this->_contents = new_contents;
+    this->_contents = this->_inline;
     this->_size = 0;
-    this->_capacity = elle_buffer_initial_size;
+    this->_capacity = inline_capacity;
     return res;
   }
 
+  void
+  Buffer::_reallocate(Size capacity)
+  {
+    if (capacity <= inline_capacity)
+    {
+      if (!this->_inlined())
+      {
+        this->_size = std::min(this->_size, inline_capacity);
+        memcpy(this->_inline, this->_contents, this->_size);
+        this->_free();
+      }
+    }
+    else if (this->_inlined())
+    {
+      auto contents = this->_allocate(capacity);
+      memcpy(contents, this->_inline, this->_size);
+      this->_contents = contents;
+      this->_capacity = capacity;
+    }
+    else if (capacity != this->_capacity)
+    {
+      auto tmp = this->_allocator ?
+        this->_allocator->reallocate(this->_contents, this->_capacity,
+                                     capacity) :
+        ::realloc(this->_contents, capacity);
+      if (tmp == nullptr)
+        throw std::bad_alloc();
+      ++reallocation_count;
+      this->_contents = static_cast<Byte*>(tmp);
+      this->_capacity = capacity;
+    }
+    this->_size = std::min(this->_size, this->_capacity);
+  }
+
+  Buffer::Byte*
+  Buffer::_allocate(Size size)
+  {
+    auto res = this->_allocator ?
+      this->_allocator->allocate(size) : ::malloc(size);
+    if (res == nullptr)
+      throw std::bad_alloc();
+    ++allocation_count;
+    return static_cast<Byte*>(res);
+  }
+
+  void
+  Buffer::_free()
+  {
+    if (this->_inlined())
+      return;
+    if (this->_allocator)
+      this->_allocator->deallocate(this->_contents, this->_capacity);
+    else
+      ::free(this->_contents);
+    this->_contents = this->_inline;
+    this->_capacity = inline_capacity;
+  }
+
+  Buffer::Size
+  Buffer::allocations()
+  {
+    return allocation_count;
+  }
+
+  Buffer::Size
+  Buffer::reallocations()
+  {
+    return reallocation_count;
+  }
+
   Buffer::const_iterator
   Buffer::begin() const
   {
@@ -398,15 +473,8 @@ namespace elle
   void
   Buffer::shrink_to_fit()
   {
-    auto capacity = std::max(elle_buffer_initial_size, this->_size);
-    if (capacity < this->_capacity)
-    {
-      void* tmp = ::realloc(_contents, capacity);
-      if (tmp == nullptr)
-        throw std::bad_alloc();
-      this->_contents = static_cast<Byte*>(tmp);
-      this->_capacity = capacity;
-    }
+    if (this->_size < this->_capacity)
+      this->_reallocate(this->_size);
   }
 
 
@@ -652,6 +720,118 @@ namespace elle
   }
 
 
+  /*-------------.
+  | SharedBuffer |
+  `-------------*/
+
+  SharedBuffer::SharedBuffer()
+    : Super()
+    , _owner()
+  {}
+
+  SharedBuffer::SharedBuffer(Buffer&& buffer)
+    : SharedBuffer(std::make_shared<Buffer const>(std::move(buffer)))
+  {}
+
+  // Take the pointer once the buffer is in its final place, as moving inline
+  // buffers copies their content.
+  SharedBuffer::SharedBuffer(std::shared_ptr<Buffer const> owner)
+    : Super(*owner)
+    , _owner(std::move(owner))
+  {}
+
+  SharedBuffer::SharedBuffer(std::shared_ptr<Buffer const> owner,
+                             Buffer::Byte const* contents,
+                             Size size)
+    : Super(contents, size)
+    , _owner(std::move(owner))
+  {}
+
+  SharedBuffer
+  SharedBuffer::range(int start) const
+  {
+    return this->range(start, this->size());
+  }
+
+  SharedBuffer
+  SharedBuffer::range(int start, int end) const
+  {
+    auto const weak = this->Super::range(start, end);
+    return SharedBuffer(this->_owner, weak.contents(), weak.size());
+  }
+
+  long
+  SharedBuffer::use_count() const
+  {
+    return this->_owner.use_count();
+  }
+
+  Buffer
+  SharedBuffer::copy() const
+  {
+    return Buffer(this->contents(), this->size());
+  }
+
+  /*-----.
+  | Rope |
+  `-----*/
+
+  Rope::Rope()
+    : _size(0)
+    , _segments()
+  {}
+
+  void
+  Rope::append(SharedBuffer segment)
+  {
+    if (segment.empty())
+      return;
+    this->_size += segment.size();
+    this->_segments.emplace_back(std::move(segment));
+  }
+
+  bool
+  Rope::empty() const
+  {
+    return this->_size == 0;
+  }
+
+  Buffer
+  Rope::flatten() const
+  {
+    auto res = Buffer{};
+    res.reserve(this->_size);
+    for (auto const& segment: this->_segments)
+      res.append(segment.contents(), segment.size());
+    return res;
+  }
+
+  std::vector<ConstWeakBuffer>
+  Rope::weak_segments() const
+  {
+    return {this->_segments.begin(), this->_segments.end()};
+  }
+
+  std::streambuf*
+  Rope::istreambuf() const
+  {
+    static auto const empty = ConstWeakBuffer{};
+    if (this->_segments.empty())
+      return new InputStreamBuffer<ConstWeakBuffer>(empty);
+    auto res = new InputStreamBuffer<ConstWeakBuffer>(this->_segments[0]);
+    for (auto i = 1u; i < this->_segments.size(); ++i)
+      res->add(this->_segments[i]);
+    return res;
+  }
+
+  std::ostream&
+  operator <<(std::ostream& stream, Rope const& rope)
+  {
+    elle::fprintf(stream, "Rope(%s bytes in %s segments)",
+                  rope.size(), rope.segments().size());
+    return stream;
+  }
+
   /*------------------.
   | InputStreamBuffer |
   `------------------*/
@@ -720,11 +900,16 @@ namespace elle
   WeakBuffer
   OutputStreamBuffer<BufferType>::write_buffer()
   {
-    _buffer.capacity(this->_old_size + 512);
-    ELLE_DEBUG("%s: grow buffer capacity from %s to %s bytes",
-               *this, this->_old_size, this->_buffer.capacity());
+    // Fill the available capacity first, so small outputs stay inline.
+    if (this->_buffer.capacity() <= this->_old_size)
+    {
+      this->_buffer.reserve(
+        this->_old_size + std::max<size_t>(512, this->_old_size / 2));
+      ELLE_DEBUG("%s: grow buffer capacity from %s to %s bytes",
+                 *this, this->_old_size, this->_buffer.capacity());
+    }
     return {(char*)_buffer.mutable_contents() + this->_old_size,
-            512};
+            this->_buffer.capacity() - this->_old_size};
   }
 
   template <typename BufferType>
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <cstddef>
 #include <iosfwd>
 #include <limits>
 #include <memory>
+#include <vector>
 
 #include <boost/operators.hpp>
 
@@ -28,7 +30,9 @@ namespace elle
 
   /// @brief A memory zone.
   ///
-  /// The Buffer owns the pointed memory at every moment.
+  /// The Buffer owns the pointed memory at every moment.  Contents up to
+  /// inline_capacity bytes are stored within the Buffer itself, hence moving
+  /// a small Buffer copies its content and invalidates pointers to it.
   ///
   /// @see WeakBuffer for a buffer that doesn't own the memory.
   class ELLE_API Buffer
@@ -48,6 +52,28 @@ namespace elle
     using ContentPtr = std::unique_ptr<Byte, detail::MallocDeleter>;
     /// Content owned by a Buffer: data and size.
     using ContentPair = std::pair<ContentPtr, Size>;
+    /// Provider of the heap memory of a Buffer, e.g. an arena or a pool.
+    ///
+    /// The allocator must outlive every Buffer using it.
+    class ELLE_API Allocator
+    {
+    public:
+      virtual
+      ~Allocator() = default;
+      /// A memory zone of \a size bytes.
+      virtual
+      void*
+      allocate(Size size) = 0;
+      /// Resize a zone from \a old_size to \a size bytes, keeping the
+      /// content.
+      virtual
+      void*
+      reallocate(void* data, Size old_size, Size size) = 0;
+      /// Release a zone of \a size bytes.
+      virtual
+      void
+      deallocate(void* data, Size size) = 0;
+    };
 
   /*-------------.
   | Construction |
@@ -55,6 +81,9 @@ namespace elle
   public:
     /// An empty buffer.
     Buffer();
+    /// An empty buffer taking its heap memory from \a allocator.
+    explicit
+    Buffer(Allocator& allocator);
     /// An uninitialized buffer of the specified size.
     template <
       typename T,
@@ -90,6 +119,8 @@ namespace elle
     ELLE_ATTRIBUTE_Rw(Size, capacity);
     /// Buffer data.
     ELLE_ATTRIBUTE_R(Byte*, contents);
+    /// Heap memory provider, or null for malloc.
+    ELLE_ATTRIBUTE_R(Allocator*, allocator);
     /// Buffer mutable data.
     Byte*
     mutable_contents() const;
@@ -99,14 +130,44 @@ namespace elle
     /// Release internal memory.
     ContentPair
     release();
+    /// Ensure the capacity is at least \a capacity, keeping the size.
+    void
+    reserve(Size capacity);
     /// Shrink the capacity to fit the size if needed.
     void
     shrink_to_fit();
   private:
     static Size _next_size(Size);
+    /// Whether the content is stored in the Buffer itself.
+    bool
+    _inlined() const;
+    /// Move the content to storage of \a capacity bytes.
+    void
+    _reallocate(Size capacity);
+    Byte*
+    _allocate(Size size);
+    void
+    _free();
+    /// Inline storage.
+    alignas(std::max_align_t) Byte _inline[64];
 
   public:
     static constexpr Size max_size = std::numeric_limits<Size>::max();
+    /// Capacity of the inline storage.
+    static constexpr Size inline_capacity = sizeof(_inline);
+
+  /*-----------.
+  | Statistics |
+  `-----------*/
+  public:
+    /// Number of heap allocations made by all buffers.
+    static
+    Size
+    allocations();
+    /// Number of heap reallocations made by all buffers.
+    static
+    Size
+    reallocations();
 
   /*-----------.
   | Operations |
@@ -410,6 +471,110 @@ namespace elle
     istreambuf() const;
   };
 
+  /*-------------.
+  | SharedBuffer |
+  `-------------*/
+
+  /// @brief An immutable slice of a reference-counted Buffer.
+  ///
+  /// Slices of the same Buffer share its memory, which is released with the
+  /// last of them. Splitting a received packet in SharedBuffers therefore
+  /// costs no copy.
+  class ELLE_API SharedBuffer
+    : public ConstWeakBuffer
+  {
+  /*------.
+  | Types |
+  `------*/
+  public:
+    using Self = SharedBuffer;
+    using Super = ConstWeakBuffer;
+
+  /*-------------.
+  | Construction |
+  `-------------*/
+  public:
+    /// SharedBuffer with null memory segment and size.
+    SharedBuffer();
+    /// SharedBuffer owning the whole content of \a buffer.
+    SharedBuffer(Buffer&& buffer) /* implicit */;
+  private:
+    SharedBuffer(std::shared_ptr<Buffer const> owner);
+    SharedBuffer(std::shared_ptr<Buffer const> owner,
+                 Buffer::Byte const* contents,
+                 Size size);
+
+  /*--------.
+  | Content |
+  `--------*/
+  public:
+    /// A subset of this buffer, sharing its memory.
+    SharedBuffer
+    range(int start) const;
+    /// A subset of this buffer, sharing its memory.
+    SharedBuffer
+    range(int start, int end) const;
+    /// Number of SharedBuffers sharing the memory, 0 if none.
+    long
+    use_count() const;
+    /// An owned copy of the content.
+    Buffer
+    copy() const;
+  private:
+    ELLE_ATTRIBUTE(std::shared_ptr<Buffer const>, owner);
+  };
+
+  /*-----.
+  | Rope |
+  `-----*/
+
+  /// @brief A sequence of SharedBuffers, appended without copying.
+  ///
+  /// The segments can be read back as a single stream, or sent as is with a
+  /// gather write.
+  class ELLE_API Rope
+  {
+  /*-------------.
+  | Construction |
+  `-------------*/
+  public:
+    /// An empty rope.
+    Rope();
+
+  /*--------.
+  | Content |
+  `--------*/
+  public:
+    /// Append a segment, sharing its memory. Empty segments are ignored.
+    void
+    append(SharedBuffer segment);
+    /// Whether the size is 0.
+    bool
+    empty() const;
+    /// An owned copy of the whole content.
+    Buffer
+    flatten() const;
+    /// The segments as plain memory ranges, for gather writes.
+    std::vector<ConstWeakBuffer>
+    weak_segments() const;
+    /// Total size of the segments.
+    ELLE_ATTRIBUTE_R(Buffer::Size, size);
+    /// The segments, none of them empty.
+    ELLE_ATTRIBUTE_R(std::vector<SharedBuffer>, segments);
+
+  /*--------------.
+  | Serialization |
+  `--------------*/
+  public:
+    /// Construct an input streambuf reading all segments in order.
+    std::streambuf*
+    istreambuf() const;
+  };
+
+  ELLE_API
+  std::ostream&
+  operator <<(std::ostream& stream, Rope const& rope);
+
   /*----------.
   | Operators |
   `----------*/
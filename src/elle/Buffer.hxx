@@ -21,13 +21,10 @@ namespace elle
   template <typename T,
             std::enable_if_t<std::is_integral<T>::value, int>>
   Buffer::Buffer(T size)
-    : _size(static_cast<Size>(size))
-    , _capacity(size)
-    , _contents(nullptr)
+    : Buffer()
   {
-    if ((this->_contents =
-         static_cast<Byte*>(::malloc(this->_capacity))) == nullptr)
-      throw std::bad_alloc();
+    this->reserve(static_cast<Size>(size));
+    this->_size = static_cast<Size>(size);
   }
 
   inline
@@ -126,4 +123,11 @@ namespace elle
   {
     return this->_contents;
   }
+
+  inline
+  bool
+  Buffer::_inlined() const
+  {
+    return this->_contents == this->_inline;
+  }
 }
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include <elle/Duration.hh>
+#include <elle/Printable.hh>
+#include <elle/athena/paxos/Client.hh>
+#include <elle/attribute.hh>
+#include <elle/reactor/Barrier.hh>
+#include <elle/reactor/Thread.hh>
+
+namespace elle
+{
+  namespace athena
+  {
+    namespace paxos
+    {
+      /// A front end to a Client choosing many values per round.
+      ///
+      /// Values chosen concurrently are gathered in batches, each chosen as a
+      /// vector in a single round. A batch is chosen once it holds \a size
+      /// values or \a delay after its first value arrived, and values keep
+      /// gathering in the next batch meanwhile.
+      template <typename T, typename Version, typename ClientId>
+      class BatchClient
+        : public elle::Printable
+      {
+        /*------.
+        | Types |
+        `------*/
+      public:
+        using Self = BatchClient;
+        using Client = paxos::Client<std::vector<T>, Version, ClientId>;
+
+        /*-------------.
+        | Construction |
+        `-------------*/
+      public:
+        /// Create a BatchClient.
+        ///
+        /// @param client The client choosing batches.
+        /// @param version The version to choose the first batch at.
+        /// @param size The maximum number of values in a batch.
+        /// @param delay How long a value may wait for its batch to fill.
+        BatchClient(Client& client,
+                    Version version,
+                    int size = 64,
+                    Duration delay = 5_ms);
+        /// Fail values that were not chosen yet.
+        ~BatchClient();
+        ELLE_ATTRIBUTE_R((Client&), client);
+        /// The version to choose the next batch at.
+        ELLE_ATTRIBUTE_R(Version, version);
+        ELLE_ATTRIBUTE_R(int, size);
+        ELLE_ATTRIBUTE_R(Duration, delay);
+
+        /*----------.
+        | Consensus |
+        `----------*/
+      public:
+        /// Submit \a value, along with concurrent ones.
+        ///
+        /// @param value The submitted value.
+        /// @returns The version \a value was chosen at.
+        Version
+        choose(T value);
+      private:
+        struct Batch;
+        void
+        _run();
+        /// Batches waiting to be chosen.
+        ELLE_ATTRIBUTE(std::deque<std::shared_ptr<Batch>>, batches);
+        /// The batch being chosen.
+        ELLE_ATTRIBUTE(std::shared_ptr<Batch>, running);
+        /// Opened while batches wait.
+        ELLE_ATTRIBUTE(elle::reactor::Barrier, pending);
+        /// Opened while the first waiting batch is full.
+        ELLE_ATTRIBUTE(elle::reactor::Barrier, full);
+        ELLE_ATTRIBUTE(elle::reactor::Thread::unique_ptr, thread);
+
+        /*----------.
+        | Printable |
+        `----------*/
+      public:
+        void
+        print(std::ostream& output) const override;
+      };
+    }
+  }
+}
+
+#include <elle/athena/paxos/BatchClient.hxx>
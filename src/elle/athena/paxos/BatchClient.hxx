@@ -0,0 +1,160 @@
+#pragma once
+
+#include <elle/log.hh>
+#include <elle/reactor/exception.hh>
+#include <elle/reactor/scheduler.hh>
+
+namespace elle
+{
+  namespace athena
+  {
+    namespace paxos
+    {
+      /*------.
+      | Batch |
+      `------*/
+
+      template <typename T, typename Version, typename ClientId>
+      struct BatchClient<T, Version, ClientId>::Batch
+      {
+        Batch()
+          : values()
+          , start(boost::posix_time::microsec_clock::universal_time())
+          , version()
+          , error()
+          , done()
+        {}
+
+        std::vector<T> values;
+        /// When the first value arrived.
+        boost::posix_time::ptime start;
+        boost::optional<Version> version;
+        std::exception_ptr error;
+        elle::reactor::Barrier done;
+      };
+
+      /*-------------.
+      | Construction |
+      `-------------*/
+
+      template <typename T, typename Version, typename ClientId>
+      BatchClient<T, Version, ClientId>::BatchClient(Client& client,
+                                                     Version version,
+                                                     int size,
+                                                     Duration delay)
+        : _client(client)
+        , _version(std::move(version))
+        , _size(size)
+        , _delay(delay)
+        , _batches()
+        , _running()
+        , _pending("pending batches")
+        , _full("full batch")
+        , _thread()
+      {
+        ELLE_ASSERT_GT(this->_size, 0);
+        this->_thread.reset(
+          new elle::reactor::Thread(
+            elle::sprintf("%s", *this), [this] { this->_run(); }));
+      }
+
+      template <typename T, typename Version, typename ClientId>
+      BatchClient<T, Version, ClientId>::~BatchClient()
+      {
+        this->_thread.reset();
+        if (this->_running)
+          this->_batches.emplace_front(std::move(this->_running));
+        for (auto& batch: this->_batches)
+        {
+          batch->error = std::make_exception_ptr(
+            elle::Error("batch client destroyed"));
+          batch->done.open();
+        }
+      }
+
+      /*----------.
+      | Consensus |
+      `----------*/
+
+      template <typename T, typename Version, typename ClientId>
+      Version
+      BatchClient<T, Version, ClientId>::choose(T value)
+      {
+        if (this->_batches.empty() ||
+            signed(this->_batches.back()->values.size()) >= this->_size)
+          this->_batches.emplace_back(std::make_shared<Batch>());
+        auto batch = this->_batches.back();
+        batch->values.emplace_back(std::move(value));
+        this->_pending.open();
+        if (signed(this->_batches.front()->values.size()) >= this->_size)
+          this->_full.open();
+        elle::reactor::wait(batch->done);
+        if (batch->error)
+          std::rethrow_exception(batch->error);
+        return batch->version.get();
+      }
+
+      template <typename T, typename Version, typename ClientId>
+      void
+      BatchClient<T, Version, ClientId>::_run()
+      {
+        ELLE_LOG_COMPONENT("athena.paxos.BatchClient");
+        while (true)
+        {
+          elle::reactor::wait(this->_pending);
+          auto left = this->_batches.front()->start + this->_delay -
+            boost::posix_time::microsec_clock::universal_time();
+          if (!left.is_negative())
+            elle::reactor::wait(this->_full, left);
+          this->_running = std::move(this->_batches.front());
+          this->_batches.pop_front();
+          if (this->_batches.empty())
+            this->_pending.close();
+          if (this->_batches.empty() ||
+              signed(this->_batches.front()->values.size()) < this->_size)
+            this->_full.close();
+          auto& batch = *this->_running;
+          ELLE_TRACE_SCOPE("%s: choose %s values at version %s",
+                           *this, batch.values.size(), this->_version);
+          try
+          {
+            while (auto chosen =
+                   this->_client.choose(this->_version, batch.values))
+            {
+              ELLE_DEBUG("version %s was already chosen",
+                         chosen->proposal.version);
+              this->_version = chosen->proposal.version + 1;
+            }
+            batch.version = this->_version;
+            this->_version = this->_version + 1;
+          }
+          catch (elle::reactor::Terminate const&)
+          {
+            // The destructor fails the running batch.
+            throw;
+          }
+          catch (...)
+          {
+            // Fail this batch only, and keep serving the next ones.
+            ELLE_TRACE("%s: unable to choose: %s",
+                       *this, elle::exception_string());
+            batch.error = std::current_exception();
+          }
+          batch.done.open();
+          this->_running.reset();
+        }
+      }
+
+      /*----------.
+      | Printable |
+      `----------*/
+
+      template <typename T, typename Version, typename ClientId>
+      void
+      BatchClient<T, Version, ClientId>::print(std::ostream& output) const
+      {
+        elle::fprintf(output, "paxos::BatchClient(%f)", this->_client.id());
+      }
+    }
+  }
+}
@@ -4,6 +4,7 @@
 #include <elle/athena/paxos/Server.hh>
 #include <elle/attribute.hh>
 #include <elle/reactor/Barrier.hh>
+#include <elle/reactor/Thread.hh>
 
 namespace elle
 {
@@ -96,6 +97,9 @@ namespace elle
         // FIXME: the W is there only for unit tests
         ELLE_ATTRIBUTE_RX(Peers, peers);
         ELLE_ATTRIBUTE_RW(bool, conflict_backoff);
+        /// Whether, once it chose a value, to skip the proposal for the next
+        /// version until someone else proposes.
+        ELLE_ATTRIBUTE_RW(bool, lease);
 
         /*----------.
         | Consensus |
@@ -121,6 +125,11 @@ namespace elle
         std::pair<boost::optional<T>, Quorum>
         get_quorum();
         ELLE_ATTRIBUTE(int, round);
+        /// Our last confirmed proposal, if we hold the lease.
+        ELLE_ATTRIBUTE(boost::optional<Proposal>, leased);
+        /// Calls to slow peers still running after their phase returned.
+        ELLE_ATTRIBUTE(std::vector<elle::reactor::Thread::unique_ptr>,
+                       stragglers);
 
       private:
         /// Check a majority of members where reached.
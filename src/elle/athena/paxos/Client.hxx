@@ -1,11 +1,16 @@
 #pragma once
 
+#include <algorithm>
+#include <unordered_set>
+
 #include <elle/With.hh>
 #include <elle/cryptography/random.hh>
+#include <elle/finally.hh>
 
 #include <elle/reactor/Scope.hh>
 #include <elle/reactor/for-each.hh>
 #include <elle/reactor/scheduler.hh>
+#include <elle/reactor/signal.hh>
 
 namespace elle
 {
@@ -38,7 +43,10 @@ namespace elle
         : _id(id)
         , _peers(std::move(peers))
         , _conflict_backoff(true)
+        , _lease(false)
         , _round(0)
+        , _leased()
+        , _stragglers()
       {
         ELLE_ASSERT(!this->_peers.empty());
       }
@@ -47,6 +55,9 @@ namespace elle
       void
       Client<T, Version, ClientId>::peers(Peers peers)
       {
+        // Stragglers refer to the peers.
+        this->_stragglers.clear();
+        this->_leased.reset();
         this->_peers = std::move(peers);
       }
 
@@ -118,93 +129,178 @@ namespace elle
         for (auto const& peer: this->_peers)
           q.insert(peer->id());
         ELLE_DUMP("quorum: %s", q);
+        // Every phase returns once a strict majority answered, so slow peers
+        // do not slow rounds down. Their calls keep running in the
+        // background, and each peer gets the next phase once it answered the
+        // previous one, so the round survives the failure of any minority.
+        int const majority = signed(q.size()) / 2 + 1;
+        auto const self = elle::sprintf("%s", *this);
+        // Answers to a phase, shared with its stragglers and the next phase.
+        struct Answers
+        {
+          /// Peers that answered favorably.
+          std::vector<Peer*> peers;
+          /// Peers whose call is over, whatever its outcome.
+          std::unordered_set<Peer*> done;
+          /// Signaled whenever a call is over.
+          elle::reactor::Signal answered;
+          boost::optional<Accepted> previous;
+          boost::optional<Proposal> conflict;
+        };
+        // The action marking a call to a peer as over.
+        auto const over = [] (std::shared_ptr<Answers> const& answers,
+                              Peer* peer)
+          {
+            return [answers, peer]
+              {
+                answers->done.insert(peer);
+                answers->answered.signal();
+              };
+          };
+        // Wait for the call to a peer in the previous phase, possibly still
+        // running as a straggler, and return whether it answered favorably.
+        auto const favorable = [] (Answers& answers, Peer* peer)
+          {
+            while (!answers.done.count(peer))
+              elle::reactor::wait(answers.answered);
+            return std::find(answers.peers.begin(), answers.peers.end(), peer)
+              != answers.peers.end();
+          };
+        auto peers = std::vector<Peer*>{};
+        for (auto const& peer: this->_peers)
+          peers.emplace_back(peer.get());
         boost::optional<Accepted> previous;
         while (true)
         {
-          ++this->_round;
-          Proposal proposal(std::move(version), this->_round, this->_id);
-          ELLE_DEBUG("%s: send proposal: %s", *this, proposal)
+          auto const leased =
+            this->_leased && version == this->_leased->version + 1;
+          if (!leased)
+            ++this->_round;
+          Proposal proposal(std::move(version),
+                            leased ? this->_leased->round : this->_round,
+                            this->_id);
+          this->_leased.reset();
+          // Promises, none under a lease.
+          auto promised = std::shared_ptr<Answers>();
+          if (leased)
+            ELLE_DEBUG("%s: skip proposal under lease: %s", *this, proposal);
+          else
           {
-            int reached = 0;
-            elle::reactor::for_each_parallel(
-              this->_peers,
-              [&] (std::unique_ptr<Peer> const& peer) -> void
-              {
-                try
+            ELLE_DEBUG("%s: send proposal: %s", *this, proposal)
+            {
+              auto answers = std::make_shared<Answers>();
+              answers->previous = previous;
+              promised = answers;
+              auto const reached = elle::reactor::for_each_quorum(
+                peers, majority,
+                [self, q, proposal, answers, over] (Peer* peer)
                 {
-                  ELLE_DEBUG_SCOPE("%s: send proposal %s to %s",
-                                   *this, proposal, peer);
-                  if (auto p = peer->propose(q, proposal))
+                  elle::SafeFinally done(over(answers, peer));
+                  try
                   {
-                    if (!previous || previous->proposal < p->proposal)
+                    ELLE_DEBUG_SCOPE("%s: send proposal %s to %s",
+                                     self, proposal, *peer);
+                    if (auto p = peer->propose(q, proposal))
                     {
-                      // FIXME: what if previous was accepted and p is not ?
-                      ELLE_DEBUG_SCOPE("%s: value already accepted at %f: %f",
-                                       *this, p->proposal, p->value);
-                      previous = std::move(p);
+                      auto& previous = answers->previous;
+                      if (!previous || previous->proposal < p->proposal)
+                      {
+                        // FIXME: what if previous was accepted and p is not ?
+                        ELLE_DEBUG_SCOPE("%s: value already accepted at %f: %f",
+                                         self, p->proposal, p->value);
+                        previous = std::move(p);
+                      }
                     }
+                    answers->peers.emplace_back(peer);
+                    return true;
                   }
-                  ++reached;
-                }
-                catch (Unavailable const& e)
+                  catch (Unavailable const& e)
+                  {
+                    ELLE_TRACE("%s: peer %s unavailable: %s",
+                               self, *peer, e.what());
+                    return false;
+                  }
+                },
+                std::string("send proposal"),
+                &this->_stragglers);
+              previous = answers->previous;
+              if (previous && previous->confirmed)
+                return previous;
+              ELLE_TRACE("check headcount")
+                this->_check_headcount(q, reached);
+              if (previous)
+              {
+                ELLE_DEBUG("replace value with %s", previous->value);
+                if (proposal < previous->proposal)
                 {
-                  ELLE_TRACE("%s: peer %s unavailable: %s",
-                             *this, peer, e.what());
+                  version = previous->proposal.version;
+                  this->_round = previous->proposal.round;
+                  ELLE_DEBUG("retry at version %s round %s",
+                             version, this->_round);
+                  continue;
                 }
-              },
-              std::string("send proposal"));
-            if (previous && previous->confirmed)
-              return previous;
-            ELLE_TRACE("check headcount")
-              this->_check_headcount(q, reached);
-            if (previous)
-            {
-              ELLE_DEBUG("replace value with %s", previous->value);
-              if (proposal < previous->proposal)
-              {
-                version = previous->proposal.version;
-                this->_round = previous->proposal.round;
-                ELLE_DEBUG("retry at version %s round %s", version, this->_round);
-                continue;
               }
             }
           }
+          auto accepted = std::make_shared<Answers>();
           ELLE_DEBUG("%s: send acceptation", *this)
           {
-            int reached = 0;
-            bool conflicted = false;
-            elle::reactor::for_each_parallel(
-              this->_peers,
-              [&] (std::unique_ptr<Peer> const& peer) -> void
+            auto const reached = elle::reactor::for_each_quorum(
+              peers, majority,
+              [self, q, proposal, answers = accepted, promised, leased, over,
+               favorable,
+               value = previous ? previous->value : value] (Peer* peer)
               {
+                elle::SafeFinally done(over(answers, peer));
+                // Peers only accept what they promised. The value stays safe
+                // for late promises, a majority of promises already fixed it.
+                if (promised && !favorable(*promised, peer))
+                  return false;
                 try
                 {
                   ELLE_DEBUG_SCOPE("%s: send acceptation %s to %s",
-                                   *this, proposal, *peer);
-                  auto minimum = peer->accept(
-                    q, proposal, previous ? previous->value : value);
+                                   self, proposal, *peer);
+                  auto minimum = peer->accept(q, proposal, value);
                   // FIXME: If the majority doesn't conflict, the value was
                   // still chosen - right ? Take that in account.
                   if (proposal < minimum)
                   {
                     ELLE_DEBUG("%s: conflicted proposal on peer %s: %s",
-                               *this, peer, minimum);
-                    version = minimum.version;
-                    this->_round = minimum.round;
-                    conflicted = true;
+                               self, *peer, minimum);
+                    answers->conflict = minimum;
                     elle::reactor::break_parallel();
                   }
-                  ++reached;
+                  else if (minimum < proposal)
+                  {
+                    ELLE_DEBUG("%s: lease refused by peer %s: %s",
+                               self, *peer, minimum);
+                    return false;
+                  }
+                  answers->peers.emplace_back(peer);
+                  return true;
                 }
                 catch (Unavailable const& e)
                 {
                   ELLE_TRACE("%s: peer %s unavailable: %s",
-                             *this, peer, e.what());
+                             self, *peer, e.what());
+                  return false;
+                }
+                catch (typename Server::WrongQuorum const& e)
+                {
+                  // Let the full protocol sort the quorum out.
+                  if (!leased)
+                    throw;
+                  ELLE_DEBUG("%s: lease refused by peer %s: %s",
+                             self, *peer, e.what());
+                  return false;
                 }
               },
-              std::string("send acceptation"));
-            if (conflicted)
+              std::string("send acceptation"),
+              &this->_stragglers);
+            if (accepted->conflict)
             {
+              version = accepted->conflict->version;
+              this->_round = accepted->conflict->round;
               auto rn = elle::cryptography::random::generate<uint8_t>(1, 8);
               auto delay = 100_ms * rn * backoff;
               if (this->_conflict_backoff)
@@ -217,33 +313,44 @@ namespace elle
               backoff = std::min(backoff * 2, 64);
               continue;
             }
+            else if (leased && reached < majority)
+            {
+              ELLE_TRACE("%s: lease lost, propose", this);
+              version = proposal.version;
+              continue;
+            }
             else
               this->_check_headcount(q, reached);
           }
           ELLE_TRACE("%s: chose %f", this, previous ? previous->value : value);
           ELLE_DEBUG("%s: send confirmation", *this)
           {
-            auto reached = 0;
-            elle::reactor::for_each_parallel(
-              this->_peers,
-              [&] (std::unique_ptr<Peer> const& peer) -> void
+            auto const reached = elle::reactor::for_each_quorum(
+              peers, majority,
+              [self, q, proposal, accepted, favorable] (Peer* peer)
               {
+                if (!favorable(*accepted, peer))
+                  return false;
                 try
                 {
                   ELLE_DEBUG_SCOPE("%s: send confirmation %s to %s",
-                                   *this, proposal, *peer);
+                                   self, proposal, *peer);
                   peer->confirm(q, proposal);
-                  ++reached;
+                  return true;
                 }
                 catch (Unavailable const& e)
                 {
                   ELLE_TRACE("%s: peer %s unavailable: %s",
-                             *this, peer, e.what());
+                             self, *peer, e.what());
+                  return false;
                 }
               },
-              std::string("send confirmation"));
+              std::string("send confirmation"),
+              &this->_stragglers);
             this->_check_headcount(q, reached);
           }
+          if (this->_lease)
+            this->_leased = proposal;
           break;
         }
         return previous;
@@ -0,0 +1,359 @@
+#include <elle/athena/paxos/Log.hh>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#ifdef INFINIT_WINDOWS
+# include <io.h>
+#else
+# include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <cstring>
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+
+#include <elle/With.hh>
+#include <elle/crc32c.hh>
+#include <elle/err.hh>
+#include <elle/log.hh>
+#include <elle/reactor/scheduler.hh>
+
+ELLE_LOG_COMPONENT("athena.paxos.Log");
+
+namespace elle
+{
+  namespace athena
+  {
+    namespace paxos
+    {
+      namespace
+      {
+        /// Size of the header preceding every record: its size and the
+        /// CRC-32C of its size and content.
+        auto constexpr header_size = 8;
+
+        void
+        check(bool success,
+              boost::filesystem::path const& path,
+              char const* what)
+        {
+          if (!success)
+            elle::err("unable to %s %s: %s", what, path, std::strerror(errno));
+        }
+
+        int
+        open(boost::filesystem::path const& path, int flags)
+        {
+#ifdef INFINIT_WINDOWS
+          flags |= O_BINARY;
+#endif
+          auto fd = ::open(path.string().c_str(), flags, 0600);
+          check(fd >= 0, path, "open");
+          return fd;
+        }
+
+        void
+        write(int fd, boost::filesystem::path const& path, elle::Buffer const& data)
+        {
+          auto p = data.contents();
+          auto left = data.size();
+          while (left > 0)
+          {
+            auto written = ::write(fd, p, left);
+            if (written < 0 && errno == EINTR)
+              continue;
+            check(written >= 0, path, "write");
+            p += written;
+            left -= written;
+          }
+        }
+
+        void
+        sync(int fd, boost::filesystem::path const& path)
+        {
+#if defined INFINIT_WINDOWS
+          check(::_commit(fd) == 0, path, "sync");
+#elif defined INFINIT_LINUX
+          check(::fdatasync(fd) == 0, path, "sync");
+#else
+          check(::fsync(fd) == 0, path, "sync");
+#endif
+        }
+
+        void
+        put(unsigned char* output, uint32_t i)
+        {
+          output[0] = static_cast<unsigned char>(i >> 24);
+          output[1] = static_cast<unsigned char>(i >> 16);
+          output[2] = static_cast<unsigned char>(i >> 8);
+          output[3] = static_cast<unsigned char>(i);
+        }
+
+        uint32_t
+        get(unsigned char const* input)
+        {
+          return
+            uint32_t(input[0]) << 24 | uint32_t(input[1]) << 16 |
+            uint32_t(input[2]) << 8 | uint32_t(input[3]);
+        }
+
+        /// The checksum of a record, covering its size so a zeroed header
+        /// is not mistaken for an empty record.
+        uint32_t
+        checksum(unsigned char const* size, elle::ConstWeakBuffer record)
+        {
+          return elle::crc32c(record, elle::crc32c({size, 4}));
+        }
+
+        void
+        frame(elle::Buffer& output, elle::Buffer const& record)
+        {
+          unsigned char header[header_size];
+          put(header, uint32_t(record.size()));
+          put(header + 4, checksum(header, record));
+          output.append(header, header_size);
+          output.append(record.contents(), record.size());
+        }
+      }
+
+      /*-------.
+      | Commit |
+      `-------*/
+
+      struct Log::Commit
+      {
+        Commit()
+          : data()
+          , snapshot(false)
+          , error()
+          , done("log commit")
+        {}
+
+        elle::Buffer data;
+        /// Whether data replaces the whole log.
+        bool snapshot;
+        std::exception_ptr error;
+        elle::reactor::Barrier done;
+      };
+
+      /*-------------.
+      | Construction |
+      `-------------*/
+
+      Log::Log(boost::filesystem::path path)
+        : _path(std::move(path))
+        , _records()
+        , _size(0)
+        , _compacted(0)
+        , _fd(-1)
+        , _error()
+        , _pending(std::make_shared<Commit>())
+        , _running()
+        , _ready("log ready")
+        , _thread()
+      {
+        ELLE_TRACE_SCOPE("%s: open", *this);
+        auto compaction = this->_path;
+        compaction += ".new";
+        if (boost::filesystem::exists(compaction))
+        {
+          ELLE_WARN("%s: discard aborted compaction", *this);
+          boost::filesystem::remove(compaction);
+        }
+        if (boost::filesystem::exists(this->_path))
+        {
+          auto content =
+            elle::Buffer(boost::filesystem::file_size(this->_path));
+          {
+            boost::filesystem::ifstream input(this->_path, std::ios::binary);
+            input.read(reinterpret_cast<char*>(content.mutable_contents()),
+                       content.size());
+            if (!input)
+              elle::err("unable to read %s", this->_path);
+          }
+          auto offset = elle::Buffer::Size(0);
+          while (content.size() - offset >= header_size)
+          {
+            auto const h = content.contents() + offset;
+            auto const size = get(h);
+            if (content.size() - offset - header_size < size)
+              break;
+            auto const record = elle::ConstWeakBuffer(h + header_size, size);
+            if (get(h + 4) != checksum(h, record))
+              break;
+            this->_records.emplace_back(record.contents(), record.size());
+            offset += header_size + size;
+          }
+          if (offset != content.size())
+          {
+            // Records are only acknowledged once synced, so everything past
+            // a torn write was never acknowledged.
+            ELLE_WARN("%s: discard %s bytes of torn records",
+                      *this, content.size() - offset);
+            boost::filesystem::resize_file(this->_path, offset);
+          }
+          this->_size = offset;
+          ELLE_DEBUG("read %s records", this->_records.size());
+        }
+        this->_compacted = this->_size;
+        this->_fd = paxos::open(this->_path, O_WRONLY | O_CREAT | O_APPEND);
+        this->_thread.reset(
+          new elle::reactor::Thread(
+            elle::sprintf("%s", *this), [this] { this->_run(); }));
+      }
+
+      Log::~Log()
+      {
+        this->_thread.reset();
+        if (this->_fd >= 0)
+          ::close(this->_fd);
+      }
+
+      /*--------.
+      | Writing |
+      `--------*/
+
+      void
+      Log::append(elle::Buffer const& record)
+      {
+        if (this->_error)
+          std::rethrow_exception(this->_error);
+        ELLE_DUMP("%s: append %s bytes", *this, record.size());
+        frame(this->_pending->data, record);
+        this->_size += header_size + record.size();
+        this->_ready.open();
+      }
+
+      void
+      Log::compact(elle::Buffer const& snapshot)
+      {
+        if (this->_error)
+          std::rethrow_exception(this->_error);
+        ELLE_DEBUG("%s: compact to %s bytes", *this, snapshot.size());
+        // The snapshot subsumes the records not written yet.
+        this->_pending->data.reset();
+        this->_pending->snapshot = true;
+        frame(this->_pending->data, snapshot);
+        this->_size = this->_compacted = header_size + snapshot.size();
+        this->_ready.open();
+      }
+
+      void
+      Log::sync()
+      {
+        if (this->_error)
+          std::rethrow_exception(this->_error);
+        // Commits complete in order: waiting for the last one is enough.
+        auto commit = this->_ready.opened() ? this->_pending : this->_running;
+        if (!commit)
+          return;
+        elle::reactor::wait(commit->done);
+        if (commit->error)
+          std::rethrow_exception(commit->error);
+      }
+
+      void
+      Log::_run()
+      {
+        while (true)
+        {
+          elle::reactor::wait(this->_ready);
+          this->_running = std::move(this->_pending);
+          this->_pending = std::make_shared<Commit>();
+          this->_ready.close();
+          if (this->_error)
+            this->_running->error = this->_error;
+          else
+          {
+            ELLE_DEBUG_SCOPE("%s: write %s bytes",
+                             *this, this->_running->data.size());
+            try
+            {
+              // Termination waits for the write, so the file is never
+              // written once closed.
+              elle::With<elle::reactor::Thread::NonInterruptible>() << [&]
+              {
+                this->_write(this->_running);
+              };
+            }
+            catch (elle::Error const& e)
+            {
+              // The file may end with part of the records: append nothing
+              // after them, lest they be read back as valid.
+              ELLE_ERR("%s: %s", *this, e);
+              this->_error = this->_running->error = std::current_exception();
+            }
+          }
+          this->_running->done.open();
+          this->_running.reset();
+        }
+      }
+
+      void
+      Log::_write(std::shared_ptr<Commit> commit)
+      {
+        // Disk operations block, keep them off the scheduler.
+        auto const path = this->_path;
+        if (commit->snapshot)
+        {
+          auto compaction = path;
+          compaction += ".new";
+          elle::reactor::background(
+            [commit, path, compaction]
+            {
+              auto fd = paxos::open(
+                compaction, O_WRONLY | O_CREAT | O_TRUNC);
+              try
+              {
+                paxos::write(fd, compaction, commit->data);
+                paxos::sync(fd, compaction);
+              }
+              catch (...)
+              {
+                ::close(fd);
+                throw;
+              }
+              ::close(fd);
+              check(std::rename(compaction.string().c_str(),
+                                path.string().c_str()) == 0,
+                    path, "replace");
+#ifndef INFINIT_WINDOWS
+              // Make the rename itself durable.
+              auto const dir = path.has_parent_path() ?
+                path.parent_path() : boost::filesystem::path(".");
+              auto dfd = paxos::open(dir, O_RDONLY);
+              ::fsync(dfd);
+              ::close(dfd);
+#endif
+            });
+          ::close(this->_fd);
+          this->_fd = -1;
+          this->_fd = paxos::open(path, O_WRONLY | O_APPEND);
+        }
+        else
+        {
+          auto const fd = this->_fd;
+          elle::reactor::background(
+            [commit, path, fd]
+            {
+              paxos::write(fd, path, commit->data);
+              paxos::sync(fd, path);
+            });
+        }
+      }
+
+      /*----------.
+      | Printable |
+      `----------*/
+
+      void
+      Log::print(std::ostream& output) const
+      {
+        elle::fprintf(output, "paxos::Log(%s)", this->_path);
+      }
+    }
+  }
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <exception>
+#include <memory>
+#include <vector>
+
+#include <boost/filesystem/path.hpp>
+
+#include <elle/Buffer.hh>
+#include <elle/Printable.hh>
+#include <elle/attribute.hh>
+#include <elle/reactor/Barrier.hh>
+#include <elle/reactor/Thread.hh>
+
+namespace elle
+{
+  namespace athena
+  {
+    namespace paxos
+    {
+      /// An append-only log of records, synced to a file.
+      ///
+      /// Records appended while the previous ones are being synced are written
+      /// and synced together, so concurrent appenders share a single fsync.
+      /// Compacting replaces every record with a snapshot, atomically.
+      /// Once writing failed, the log refuses any further record.
+      ///
+      /// \code{.cc}
+      ///
+      /// paxos::Log log("acceptor.log");
+      /// for (auto const& record: log.records())
+      ///   replay(record);
+      /// log.append(record);
+      /// // Return once the record is on disk.
+      /// log.sync();
+      ///
+      /// \endcode
+      class Log
+        : public elle::Printable
+      {
+        /*-------------.
+        | Construction |
+        `-------------*/
+      public:
+        /// Open the log at \a path, creating it if needed.
+        ///
+        /// Records are checksummed: those truncated or torn by a crash while
+        /// being written are discarded.
+        Log(boost::filesystem::path path);
+        /// Wait for the records being written, those not written yet are
+        /// lost.
+        ~Log();
+        ELLE_ATTRIBUTE_R(boost::filesystem::path, path);
+        /// The records the log held when opened.
+        ELLE_ATTRIBUTE_R(std::vector<elle::Buffer>, records);
+
+        /*--------.
+        | Writing |
+        `--------*/
+      public:
+        /// Append \a record, durable once the next sync returns.
+        ///
+        /// @throws elle::Error if writing previously failed.
+        void
+        append(elle::Buffer const& record);
+        /// Replace all records with \a snapshot, durable once the next sync
+        /// returns.
+        ///
+        /// @throws elle::Error if writing previously failed.
+        void
+        compact(elle::Buffer const& snapshot);
+        /// Wait until every record appended so far is durable.
+        ///
+        /// @throws elle::Error if they, or previous ones, could not be
+        ///         written.
+        void
+        sync();
+        /// The size of the log, including records not synced yet.
+        ELLE_ATTRIBUTE_R(int64_t, size);
+        /// The size of the log right after the last compaction.
+        ELLE_ATTRIBUTE_R(int64_t, compacted);
+      private:
+        struct Commit;
+        void
+        _run();
+        void
+        _write(std::shared_ptr<Commit> commit);
+        ELLE_ATTRIBUTE(int, fd);
+        /// Why writing failed, if it did.
+        ELLE_ATTRIBUTE(std::exception_ptr, error);
+        /// Records waiting to be written.
+        ELLE_ATTRIBUTE(std::shared_ptr<Commit>, pending);
+        /// Records being written.
+        ELLE_ATTRIBUTE(std::shared_ptr<Commit>, running);
+        ELLE_ATTRIBUTE(elle::reactor::Barrier, ready);
+        ELLE_ATTRIBUTE(elle::reactor::Thread::unique_ptr, thread);
+
+        /*----------.
+        | Printable |
+        `----------*/
+      public:
+        void
+        print(std::ostream& output) const override;
+      };
+    }
+  }
+}
@@ -12,6 +12,7 @@
 #include <elle/attribute.hh>
 #include <elle/serialization/Serializer.hh>
 
+#include <elle/athena/paxos/Log.hh>
 #include <elle/reactor/Barrier.hh>
 
 namespace elle
@@ -183,6 +184,12 @@ namespace elle
       public:
         Server(ServerId id, Quorum quorum,
                elle::Version version = elle::serialization_tag::version);
+        /// Create a Server persisting its state to \a log, recovering the
+        /// state it holds.
+        ///
+        /// @param log The log, which must outlive the Server.
+        Server(ServerId id, Quorum quorum, Log& log,
+               elle::Version version = elle::serialization_tag::version);
         ELLE_ATTRIBUTE_R(ServerId, id);
         ELLE_ATTRIBUTE_R(Quorum, quorum);
         ELLE_ATTRIBUTE_R(boost::optional<T>, value);
@@ -199,6 +206,14 @@ namespace elle
         ///
         boost::optional<Accepted>
         propose(Quorum q, Proposal p);
+        /// Accept \a value for Proposal \a p.
+        ///
+        /// An accept for the version following a confirmed one, with the same
+        /// round and sender, implicitly proposes \a p: the sender holds a
+        /// lease until someone else proposes.
+        ///
+        /// @returns The current Proposal: greater than \a p on conflict,
+        ///          lesser if \a p was refused for lack of a lease.
         Proposal
         accept(Quorum q, Proposal p, elle::Option<T, Quorum> value);
         void
@@ -226,6 +241,56 @@ namespace elle
         };
         ELLE_ATTRIBUTE(boost::optional<VersionState>, state);
 
+        /*------------.
+        | Persistence |
+        `------------*/
+      public:
+        /// An entry of the Log: a consensus call to replay, or a snapshot of
+        /// the whole state.
+        struct Record
+        {
+          enum Kind
+          {
+            snapshot,
+            promise,
+            accept,
+            confirm,
+          };
+          Record(Kind kind,
+                 Quorum quorum,
+                 boost::optional<Proposal> proposal = {},
+                 boost::optional<elle::Option<T, Quorum>> value = {});
+          Record(elle::serialization::SerializerIn& s, elle::Version const& v);
+          void
+          serialize(elle::serialization::Serializer& s, elle::Version const& v);
+          using serialization_tag = elle::serialization_tag;
+          int kind;
+          Quorum quorum;
+          boost::optional<Proposal> proposal;
+          /// The accepted value.
+          boost::optional<elle::Option<T, Quorum>> value;
+          /// The committed value, for snapshots.
+          boost::optional<T> committed;
+          /// The current version, for snapshots.
+          boost::optional<VersionState> state;
+          bool partial;
+        };
+        /// Where the state is persisted, if anywhere.
+        ELLE_ATTRIBUTE_R(Log*, log);
+      private:
+        boost::optional<Accepted>
+        _propose(Quorum q, Proposal p);
+        void
+        _persist(Record const& record);
+        /// Wait until the state is persisted.
+        void
+        _sync();
+        /// Compact the log if it grew enough since the last snapshot.
+        void
+        _compact();
+        void
+        _replay(Record const& record);
+
       private:
         struct _Details;
         friend struct _Details;
@@ -1,10 +1,13 @@
 #pragma once
 
+#include <algorithm>
+
 #include <boost/multi_index/mem_fun.hpp>
 #include <boost/multi_index_container.hpp>
 
 #include <elle/With.hh>
 #include <elle/serialization/Serializer.hh>
+#include <elle/serialization/binary.hh>
 
 #include <elle/reactor/Scope.hh>
 
@@ -247,12 +250,29 @@ namespace elle
         , _version(version)
         , _partial(false)
         , _state()
+        , _log(nullptr)
       {
         ELLE_ASSERT_CONTAINS(this->_quorum, this->_id);
         this->_register_wrong_quorum_serialization.poke();
         this->_register_partial_state_serialization.poke();
       }
 
+      template <
+        typename T, typename Version, typename ClientId, typename ServerId>
+      Server<T, Version, ClientId, ServerId>::Server(
+        ServerId id, Quorum quorum, Log& log, elle::Version version)
+        : Server(std::move(id), std::move(quorum), version)
+      {
+        ELLE_LOG_COMPONENT("athena.paxos.Server");
+        ELLE_TRACE_SCOPE("%s: replay %s records from %s",
+                         *this, log.records().size(), log);
+        for (auto const& record: log.records())
+          this->_replay(
+            elle::serialization::binary::deserialize<Record>(
+              record, this->_version, false));
+        this->_log = &log;
+      }
+
       /*--------.
       | Details |
       `--------*/
@@ -316,6 +336,23 @@ namespace elle
           ELLE_DUMP("unconfirmed");
           return false;
         }
+
+        /// Check the sender of \a p still holds the lease it got by having
+        /// its proposal for the previous version confirmed, in which case it
+        /// may skip proposing.
+        static
+        bool
+        check_lease(Server<T, Version, CId, SId>& self, Proposal const& p)
+        {
+          return !self._partial &&
+            self._state &&
+            self._state->proposal.version == p.version - 1 &&
+            self._state->proposal.round == p.round &&
+            self._state->proposal.sender == p.sender &&
+            self._state->accepted &&
+            self._state->accepted->confirmed &&
+            self._state->accepted->proposal == self._state->proposal;
+        }
       };
 
       /*----------.
@@ -326,6 +363,16 @@ namespace elle
         typename T, typename Version, typename ClientId, typename ServerId>
       boost::optional<typename Server<T, Version, ClientId, ServerId>::Accepted>
       Server<T, Version, ClientId, ServerId>::propose(Quorum q, Proposal p)
+      {
+        auto res = this->_propose(std::move(q), std::move(p));
+        this->_sync();
+        return res;
+      }
+
+      template <
+        typename T, typename Version, typename ClientId, typename ServerId>
+      boost::optional<typename Server<T, Version, ClientId, ServerId>::Accepted>
+      Server<T, Version, ClientId, ServerId>::_propose(Quorum q, Proposal p)
       {
         ELLE_LOG_COMPONENT("athena.paxos.Server");
         ELLE_TRACE_SCOPE("%s: get proposal: %s ", *this, p);
@@ -338,6 +385,7 @@ namespace elle
             p.version, this->_state->accepted->proposal.version);
           return this->_state->accepted;
         }
+        this->_persist(Record(Record::promise, q, p));
         if (_Details::check_confirmed(*this, p))
         {
           if (this->_state && p.version > this->_state->proposal.version)
@@ -391,18 +439,41 @@ namespace elle
         ELLE_TRACE_SCOPE("%s: accept for %f: %f", *this, p, value);
         if (!this->_partial)
           _Details::check_quorum(*this, q);
-        if (!this->_state || this->_state->proposal < p)
+        if (this->_state && this->_state->proposal.version < p.version)
+        {
+          if (!_Details::check_lease(*this, p))
+          {
+            ELLE_TRACE("refuse accept for version %s without a lease",
+                       p.version);
+            this->_sync();
+            return this->_state->proposal;
+          }
+          ELLE_DEBUG("accept for version %s under lease", p.version);
+          this->_propose(q, p);
+        }
+        if (!this->_state)
         {
           ELLE_WARN("%s: someone malicious sent an accept before propose",
                     this);
           elle::err("propose before accepting");
         }
+        if (this->_state->proposal < p)
+        {
+          // A lease holder skipped proposing while someone else, with a
+          // lesser proposal, did: refuse, as we promised it nothing.
+          ELLE_TRACE("refuse accept without a promise, current proposal is %s",
+                     this->_state->proposal);
+          this->_sync();
+          return this->_state->proposal;
+        }
         if (p < this->_state->proposal)
         {
           ELLE_TRACE("discard obsolete accept, current proposal is %s",
                      this->_state->proposal);
+          this->_sync();
           return this->_state->proposal;
         }
+        this->_persist(Record(Record::accept, q, p, value));
         auto& version = *this->_state;
         if (!(p < version.proposal))
         {
@@ -415,6 +486,7 @@ namespace elle
             version.accepted->value = std::move(value);
           }
         }
+        this->_sync();
         return version.proposal;
       }
 
@@ -444,13 +516,16 @@ namespace elle
         auto& accepted = *this->_state->accepted;
         if (!accepted.confirmed)
         {
+          this->_persist(Record(Record::confirm, q, p));
           accepted.confirmed = true;
           if (this->_partial)
           {
             this->_quorum = q;
             this->_partial = false;
           }
+          this->_compact();
         }
+        this->_sync();
       }
 
       template <typename T, typename Version, typename CId, typename SId>
@@ -477,7 +552,13 @@ namespace elle
                  && this->_state->accepted->value.template is<T>())
           return this->_state->accepted;
         else if (this->_value)
-          return Accepted(this->_state->proposal, *this->_value, true);
+          // The committed value belongs to the previous version: rank it
+          // below servers that already confirmed the current one.
+          return Accepted(
+            Proposal(this->_state->version() - 1,
+                     this->_state->proposal.round,
+                     this->_state->proposal.sender),
+            *this->_value, true);
         else
           return {};
       }
@@ -542,6 +623,135 @@ namespace elle
         return this->proposal.version;
       }
 
+      /*------------.
+      | Persistence |
+      `------------*/
+
+      template <
+        typename T, typename Version, typename ClientId, typename ServerId>
+      Server<T, Version, ClientId, ServerId>::Record::Record(
+        Kind kind_,
+        Quorum quorum_,
+        boost::optional<Proposal> proposal_,
+        boost::optional<elle::Option<T, Quorum>> value_)
+        : kind(kind_)
+        , quorum(std::move(quorum_))
+        , proposal(std::move(proposal_))
+        , value(std::move(value_))
+        , committed()
+        , state()
+        , partial(false)
+      {}
+
+      template <
+        typename T, typename Version, typename ClientId, typename ServerId>
+      Server<T, Version, ClientId, ServerId>::Record::Record(
+        elle::serialization::SerializerIn& s, elle::Version const& v)
+        : kind(snapshot)
+        , quorum()
+        , proposal()
+        , value()
+        , committed()
+        , state()
+        , partial(false)
+      {
+        this->serialize(s, v);
+      }
+
+      template <
+        typename T, typename Version, typename ClientId, typename ServerId>
+      void
+      Server<T, Version, ClientId, ServerId>::Record::serialize(
+        elle::serialization::Serializer& s, elle::Version const& v)
+      {
+        s.serialize("kind", this->kind);
+        s.serialize("quorum", this->quorum);
+        s.serialize("proposal", this->proposal);
+        s.serialize("value", this->value);
+        s.serialize("committed", this->committed);
+        s.serialize("state", this->state);
+        s.serialize("partial", this->partial);
+      }
+
+      template <
+        typename T, typename Version, typename ClientId, typename ServerId>
+      void
+      Server<T, Version, ClientId, ServerId>::_persist(Record const& record)
+      {
+        if (this->_log)
+          this->_log->append(
+            elle::serialization::binary::serialize(
+              record, this->_version, false));
+      }
+
+      template <
+        typename T, typename Version, typename ClientId, typename ServerId>
+      void
+      Server<T, Version, ClientId, ServerId>::_sync()
+      {
+        if (this->_log)
+          this->_log->sync();
+      }
+
+      template <
+        typename T, typename Version, typename ClientId, typename ServerId>
+      void
+      Server<T, Version, ClientId, ServerId>::_compact()
+      {
+        ELLE_LOG_COMPONENT("athena.paxos.Server");
+        // Rewrite the state once records outweigh it, so replaying the log
+        // costs at most a few times the state size.
+        if (!this->_log ||
+            this->_log->size() <=
+            std::max<int64_t>(2 * this->_log->compacted(), 1 << 16))
+          return;
+        ELLE_DEBUG_SCOPE("%s: compact %s", *this, *this->_log);
+        auto record = Record(Record::snapshot, this->_quorum);
+        record.committed = this->_value;
+        record.state = this->_state;
+        record.partial = this->_partial;
+        this->_log->compact(
+          elle::serialization::binary::serialize(
+            record, this->_version, false));
+      }
+
+      template <
+        typename T, typename Version, typename ClientId, typename ServerId>
+      void
+      Server<T, Version, ClientId, ServerId>::_replay(Record const& record)
+      {
+        ELLE_LOG_COMPONENT("athena.paxos.Server");
+        ELLE_DUMP_SCOPE("%s: replay record %s", *this, record.kind);
+        try
+        {
+          switch (record.kind)
+          {
+            case Record::snapshot:
+              this->_quorum = record.quorum;
+              this->_value = record.committed;
+              this->_state = record.state;
+              this->_partial = record.partial;
+              break;
+            case Record::promise:
+              this->_propose(record.quorum, record.proposal.get());
+              break;
+            case Record::accept:
+              this->accept(
+                record.quorum, record.proposal.get(), record.value.get());
+              break;
+            case Record::confirm:
+              this->confirm(record.quorum, record.proposal.get());
+              break;
+            default:
+              elle::err("unknown paxos log record: %s", record.kind);
+          }
+        }
+        // Proposals that committed the previous version before failing fail
+        // again.
+        catch (WrongQuorum const&)
+        {}
+      }
+
       /*--------------.
       | Serialization |
       `--------------*/
@@ -0,0 +1,85 @@
+#include <elle/crc32c.hh>
+
+#include <array>
+#include <cstring>
+
+#if defined __x86_64__ && (defined __GNUC__ || defined __clang__)
+# define ELLE_CRC32C_SSE42
+# include <nmmintrin.h>
+#endif
+
+namespace elle
+{
+  namespace
+  {
+    // Reflected Castagnoli polynomial.
+    constexpr auto polynomial = uint32_t(0x82f63b78);
+
+    std::array<uint32_t, 256>
+    make_table()
+    {
+      auto res = std::array<uint32_t, 256>{};
+      for (auto i = 0u; i < res.size(); ++i)
+      {
+        auto crc = uint32_t(i);
+        for (int bit = 0; bit < 8; ++bit)
+          crc = (crc & 1) ? (crc >> 1) ^ polynomial : crc >> 1;
+        res[i] = crc;
+      }
+      return res;
+    }
+
+#ifdef ELLE_CRC32C_SSE42
+    __attribute__((target("sse4.2")))
+    uint32_t
+    crc32c_sse42(ConstWeakBuffer data, uint32_t crc)
+    {
+      auto p = data.contents();
+      auto size = data.size();
+      auto state = uint64_t(~crc);
+      for (; size >= 8; p += 8, size -= 8)
+      {
+        uint64_t word;
+        std::memcpy(&word, p, sizeof word);
+        state = _mm_crc32_u64(state, word);
+      }
+      auto res = uint32_t(state);
+      for (; size > 0; ++p, --size)
+        res = _mm_crc32_u8(res, *p);
+      return ~res;
+    }
+#endif
+
+    using Kernel = uint32_t (*)(ConstWeakBuffer, uint32_t);
+
+    Kernel
+    select_kernel()
+    {
+#ifdef ELLE_CRC32C_SSE42
+      if (__builtin_cpu_supports("sse4.2"))
+        return &crc32c_sse42;
+#endif
+      return &detail::crc32c_software;
+    }
+  }
+
+  uint32_t
+  crc32c(ConstWeakBuffer data, uint32_t crc)
+  {
+    static auto const kernel = select_kernel();
+    return kernel(data, crc);
+  }
+
+  namespace detail
+  {
+    uint32_t
+    crc32c_software(ConstWeakBuffer data, uint32_t crc)
+    {
+      static auto const table = make_table();
+      auto res = ~crc;
+      for (auto byte: data)
+        res = table[(res ^ byte) & 0xff] ^ (res >> 8);
+      return ~res;
+    }
+  }
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+
+#include <elle/Buffer.hh>
+#include <elle/compiler.hh>
+
+namespace elle
+{
+  /// CRC-32C (Castagnoli) of \a data.
+  ///
+  /// Uses the SSE4.2 crc32 instruction when the CPU supports it, a lookup
+  /// table otherwise.
+  ///
+  /// @param data The data to checksum.
+  /// @param crc  The checksum of the preceding data, to checksum in several
+  ///             steps.
+  ELLE_API
+  uint32_t
+  crc32c(ConstWeakBuffer data, uint32_t crc = 0);
+
+  namespace detail
+  {
+    /// Table-driven CRC-32C, whatever the CPU.
+    ELLE_API
+    uint32_t
+    crc32c_software(ConstWeakBuffer data, uint32_t crc = 0);
+  }
+}
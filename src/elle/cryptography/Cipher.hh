@@ -35,7 +35,8 @@ namespace elle
       cbc,
       ecb,
       cfb,
-      ofb
+      ofb,
+      gcm
     };
 
     /*----------.
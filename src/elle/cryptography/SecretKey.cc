@@ -1,6 +1,7 @@
 #include <elle/cryptography/SecretKey.hh>
 #include <elle/cryptography/random.hh>
 #include <elle/cryptography/Cipher.hh>
+#include <elle/cryptography/Error.hh>
 #include <elle/cryptography/cryptography.hh>
 #include <elle/cryptography/raw.hh>
 
@@ -85,6 +86,10 @@ namespace elle
                         Mode const mode,
                         Oneway const oneway) const
     {
+      // The stream format has no room for authentication tags.
+      if (mode == Mode::gcm)
+        throw Error(elle::sprintf("unable to encipher a stream in %s mode, use "
+                                  "encipher_chunked()", mode));
       ::EVP_CIPHER const* function_cipher = cipher::resolve(cipher, mode);
       ::EVP_MD const* function_oneway = oneway::resolve(oneway);
       raw::symmetric::encipher(this->_password,
@@ -101,6 +106,10 @@ namespace elle
                         Mode const mode,
                         Oneway const oneway) const
     {
+      // The stream format has no room for authentication tags.
+      if (mode == Mode::gcm)
+        throw Error(elle::sprintf("unable to decipher a stream in %s mode, use "
+                                  "decipher_chunked()", mode));
       ::EVP_CIPHER const* function_cipher = cipher::resolve(cipher, mode);
       ::EVP_MD const* function_oneway = oneway::resolve(oneway);
       raw::symmetric::decipher(this->_password,
@@ -110,6 +119,57 @@ namespace elle
                                plain);
     }
 
+    elle::Buffer
+    SecretKey::encipher_chunked(elle::ConstWeakBuffer const& plain,
+                                int threads,
+                                uint32_t chunk_size,
+                                Cipher const cipher,
+                                Oneway const oneway) const
+    {
+      ::EVP_CIPHER const* function_cipher = cipher::resolve(cipher, Mode::gcm);
+      ::EVP_MD const* function_oneway = oneway::resolve(oneway);
+      return raw::symmetric::chunked::encipher(this->_password,
+                                               function_cipher,
+                                               function_oneway,
+                                               plain,
+                                               chunk_size,
+                                               threads);
+    }
+
+    elle::Buffer
+    SecretKey::decipher_chunked(elle::ConstWeakBuffer const& code,
+                                int threads,
+                                Cipher const cipher,
+                                Oneway const oneway) const
+    {
+      ::EVP_CIPHER const* function_cipher = cipher::resolve(cipher, Mode::gcm);
+      ::EVP_MD const* function_oneway = oneway::resolve(oneway);
+      return raw::symmetric::chunked::decipher(this->_password,
+                                               function_cipher,
+                                               function_oneway,
+                                               code,
+                                               threads);
+    }
+
+    elle::Buffer
+    SecretKey::decipher_chunk(elle::ConstWeakBuffer const& header,
+                              elle::ConstWeakBuffer const& chunk,
+                              uint64_t index,
+                              uint64_t size,
+                              Cipher const cipher,
+                              Oneway const oneway) const
+    {
+      ::EVP_CIPHER const* function_cipher = cipher::resolve(cipher, Mode::gcm);
+      ::EVP_MD const* function_oneway = oneway::resolve(oneway);
+      return raw::symmetric::chunked::decipher_chunk(this->_password,
+                                                     function_cipher,
+                                                     function_oneway,
+                                                     header,
+                                                     chunk,
+                                                     index,
+                                                     size);
+    }
+
     uint32_t
     SecretKey::size() const
     {
@@ -35,6 +35,7 @@ namespace elle
         static Cipher const cipher = Cipher::aes256;
         static Mode const mode = Mode::cbc;
         static Oneway const oneway = Oneway::sha256;
+        static uint32_t const chunk_size = 65536;
       };
 
       /*-------------.
@@ -84,6 +85,39 @@ namespace elle
                Cipher const cipher = defaults::cipher,
                Mode const mode = defaults::mode,
                Oneway const oneway = defaults::oneway) const;
+      /// Encipher a given plain text in chunks authenticated independently,
+      /// in GCM mode.
+      ///
+      /// The chunks are enciphered in parallel on the given number of
+      /// threads, and can be deciphered individually with decipher_chunk().
+      elle::Buffer
+      encipher_chunked(elle::ConstWeakBuffer const& plain,
+                       int threads = 1,
+                       uint32_t chunk_size = defaults::chunk_size,
+                       Cipher const cipher = defaults::cipher,
+                       Oneway const oneway = defaults::oneway) const;
+      /// Decipher a code produced by encipher_chunked() on the given number
+      /// of threads.
+      ///
+      /// @throw Error if the code was altered.
+      elle::Buffer
+      decipher_chunked(elle::ConstWeakBuffer const& code,
+                       int threads = 1,
+                       Cipher const cipher = defaults::cipher,
+                       Oneway const oneway = defaults::oneway) const;
+      /// Decipher the chunk at the given index of a code of the given total
+      /// size produced by encipher_chunked(), i.e. the plain text starting at
+      /// index times the chunk size.
+      ///
+      /// Only the code's header and the chunk's bytes, tag included, are
+      /// needed, see raw::symmetric::chunked for their sizes.
+      elle::Buffer
+      decipher_chunk(elle::ConstWeakBuffer const& header,
+                     elle::ConstWeakBuffer const& chunk,
+                     uint64_t index,
+                     uint64_t size,
+                     Cipher const cipher = defaults::cipher,
+                     Oneway const oneway = defaults::oneway) const;
       /// Return the size, in bytes, of the secret key.
       uint32_t
       size() const;
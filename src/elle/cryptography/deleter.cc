@@ -20,6 +20,17 @@ namespace elle
           ::BN_clear_free(bn);
       }
 
+      /*---------------.
+      | EVP_CIPHER_CTX |
+      `---------------*/
+
+      void
+      EVP_CIPHER_CTX::operator ()(::EVP_CIPHER_CTX* ctx)
+      {
+        if (ctx != nullptr)
+          ::EVP_CIPHER_CTX_free(ctx);
+      }
+
       /*---------.
       | EVP_PKEY |
       `---------*/
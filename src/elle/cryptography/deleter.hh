@@ -22,6 +22,16 @@ namespace elle
         operator ()(::BIGNUM* bn);
       };
 
+      /*---------------.
+      | EVP_CIPHER_CTX |
+      `---------------*/
+
+      struct EVP_CIPHER_CTX
+      {
+        void
+        operator ()(::EVP_CIPHER_CTX* ctx);
+      };
+
       /*---------.
       | EVP_PKEY |
       `---------*/
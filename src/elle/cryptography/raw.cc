@@ -21,7 +21,11 @@
 #include <openssl/evp.h>
 
 
+#include <algorithm>
+#include <atomic>
+#include <mutex>
 #include <thread>
+#include <vector>
 
 #if defined(ELLE_CRYPTOGRAPHY_ROTATION)
 ELLE_LOG_COMPONENT("elle.cryptography.raw");
@@ -826,6 +830,442 @@ namespace elle
 
           ELLE_CRYPTOGRAPHY_FINALLY_ABORT(context);
         }
+
+        /// Authenticated encryption in independent chunks.
+        namespace chunked
+        {
+          /*----------.
+          | Constants |
+          `----------*/
+
+          /// Identify codes produced in chunks.
+          static char const magic[] = "Chunked_";
+          /// The version of the format, bumped on incompatible changes.
+          static uint8_t const version = 1;
+          /// The largest chunk size, so that chunks fit in an int.
+          static uint32_t const chunk_size_max = 1u << 30;
+          static_assert(header_size ==
+                        sizeof (magic) - 1 + 1 + 4 + PKCS5_SALT_LEN,
+                        "invalid chunked header size");
+
+          /*-----------------.
+          | Static Functions |
+          `-----------------*/
+
+          /// The layout of a code, as described by its header.
+          struct Layout
+          {
+            unsigned char const* header;
+            uint32_t chunk_size;
+            unsigned char key[EVP_MAX_KEY_LENGTH];
+            unsigned char iv[EVP_MAX_IV_LENGTH];
+            int iv_size;
+
+            /// The size of a chunk and its tag.
+            uint64_t
+            stride() const
+            {
+              return uint64_t(this->chunk_size) + tag_size;
+            }
+
+            /// Write the nonce of chunk \a index to \a nonce.
+            void
+            nonce(uint64_t index, unsigned char* nonce) const
+            {
+              ::memcpy(nonce, this->iv, this->iv_size);
+              for (int i = 0; i < 8; ++i)
+                nonce[this->iv_size - 1 - i] ^= (index >> (8 * i)) & 0xff;
+            }
+          };
+
+          static
+          void
+          _derive(Layout& layout,
+                  elle::ConstWeakBuffer const& secret,
+                  ::EVP_CIPHER const* cipher,
+                  ::EVP_MD const* oneway,
+                  unsigned char const* salt)
+          {
+            if (!(::EVP_CIPHER_flags(cipher) & EVP_CIPH_FLAG_AEAD_CIPHER))
+              throw Error("the cipher does not authenticate the code");
+            // Check that the secret key's buffer has a non-null address.
+            //
+            // Otherwise, EVP_BytesToKey() is non-deterministic :(
+            ELLE_ASSERT_NEQ(secret.contents(), nullptr);
+            if (::EVP_BytesToKey(cipher,
+                                 oneway,
+                                 salt,
+                                 secret.contents(),
+                                 secret.size(),
+                                 1,
+                                 layout.key,
+                                 layout.iv) >
+                static_cast<int>(sizeof (layout.key)))
+              throw Error("the generated key size is too large");
+            layout.iv_size = ::EVP_CIPHER_iv_length(cipher);
+            ELLE_ASSERT_GTE(layout.iv_size, 8);
+          }
+
+          static
+          Layout
+          _parse(elle::ConstWeakBuffer const& secret,
+                 ::EVP_CIPHER const* cipher,
+                 ::EVP_MD const* oneway,
+                 elle::ConstWeakBuffer const& code)
+          {
+            if (code.size() < header_size)
+              throw Error("the code is too short to hold a header");
+            auto const header = code.contents();
+            if (::memcmp(header, magic, sizeof (magic) - 1) != 0)
+              throw Error("the code was not produced in chunks");
+            auto p = header + sizeof (magic) - 1;
+            if (*p != version)
+              throw Error(elle::sprintf("unsupported chunked code version: %s",
+                                        int(*p)));
+            ++p;
+            Layout layout;
+            layout.header = header;
+            layout.chunk_size =
+              uint32_t(p[0]) << 24 | uint32_t(p[1]) << 16 |
+              uint32_t(p[2]) << 8 | uint32_t(p[3]);
+            if (layout.chunk_size == 0 || layout.chunk_size > chunk_size_max)
+              throw Error(elle::sprintf("invalid chunk size: %s",
+                                        layout.chunk_size));
+            p += 4;
+            _derive(layout, secret, cipher, oneway, p);
+            return layout;
+          }
+
+          /// The number of chunks in a code of \a size bytes, the last one
+          /// being possibly shorter.
+          static
+          uint64_t
+          _chunks(Layout const& layout, uint64_t size)
+          {
+            if (size < uint64_t(header_size) + tag_size)
+              throw Error("the code is truncated");
+            auto const body = size - header_size - tag_size;
+            // The last chunk must not be larger than the others, lest a
+            // few trailing bytes be taken as part of it.
+            if (body % layout.stride() > layout.chunk_size)
+              throw Error(elle::sprintf("invalid code size: %s", size));
+            return body / layout.stride() + 1;
+          }
+
+          static
+          types::EVP_CIPHER_CTX
+          _context(::EVP_CIPHER const* cipher,
+                   Layout const& layout,
+                   int (*init)(::EVP_CIPHER_CTX*,
+                               ::EVP_CIPHER const*,
+                               ::ENGINE*,
+                               unsigned char const*,
+                               unsigned char const*))
+          {
+            types::EVP_CIPHER_CTX context(::EVP_CIPHER_CTX_new());
+            if (!context)
+              throw Error(
+                elle::sprintf("unable to allocate a cipher context: %s",
+                              ::ERR_error_string(ERR_get_error(), nullptr)));
+            if (init(context.get(), cipher, nullptr, layout.key, nullptr) <= 0)
+              throw Error(
+                elle::sprintf("unable to initialize the cipher context: %s",
+                              ::ERR_error_string(ERR_get_error(), nullptr)));
+            return context;
+          }
+
+          /// Authenticate the header and whether the chunk is the last one,
+          /// so chunks can be neither moved between codes nor truncated.
+          static
+          void
+          _authenticate(::EVP_CIPHER_CTX* context,
+                        Layout const& layout,
+                        bool last,
+                        int (*update)(::EVP_CIPHER_CTX*,
+                                      unsigned char*,
+                                      int*,
+                                      unsigned char const*,
+                                      int))
+          {
+            unsigned char const flag = last ? 1 : 0;
+            int size(0);
+            if (update(context, nullptr, &size, layout.header, header_size) <= 0 ||
+                update(context, nullptr, &size, &flag, 1) <= 0)
+              throw Error(
+                elle::sprintf("unable to authenticate the header: %s",
+                              ::ERR_error_string(ERR_get_error(), nullptr)));
+          }
+
+          static
+          void
+          _encipher(::EVP_CIPHER_CTX* context,
+                    Layout const& layout,
+                    uint64_t index,
+                    bool last,
+                    unsigned char const* plain,
+                    int size,
+                    unsigned char* code)
+          {
+            unsigned char nonce[EVP_MAX_IV_LENGTH];
+            layout.nonce(index, nonce);
+            if (::EVP_EncryptInit_ex(context,
+                                     nullptr,
+                                     nullptr,
+                                     nullptr,
+                                     nonce) <= 0)
+              throw Error(
+                elle::sprintf("unable to initialize the encryption of "
+                              "chunk %s: %s",
+                              index,
+                              ::ERR_error_string(ERR_get_error(), nullptr)));
+            _authenticate(context, layout, last, ::EVP_EncryptUpdate);
+            int size_update(0);
+            if (size > 0 &&
+                ::EVP_EncryptUpdate(context,
+                                    code,
+                                    &size_update,
+                                    plain,
+                                    size) <= 0)
+              throw Error(
+                elle::sprintf("unable to encrypt chunk %s: %s",
+                              index,
+                              ::ERR_error_string(ERR_get_error(), nullptr)));
+            int size_final(0);
+            if (::EVP_EncryptFinal_ex(context,
+                                      code + size_update,
+                                      &size_final) <= 0 ||
+                ::EVP_CIPHER_CTX_ctrl(context,
+                                      EVP_CTRL_GCM_GET_TAG,
+                                      tag_size,
+                                      code + size) <= 0)
+              throw Error(
+                elle::sprintf("unable to finalize the encryption of "
+                              "chunk %s: %s",
+                              index,
+                              ::ERR_error_string(ERR_get_error(), nullptr)));
+            ELLE_ASSERT_EQ(size_update + size_final, size);
+          }
+
+          static
+          void
+          _decipher(::EVP_CIPHER_CTX* context,
+                    Layout const& layout,
+                    uint64_t index,
+                    bool last,
+                    unsigned char const* code,
+                    int size,
+                    unsigned char* plain)
+          {
+            unsigned char nonce[EVP_MAX_IV_LENGTH];
+            layout.nonce(index, nonce);
+            if (::EVP_DecryptInit_ex(context,
+                                     nullptr,
+                                     nullptr,
+                                     nullptr,
+                                     nonce) <= 0)
+              throw Error(
+                elle::sprintf("unable to initialize the decryption of "
+                              "chunk %s: %s",
+                              index,
+                              ::ERR_error_string(ERR_get_error(), nullptr)));
+            _authenticate(context, layout, last, ::EVP_DecryptUpdate);
+            int size_update(0);
+            if (size > 0 &&
+                ::EVP_DecryptUpdate(context,
+                                    plain,
+                                    &size_update,
+                                    code,
+                                    size) <= 0)
+              throw Error(
+                elle::sprintf("unable to decrypt chunk %s: %s",
+                              index,
+                              ::ERR_error_string(ERR_get_error(), nullptr)));
+            int size_final(0);
+            if (::EVP_CIPHER_CTX_ctrl(
+                  context,
+                  EVP_CTRL_GCM_SET_TAG,
+                  tag_size,
+                  const_cast<unsigned char*>(code + size)) <= 0 ||
+                ::EVP_DecryptFinal_ex(context,
+                                      plain + size_update,
+                                      &size_final) <= 0)
+              throw Error(
+                elle::sprintf("unable to authenticate chunk %s", index));
+            ELLE_ASSERT_EQ(size_update + size_final, size);
+          }
+
+          /// Run \a action on every chunk, spread on \a threads threads,
+          /// each with its own context.
+          static
+          void
+          _parallel(uint64_t chunks,
+                    int threads,
+                    std::function<types::EVP_CIPHER_CTX ()> const& context,
+                    std::function<void (::EVP_CIPHER_CTX*,
+                                        uint64_t)> const& action)
+          {
+            std::atomic<uint64_t> next(0);
+            std::mutex mutex;
+            std::exception_ptr error;
+            auto work = [&]
+              {
+                try
+                {
+                  auto ctx = context();
+                  for (auto i = next++; i < chunks; i = next++)
+                    action(ctx.get(), i);
+                }
+                catch (...)
+                {
+                  std::lock_guard<std::mutex> lock(mutex);
+                  if (!error)
+                    error = std::current_exception();
+                  // Have the other threads stop.
+                  next = chunks;
+                }
+              };
+            auto const n = std::max<uint64_t>(
+              1, std::min<uint64_t>(std::max(threads, 1), chunks));
+            std::vector<std::thread> pool;
+            pool.reserve(n - 1);
+            try
+            {
+              for (uint64_t i = 1; i < n; ++i)
+                pool.emplace_back(work);
+            }
+            catch (...)
+            {
+              // Stop and join the threads already started, which refer to
+              // this frame.
+              next = chunks;
+              for (auto& thread: pool)
+                thread.join();
+              throw;
+            }
+            work();
+            for (auto& thread: pool)
+              thread.join();
+            if (error)
+              std::rethrow_exception(error);
+          }
+
+          /*----------.
+          | Functions |
+          `----------*/
+
+          elle::Buffer
+          encipher(elle::ConstWeakBuffer const& secret,
+                   ::EVP_CIPHER const* cipher,
+                   ::EVP_MD const* oneway,
+                   elle::ConstWeakBuffer const& plain,
+                   uint32_t chunk_size,
+                   int threads)
+          {
+            // Make sure the cryptographic system is set up.
+            cryptography::require();
+
+            if (chunk_size == 0 || chunk_size > chunk_size_max)
+              throw Error(elle::sprintf("invalid chunk size: %s", chunk_size));
+            // An empty plain text still yields a chunk, so that the code
+            // cannot be truncated to its header.
+            auto const chunks = std::max<uint64_t>(
+              1, (plain.size() + chunk_size - 1) / chunk_size);
+            elle::Buffer code(header_size + plain.size() + chunks * tag_size);
+            // Write the header.
+            auto p = code.mutable_contents();
+            ::memcpy(p, magic, sizeof (magic) - 1);
+            p += sizeof (magic) - 1;
+            *p++ = version;
+            *p++ = (chunk_size >> 24) & 0xff;
+            *p++ = (chunk_size >> 16) & 0xff;
+            *p++ = (chunk_size >> 8) & 0xff;
+            *p++ = chunk_size & 0xff;
+            if (::RAND_bytes(p, PKCS5_SALT_LEN) <= 0)
+              throw Error(elle::sprintf("unable to randomly generate "
+                                        "a salt: %s",
+                                        ::ERR_error_string(ERR_get_error(),
+                                                           nullptr)));
+            Layout layout;
+            layout.header = code.contents();
+            layout.chunk_size = chunk_size;
+            _derive(layout, secret, cipher, oneway, p);
+            _parallel(
+              chunks, threads,
+              [&] { return _context(cipher, layout, ::EVP_EncryptInit_ex); },
+              [&] (::EVP_CIPHER_CTX* context, uint64_t i)
+              {
+                auto const offset = i * chunk_size;
+                auto const size =
+                  std::min<uint64_t>(chunk_size, plain.size() - offset);
+                _encipher(context, layout, i, i == chunks - 1,
+                          plain.contents() + offset,
+                          size,
+                          code.mutable_contents() + header_size +
+                          i * layout.stride());
+              });
+            return code;
+          }
+
+          elle::Buffer
+          decipher(elle::ConstWeakBuffer const& secret,
+                   ::EVP_CIPHER const* cipher,
+                   ::EVP_MD const* oneway,
+                   elle::ConstWeakBuffer const& code,
+                   int threads)
+          {
+            // Make sure the cryptographic system is set up.
+            cryptography::require();
+
+            auto const layout = _parse(secret, cipher, oneway, code);
+            auto const chunks = _chunks(layout, code.size());
+            elle::Buffer plain(code.size() - header_size - chunks * tag_size);
+            _parallel(
+              chunks, threads,
+              [&] { return _context(cipher, layout, ::EVP_DecryptInit_ex); },
+              [&] (::EVP_CIPHER_CTX* context, uint64_t i)
+              {
+                auto const offset = i * layout.chunk_size;
+                auto const size =
+                  std::min<uint64_t>(layout.chunk_size, plain.size() - offset);
+                _decipher(context, layout, i, i == chunks - 1,
+                          code.contents() + header_size + i * layout.stride(),
+                          size,
+                          plain.mutable_contents() + offset);
+              });
+            return plain;
+          }
+
+          elle::Buffer
+          decipher_chunk(elle::ConstWeakBuffer const& secret,
+                         ::EVP_CIPHER const* cipher,
+                         ::EVP_MD const* oneway,
+                         elle::ConstWeakBuffer const& header,
+                         elle::ConstWeakBuffer const& chunk,
+                         uint64_t index,
+                         uint64_t size)
+          {
+            // Make sure the cryptographic system is set up.
+            cryptography::require();
+
+            auto const layout = _parse(secret, cipher, oneway, header);
+            auto const chunks = _chunks(layout, size);
+            if (index >= chunks)
+              throw Error(elle::sprintf("chunk %s is out of range: %s chunks",
+                                        index, chunks));
+            auto const offset = header_size + index * layout.stride();
+            if (chunk.size() != std::min<uint64_t>(layout.stride(),
+                                                   size - offset))
+              throw Error(elle::sprintf("invalid size for chunk %s: %s",
+                                        index, chunk.size()));
+            elle::Buffer plain(chunk.size() - tag_size);
+            auto context = _context(cipher, layout, ::EVP_DecryptInit_ex);
+            _decipher(context.get(), layout, index, index == chunks - 1,
+                      chunk.contents(),
+                      plain.size(),
+                      plain.mutable_contents());
+            return plain;
+          }
+        }
       }
     }
   }
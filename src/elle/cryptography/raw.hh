@@ -119,6 +119,51 @@ namespace elle
                  std::ostream& plain,
                  std::function<void (::EVP_CIPHER_CTX*)> prolog = nullptr,
                  std::function<void (::EVP_CIPHER_CTX*)> epilog = nullptr);
+
+        /// Contain the authenticated encryption in independent chunks.
+        ///
+        /// The code starts with a header holding a magic, the version of the
+        /// format, the chunk size and a salt. Every chunk of plain text is
+        /// then enciphered with an AEAD cipher such as AES-GCM under its own
+        /// nonce and followed by its tag. Chunks are thus processed in
+        /// parallel and deciphered individually, while their tags prevent
+        /// them from being altered, reordered or truncated.
+        namespace chunked
+        {
+          /// The size of the header starting a cipher text: magic, version,
+          /// chunk size and salt.
+          static int const header_size = 8 + 1 + 4 + 8;
+          /// The size of the authentication tag following each chunk.
+          static int const tag_size = 16;
+
+          /// Encipher the plain text in chunks of the given size, on the
+          /// given number of threads.
+          elle::Buffer
+          encipher(elle::ConstWeakBuffer const& secret,
+                   ::EVP_CIPHER const* cipher,
+                   ::EVP_MD const* oneway,
+                   elle::ConstWeakBuffer const& plain,
+                   uint32_t chunk_size,
+                   int threads);
+          /// Decipher the cipher text, on the given number of threads.
+          elle::Buffer
+          decipher(elle::ConstWeakBuffer const& secret,
+                   ::EVP_CIPHER const* cipher,
+                   ::EVP_MD const* oneway,
+                   elle::ConstWeakBuffer const& code,
+                   int threads);
+          /// Decipher the chunk at the given index of a cipher text of the
+          /// given total size, provided its header and the chunk's bytes,
+          /// tag included, only.
+          elle::Buffer
+          decipher_chunk(elle::ConstWeakBuffer const& secret,
+                         ::EVP_CIPHER const* cipher,
+                         ::EVP_MD const* oneway,
+                         elle::ConstWeakBuffer const& header,
+                         elle::ConstWeakBuffer const& chunk,
+                         uint64_t index,
+                         uint64_t size);
+        }
       }
     }
   }
@@ -0,0 +1,367 @@
+#pragma once
+
+#include <cstring>
+#include <initializer_list>
+#include <limits>
+#include <string>
+#include <tuple>
+#include <type_traits>
+
+#include <elle/Buffer.hh>
+#include <elle/das/model.hh>
+#include <elle/das/serializer.hh>
+#include <elle/err.hh>
+#include <elle/meta.hh>
+#include <elle/serialization/binary/number.hh>
+#include <elle/serialization/json/Error.hh>
+
+namespace elle
+{
+  namespace das
+  {
+    /// Binary serialization of fixed layout structs without a Serializer.
+    ///
+    /// Structs serialized with ELLE_DAS_SERIALIZE whose fields are all
+    /// integers, booleans, doubles or such structs have a bounded binary
+    /// representation, and their model is known at compile time. Their
+    /// encoding is thus generated field by field straight into a Buffer,
+    /// without virtual calls, std::functions or streams, in the exact format
+    /// elle::serialization::binary uses.
+    ///
+    /// \code{.cc}
+    ///
+    /// struct Point
+    /// {
+    ///   int32_t x;
+    ///   int32_t y;
+    ///   using Model = elle::das::Model<
+    ///     Point, decltype(elle::meta::list(symbols::x, symbols::y))>;
+    /// };
+    /// ELLE_DAS_SERIALIZE(Point);
+    ///
+    /// auto const buffer = elle::das::binary::serialize(Point{1, 2});
+    /// assert(buffer == elle::serialization::binary::serialize(Point{1, 2}));
+    /// assert(elle::das::binary::deserialize<Point>(buffer).y == 2);
+    ///
+    /// \endcode
+    namespace binary
+    {
+      using Byte = elle::Buffer::Byte;
+
+      /// How values of type T are laid out.
+      ///
+      /// Fixed layouts provide max_size, the bound of their encoding, and
+      /// static write and read functions.
+      template <typename T, typename = void>
+      struct Layout
+      {
+        static bool constexpr fixed = false;
+        static std::size_t constexpr max_size = 0;
+      };
+
+      namespace _details
+      {
+        template <typename T>
+        using is_integer = std::integral_constant<
+          bool,
+          std::is_same<T, int8_t>::value || std::is_same<T, uint8_t>::value ||
+          std::is_same<T, int16_t>::value || std::is_same<T, uint16_t>::value ||
+          std::is_same<T, int32_t>::value || std::is_same<T, uint32_t>::value ||
+          std::is_same<T, int64_t>::value || std::is_same<T, uint64_t>::value>;
+
+        /// The model of a type serialized by das::Serializer.
+        template <typename O, typename M>
+        M
+        serialized_model(das::Serializer<O, M> const*);
+
+        template <typename T>
+        using SerializedModel = decltype(
+          serialized_model(
+            std::declval<elle::serialization::Serialize<T> const*>()));
+
+        constexpr
+        bool
+        all(std::initializer_list<bool> values)
+        {
+          for (auto v: values)
+            if (!v)
+              return false;
+          return true;
+        }
+
+        constexpr
+        std::size_t
+        sum(std::initializer_list<std::size_t> values)
+        {
+          auto res = std::size_t(0);
+          for (auto v: values)
+            res += v;
+          return res;
+        }
+
+        template <typename Types>
+        struct Fields;
+
+        template <typename ... Types>
+        struct Fields<elle::meta::List<Types...>>
+        {
+          static bool constexpr fixed = all({true, Layout<Types>::fixed...});
+          static std::size_t constexpr max_size =
+            sum({0, Layout<Types>::max_size...});
+        };
+
+        /// The name of a field, built only when reporting an error.
+        inline
+        std::string
+        name(std::string (*name)())
+        {
+          return name ? name() : std::string();
+        }
+      }
+
+      /// Integers, encoded like Serializer::serialize_number.
+      template <typename T>
+      struct Layout<T, std::enable_if_t<_details::is_integer<T>::value>>
+      {
+        static bool constexpr fixed = true;
+        static std::size_t constexpr max_size =
+          serialization::binary::number_max_size;
+
+        static
+        Byte*
+        write(T v, Byte* output)
+        {
+          return serialization::binary::write_number(output, v);
+        }
+
+        static
+        T
+        read(Byte const*& input, Byte const* end,
+             std::string (*name)() = nullptr)
+        {
+          auto const v = serialization::binary::read_number(input, end);
+          if (std::is_same<T, uint64_t>::value)
+          {
+            if (v < 0)
+              elle::err<serialization::Error>(
+                "64-bits unsigned underflow on key \"%s\"",
+                _details::name(name));
+          }
+          else if (!std::is_same<T, int64_t>::value)
+          {
+            if (v > int64_t(std::numeric_limits<T>::max()))
+              throw serialization::json::Overflow(
+                _details::name(name), sizeof(T) * 8, true, v);
+            if (v < int64_t(std::numeric_limits<T>::min()))
+              throw serialization::json::Overflow(
+                _details::name(name), sizeof(T) * 8, false, v);
+          }
+          return v;
+        }
+      };
+
+      /// Booleans, encoded as 0 or 1.
+      template <>
+      struct Layout<bool>
+      {
+        static bool constexpr fixed = true;
+        static std::size_t constexpr max_size =
+          serialization::binary::number_max_size;
+
+        static
+        Byte*
+        write(bool v, Byte* output)
+        {
+          return serialization::binary::write_number(output, v ? 1 : 0);
+        }
+
+        static
+        bool
+        read(Byte const*& input, Byte const* end,
+             std::string (*name)() = nullptr)
+        {
+          auto const v = Layout<int32_t>::read(input, end, name);
+          if (v != 0 && v != 1)
+            throw serialization::json::Overflow(
+              _details::name(name), 1, true, v);
+          return v;
+        }
+      };
+
+      /// Doubles, as their memory representation.
+      template <>
+      struct Layout<double>
+      {
+        static bool constexpr fixed = true;
+        static std::size_t constexpr max_size = sizeof(double);
+
+        static
+        Byte*
+        write(double v, Byte* output)
+        {
+          std::memcpy(output, &v, sizeof(double));
+          return output + sizeof(double);
+        }
+
+        static
+        double
+        read(Byte const*& input, Byte const* end,
+             std::string (*name)() = nullptr)
+        {
+          if (end - input < signed(sizeof(double)))
+            elle::err<serialization::Error>(
+              "end of stream while reading \"%s\"", _details::name(name));
+          double res;
+          std::memcpy(&res, input, sizeof(double));
+          input += sizeof(double);
+          return res;
+        }
+      };
+
+      /// Structs serialized by das, as their fields in model order.
+      template <typename T>
+      struct Layout<T, std::enable_if_exists_t<_details::SerializedModel<T>>>
+      {
+        using Model = _details::SerializedModel<T>;
+        template <typename A>
+        using FieldType =
+          std::decay_t<typename Model::template FieldType<A>::type>;
+        using Fields = _details::Fields<
+          typename Model::Types::template map<std::decay>::type>;
+        static bool constexpr fixed = Fields::fixed;
+        static std::size_t constexpr max_size = Fields::max_size;
+
+        static
+        Byte*
+        write(T const& o, Byte* output)
+        {
+          Model::Fields::template map<Write>::value(o, output);
+          return output;
+        }
+
+        static
+        T
+        read(Byte const*& input, Byte const* end,
+             std::string (*)() = nullptr)
+        {
+          return _read(
+            input, end,
+            std::integral_constant<
+              bool,
+              Model::Types::template apply<std::is_constructible, T>::value>());
+        }
+
+      private:
+        template <typename A>
+        struct Write
+        {
+          using type = int;
+          static
+          int
+          value(T const& o, Byte*& output)
+          {
+            output = Layout<FieldType<A>>::write(
+              Model::template FieldType<A>::get(o), output);
+            return 0;
+          }
+        };
+
+        template <typename A>
+        struct Read
+        {
+          using type = FieldType<A>;
+          static
+          type
+          value(Byte const*& input, Byte const* end)
+          {
+            return Layout<type>::read(input, end, &A::name);
+          }
+        };
+
+        template <typename A>
+        struct Assign
+        {
+          using type = int;
+          static
+          int
+          value(Byte const*& input, Byte const* end, T& o)
+          {
+            Model::template FieldType<A>::get(o) = Read<A>::value(input, end);
+            return 0;
+          }
+        };
+
+        /// Construct from the fields, read in order.
+        static
+        T
+        _read(Byte const*& input, Byte const* end, std::true_type)
+        {
+          return std::forward_tuple(
+            [] (auto&& ... args) -> T
+            {
+              return T(std::move(args)...);
+            },
+            Model::Fields::template map<Read>::value(input, end));
+        }
+
+        /// Default construct and assign the fields.
+        static
+        T
+        _read(Byte const*& input, Byte const* end, std::false_type)
+        {
+          T res;
+          Model::Fields::template map<Assign>::value(input, end, res);
+          return res;
+        }
+      };
+
+      /// Append the binary serialization of a fixed layout struct.
+      ///
+      /// The output is what elle::serialization::binary::serialize writes.
+      template <typename T>
+      void
+      serialize(T const& o, elle::Buffer& output)
+      {
+        static_assert(Layout<T>::fixed,
+                      "type has no fixed binary layout");
+        auto const size = output.size();
+        output.size(size + 1 + Layout<T>::max_size);
+        auto const begin = output.mutable_contents() + size;
+        // Magic.
+        begin[0] = 0;
+        auto const end = Layout<T>::write(o, begin + 1);
+        output.size(end - output.mutable_contents());
+      }
+
+      /// The binary serialization of a fixed layout struct.
+      template <typename T>
+      elle::Buffer
+      serialize(T const& o)
+      {
+        elle::Buffer res;
+        serialize(o, res);
+        return res;
+      }
+
+      /// Deserialize a fixed layout struct.
+      ///
+      /// @throw serialization::Error if the input is truncated or a field
+      ///        overflows.
+      template <typename T>
+      T
+      deserialize(elle::ConstWeakBuffer input)
+      {
+        static_assert(Layout<T>::fixed,
+                      "type has no fixed binary layout");
+        auto p = input.contents();
+        auto const end = p + input.size();
+        if (p == end)
+          elle::err<serialization::Error>("unable to read magic");
+        if (*p != 0)
+          elle::err<serialization::Error>(
+            "wrong magic for binary serialization: 0x%2x", int(*p));
+        return Layout<T>::read(++p, end);
+      }
+    }
+  }
+}
@@ -0,0 +1,478 @@
+#include <elle/json/Document.hh>
+
+#include <algorithm>
+#include <cstring>
+#include <istream>
+#include <limits>
+
+#include <elle/Backtrace.hh>
+#include <elle/assert.hh>
+#include <elle/json/exceptions.hh>
+#include <elle/json/scan.hh>
+#include <elle/log.hh>
+#include <elle/printf.hh>
+#include <elle/unreachable.hh>
+
+ELLE_LOG_COMPONENT("elle.json.Document");
+
+namespace elle
+{
+  namespace json
+  {
+    namespace
+    {
+      uint64_t
+      word(Document::Type type, uint64_t payload = 0)
+      {
+        return uint64_t(type) << 60 | payload;
+      }
+
+      /// Hash bytes eight at a time.
+      std::size_t
+      hash_bytes(elle::ConstWeakBuffer bytes)
+      {
+        auto mix = [] (uint64_t h, uint64_t word)
+          {
+            h = (h ^ word) * 0xbf58476d1ce4e5b9ull;
+            return h ^ (h >> 31);
+          };
+        auto data = bytes.contents();
+        auto size = bytes.size();
+        auto res = uint64_t(size) * 0x9e3779b97f4a7c15ull;
+        for (; size >= 8; data += 8, size -= 8)
+        {
+          auto word = uint64_t(0);
+          std::memcpy(&word, data, 8);
+          res = mix(res, word);
+        }
+        if (size)
+        {
+          auto word = uint64_t(0);
+          std::memcpy(&word, data, size);
+          res = mix(res, word);
+        }
+        return res ^ (res >> 32);
+      }
+
+      /// The text of the next value of a stream, checking nothing already
+      /// buffered follows it.
+      std::string
+      read_value(std::istream& input)
+      {
+        auto res = std::string{};
+        detail::read(input, res);
+        detail::check_end(input);
+        return res;
+      }
+    }
+
+    /*--------.
+    | Builder |
+    `--------*/
+
+    /// Append values to a document, interning strings.
+    class Document::Builder
+    {
+    public:
+      Builder(Document& document)
+        : _document(document)
+        , _slots()
+        , _hashes()
+        , _pending()
+        , _scratch()
+      {
+        this->_document._string_offsets.push_back(0);
+      }
+
+      ~Builder()
+      {
+        auto& d = this->_document;
+        d._tape.shrink_to_fit();
+        d._children.shrink_to_fit();
+        d._strings.shrink_to_fit();
+        d._string_offsets.shrink_to_fit();
+      }
+
+      uint32_t
+      value(detail::Parser& parser, uint32_t offset)
+      {
+        auto& tape = this->_document._tape;
+        auto const res = this->_index();
+        switch (parser.at(offset))
+        {
+          case '{':
+          {
+            auto const base = this->_open();
+            if (!parser.close('}'))
+              do
+              {
+                auto const key = parser.take();
+                if (parser.at(key) != '"')
+                  parser.error(key, "expected a key");
+                auto const name = parser.string(key, this->_scratch);
+                parser.colon();
+                this->_pending.push_back(this->_intern(name));
+                this->_pending.push_back(this->value(parser, parser.take()));
+              }
+              while (parser.more('}'));
+            this->_close(res, Type::object, base);
+            break;
+          }
+          case '[':
+          {
+            auto const base = this->_open();
+            if (!parser.close(']'))
+              do
+                this->_pending.push_back(this->value(parser, parser.take()));
+              while (parser.more(']'));
+            this->_close(res, Type::array, base);
+            break;
+          }
+          case '"':
+          {
+            tape.push_back(word(
+              Type::string,
+              this->_intern(parser.string(offset, this->_scratch))));
+            break;
+          }
+          default:
+          {
+            auto const scalar = parser.scalar(offset);
+            switch (scalar.type)
+            {
+              case detail::Scalar::Type::null:
+                tape.push_back(word(Type::null));
+                break;
+              case detail::Scalar::Type::boolean:
+                tape.push_back(word(Type::boolean, scalar.boolean));
+                break;
+              case detail::Scalar::Type::integer:
+                this->_integer(scalar.integer);
+                break;
+              case detail::Scalar::Type::real:
+                this->_real(scalar.real);
+                break;
+            }
+          }
+        }
+        return res;
+      }
+
+      uint32_t
+      value(Json const& json)
+      {
+        auto& tape = this->_document._tape;
+        auto const res = this->_index();
+        auto const& type = json.type();
+        if (type == typeid(Object) || type == typeid(OrderedObject))
+        {
+          auto const base = this->_open();
+          auto member = [&] (std::pair<std::string const, Json> const& m)
+            {
+              this->_pending.push_back(this->_intern(m.first));
+              this->_pending.push_back(this->value(m.second));
+            };
+          if (type == typeid(Object))
+            for (auto const& m: boost::any_cast<Object const&>(json))
+              member(m);
+          else
+            for (auto const& m: boost::any_cast<OrderedObject const&>(json))
+              member(m);
+          this->_close(res, Type::object, base);
+        }
+        else if (type == typeid(Array))
+        {
+          auto const base = this->_open();
+          for (auto const& element: boost::any_cast<Array const&>(json))
+            this->_pending.push_back(this->value(element));
+          this->_close(res, Type::array, base);
+        }
+        else if (type == typeid(std::string))
+          tape.push_back(word(Type::string, this->_intern(
+            boost::any_cast<std::string const&>(json))));
+        else if (type == typeid(char const*))
+          tape.push_back(word(Type::string, this->_intern(
+            boost::any_cast<char const*>(json))));
+        else if (type == typeid(bool))
+          tape.push_back(word(Type::boolean, boost::any_cast<bool>(json)));
+        else if (type == typeid(NullType) || type == typeid(void))
+          tape.push_back(word(Type::null));
+        else if (type == typeid(float))
+          this->_real(boost::any_cast<float>(json));
+        else if (type == typeid(double))
+          this->_real(boost::any_cast<double>(json));
+        else if (!this->_integer<int16_t, int32_t, int64_t, long, long long,
+                                 uint16_t, uint32_t, uint64_t, unsigned long,
+                                 unsigned long long>(json))
+          ELLE_ABORT("unable to make JSON from type: %s",
+                     elle::demangle(type.name()));
+        return res;
+      }
+
+    private:
+      uint32_t
+      _index() const
+      {
+        auto const res = this->_document._tape.size();
+        if (res > std::numeric_limits<uint32_t>::max())
+          throw ParseError("JSON error: document too large");
+        return res;
+      }
+
+      /// Reserve a container and the position of its children.
+      std::size_t
+      _open()
+      {
+        this->_document._tape.push_back(0);
+        this->_document._tape.push_back(0);
+        return this->_pending.size();
+      }
+
+      /// Move the children of the container at index to the index.
+      void
+      _close(uint32_t index, Type type, std::size_t base)
+      {
+        auto& d = this->_document;
+        auto const size = this->_pending.size() - base;
+        d._tape[index] =
+          word(type, type == Type::object ? size / 2 : size);
+        d._tape[index + 1] = d._children.size();
+        d._children.insert(d._children.end(),
+                           this->_pending.begin() + base,
+                           this->_pending.end());
+        this->_pending.resize(base);
+      }
+
+      void
+      _integer(int64_t value)
+      {
+        this->_document._tape.push_back(word(Type::integer));
+        this->_document._tape.push_back(value);
+      }
+
+      template <typename T>
+      bool
+      _integer_as(Json const& json)
+      {
+        if (json.type() != typeid(T))
+          return false;
+        // Like json_spirit, unsigned values are stored as int64_t.
+        this->_integer(int64_t(boost::any_cast<T>(json)));
+        return true;
+      }
+
+      template <typename ... Types>
+      bool
+      _integer(Json const& json)
+      {
+        auto const matches = {this->_integer_as<Types>(json)...};
+        return std::find(matches.begin(), matches.end(), true) !=
+          matches.end();
+      }
+
+      void
+      _real(double value)
+      {
+        auto bits = uint64_t(0);
+        std::memcpy(&bits, &value, sizeof bits);
+        this->_document._tape.push_back(word(Type::real));
+        this->_document._tape.push_back(bits);
+      }
+
+      /// The identifier of a string, added to the pool if new.
+      uint32_t
+      _intern(elle::ConstWeakBuffer string)
+      {
+        auto& d = this->_document;
+        auto const hash = hash_bytes(string);
+        auto const count = this->_hashes.size();
+        if ((count + 1) * 2 > this->_slots.size())
+          this->_grow();
+        auto const mask = this->_slots.size() - 1;
+        for (auto i = hash & mask; ; i = (i + 1) & mask)
+        {
+          auto const slot = this->_slots[i];
+          if (!slot)
+          {
+            if (d._strings.size() + string.size() >
+                std::numeric_limits<uint32_t>::max())
+              throw ParseError("JSON error: document too large");
+            d._strings.append(
+              reinterpret_cast<char const*>(string.contents()), string.size());
+            d._string_offsets.push_back(d._strings.size());
+            this->_hashes.push_back(hash);
+            this->_slots[i] = count + 1;
+            return count;
+          }
+          auto const id = slot - 1;
+          auto const offset = d._string_offsets[id];
+          if (this->_hashes[id] == hash &&
+              d._string_offsets[id + 1] - offset == string.size() &&
+              !std::memcmp(d._strings.data() + offset,
+                           string.contents(), string.size()))
+            return id;
+        }
+      }
+
+      /// Double the interning table.
+      void
+      _grow()
+      {
+        auto const size = std::max<std::size_t>(1024, this->_slots.size() * 2);
+        this->_slots.assign(size, 0);
+        for (uint32_t id = 0; id < this->_hashes.size(); ++id)
+          for (auto i = this->_hashes[id] & (size - 1); ;
+               i = (i + 1) & (size - 1))
+            if (!this->_slots[i])
+            {
+              this->_slots[i] = id + 1;
+              break;
+            }
+      }
+
+      Document& _document;
+      /// Open addressing table of interned strings identifiers plus one,
+      /// zero for free slots.
+      std::vector<uint32_t> _slots;
+      /// The hash of each interned string.
+      std::vector<std::size_t> _hashes;
+      /// Children of the containers being built.
+      std::vector<uint32_t> _pending;
+      std::string _scratch;
+    };
+
+    /*-------------.
+    | Construction |
+    `-------------*/
+
+    Document::Document(char const* text, std::size_t size)
+      : _tape()
+      , _children()
+      , _strings()
+      , _string_offsets()
+    {
+      ELLE_TRACE_SCOPE("parse %s bytes", size);
+      auto parser = detail::Parser(text, size);
+      Builder(*this).value(parser, parser.take());
+      if (auto const rest = parser.rest())
+        parser.error(*rest, "garbage at end of JSON value");
+    }
+
+    Document::Document(std::string const& text)
+      : Document(text.data(), text.size())
+    {}
+
+    Document::Document(char const* text)
+      : Document(text, std::strlen(text))
+    {}
+
+    Document::Document(std::istream& input)
+      : Document(read_value(input))
+    {}
+
+    Document::Document(Json const& json)
+      : _tape()
+      , _children()
+      , _strings()
+      , _string_offsets()
+    {
+      Builder(*this).value(json);
+    }
+
+    /*--------.
+    | Content |
+    `--------*/
+
+    Document::Value
+    Document::root() const
+    {
+      return Value(*this, 0);
+    }
+
+    std::size_t
+    Document::memory() const
+    {
+      return sizeof(Document) +
+        this->_tape.capacity() * sizeof(uint64_t) +
+        this->_children.capacity() * sizeof(uint32_t) +
+        this->_strings.capacity() +
+        this->_string_offsets.capacity() * sizeof(uint32_t);
+    }
+
+    /*------.
+    | Value |
+    `------*/
+
+    boost::optional<Document::Value>
+    Document::Value::get(elle::ConstWeakBuffer key) const
+    {
+      auto const size = this->size();
+      for (std::size_t i = 0; i < size; ++i)
+      {
+        auto const k = this->key(i);
+        if (k.size() == key.size() &&
+            std::memcmp(k.contents(), key.contents(), key.size()) == 0)
+          return this->value(i);
+      }
+      return boost::none;
+    }
+    Json
+    Document::Value::json() const
+    {
+      switch (this->type())
+      {
+        case Type::null:
+          return NullType();
+        case Type::boolean:
+          return this->boolean();
+        case Type::integer:
+          return this->integer();
+        case Type::real:
+          return this->real();
+        case Type::string:
+          return this->string();
+        case Type::array:
+        {
+          auto res = Array{};
+          auto const size = this->size();
+          res.reserve(size);
+          for (std::size_t i = 0; i < size; ++i)
+            res.emplace_back((*this)[i].json());
+          return res;
+        }
+        case Type::object:
+        {
+          auto res = Object{};
+          auto const size = this->size();
+          for (std::size_t i = 0; i < size; ++i)
+            res.emplace(this->key(i).string(), this->value(i).json());
+          return res;
+        }
+      }
+      elle::unreachable();
+    }
+
+    std::ostream&
+    operator <<(std::ostream& output, Document::Type type)
+    {
+      switch (type)
+      {
+        case Document::Type::null:
+          return output << "null";
+        case Document::Type::boolean:
+          return output << "boolean";
+        case Document::Type::integer:
+          return output << "integer";
+        case Document::Type::real:
+          return output << "real";
+        case Document::Type::string:
+          return output << "string";
+        case Document::Type::array:
+          return output << "array";
+        case Document::Type::object:
+          return output << "object";
+      }
+      elle::unreachable();
+    }
+  }
+}
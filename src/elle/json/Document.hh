@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include <elle/Buffer.hh>
+#include <elle/attribute.hh>
+#include <elle/json/json.hh>
+
+namespace elle
+{
+  namespace json ELLE_API
+  {
+    /// An immutable JSON document.
+    ///
+    /// Values are stored depth first in a single tape of 64-bit words, the
+    /// elements of arrays and members of objects are indexed in a second
+    /// one, and strings, keys included, are stored once in a pool. Unlike
+    /// a Json tree, a Document makes a handful of allocations whatever its
+    /// size, and reading a value never involves an any_cast.
+    class Document
+    {
+    /*------.
+    | Types |
+    `------*/
+    public:
+      enum class Type
+      {
+        null,
+        boolean,
+        integer,
+        real,
+        string,
+        array,
+        object,
+      };
+
+      /// A value of a Document, valid as long as the document.
+      class Value
+      {
+      public:
+        Value(Document const& document, uint32_t index);
+        Type
+        type() const;
+        bool
+        boolean() const;
+        int64_t
+        integer() const;
+        double
+        real() const;
+        /// A copy of the string.
+        std::string
+        string() const;
+        /// The string, in the document.
+        elle::ConstWeakBuffer
+        bytes() const;
+        /// The number of elements of an array or members of an object.
+        std::size_t
+        size() const;
+        /// The element at index of an array.
+        Value
+        operator [](std::size_t index) const;
+        /// The key of the member at index of an object.
+        elle::ConstWeakBuffer
+        key(std::size_t index) const;
+        /// The value of the member at index of an object.
+        Value
+        value(std::size_t index) const;
+        /// The value of the first member named key of an object, if any.
+        boost::optional<Value>
+        get(elle::ConstWeakBuffer key) const;
+        /// The equivalent Json.
+        Json
+        json() const;
+      private:
+        /// The index of the elements or members, for containers.
+        uint32_t const*
+        _children() const;
+        /// The value word without its type.
+        uint64_t
+        _payload() const;
+        ELLE_ATTRIBUTE(Document const*, document);
+        ELLE_ATTRIBUTE(uint32_t, index);
+      };
+
+    /*-------------.
+    | Construction |
+    `-------------*/
+    public:
+      /// Parse a JSON text.
+      ///
+      /// @throw ParseError if the text is not a single JSON value.
+      Document(char const* text, std::size_t size);
+      /// Parse a JSON text.
+      ///
+      /// @throw ParseError if the text is not a single JSON value.
+      explicit
+      Document(std::string const& text);
+      /// Parse a null terminated JSON text.
+      explicit
+      Document(char const* text);
+      /// Parse the next value of a stream, leaving what follows unread.
+      ///
+      /// @throw ParseError if the value is invalid or followed by anything
+      ///        but whitespaces in what the stream already buffered.
+      explicit
+      Document(std::istream& input);
+      /// Convert a Json.
+      explicit
+      Document(Json const& json);
+      Document(Document&& document) = default;
+      Document&
+      operator =(Document&& document) = default;
+    private:
+      class Builder;
+
+    /*--------.
+    | Content |
+    `--------*/
+    public:
+      /// The top level value.
+      Value
+      root() const;
+      /// Bytes used by the document.
+      std::size_t
+      memory() const;
+    private:
+      /// Values, as a type tag in the high bits and a payload. Integers and
+      /// reals are followed by their value, containers by the position of
+      /// their children in the index.
+      ELLE_ATTRIBUTE(std::vector<uint64_t>, tape);
+      /// Tape indexes of array elements, key and tape index pairs of object
+      /// members.
+      ELLE_ATTRIBUTE(std::vector<uint32_t>, children);
+      /// Distinct strings, back to back.
+      ELLE_ATTRIBUTE(std::string, strings);
+      /// Where each string starts, and the end of the last one.
+      ELLE_ATTRIBUTE(std::vector<uint32_t>, string_offsets);
+    };
+
+    std::ostream&
+    operator <<(std::ostream& output, Document::Type type);
+  }
+}
+
+#include <elle/json/Document.hxx>
@@ -0,0 +1,124 @@
+#include <cstring>
+
+#include <elle/assert.hh>
+
+namespace elle
+{
+  namespace json
+  {
+    inline
+    Document::Value::Value(Document const& document, uint32_t index)
+      : _document(&document)
+      , _index(index)
+    {}
+
+    inline
+    Document::Type
+    Document::Value::type() const
+    {
+      return Type(this->_document->_tape[this->_index] >> 60);
+    }
+
+    inline
+    bool
+    Document::Value::boolean() const
+    {
+      ELLE_ASSERT_EQ(this->type(), Type::boolean);
+      return this->_payload();
+    }
+
+    inline
+    int64_t
+    Document::Value::integer() const
+    {
+      ELLE_ASSERT_EQ(this->type(), Type::integer);
+      return this->_document->_tape[this->_index + 1];
+    }
+
+    inline
+    double
+    Document::Value::real() const
+    {
+      ELLE_ASSERT_EQ(this->type(), Type::real);
+      auto res = 0.;
+      std::memcpy(&res, &this->_document->_tape[this->_index + 1], sizeof res);
+      return res;
+    }
+
+    inline
+    std::string
+    Document::Value::string() const
+    {
+      auto const bytes = this->bytes();
+      return std::string(reinterpret_cast<char const*>(bytes.contents()),
+                         bytes.size());
+    }
+
+    inline
+    elle::ConstWeakBuffer
+    Document::Value::bytes() const
+    {
+      ELLE_ASSERT_EQ(this->type(), Type::string);
+      auto const& d = *this->_document;
+      auto const id = this->_payload();
+      return elle::ConstWeakBuffer(
+        d._strings.data() + d._string_offsets[id],
+        d._string_offsets[id + 1] - d._string_offsets[id]);
+    }
+
+    inline
+    std::size_t
+    Document::Value::size() const
+    {
+      // Containers are the last types.
+      ELLE_ASSERT_GTE(this->type(), Type::array);
+      return this->_payload();
+    }
+
+    inline
+    Document::Value
+    Document::Value::operator [](std::size_t index) const
+    {
+      ELLE_ASSERT_EQ(this->type(), Type::array);
+      ELLE_ASSERT_LT(index, this->size());
+      return Value(*this->_document, this->_children()[index]);
+    }
+
+    inline
+    elle::ConstWeakBuffer
+    Document::Value::key(std::size_t index) const
+    {
+      ELLE_ASSERT_EQ(this->type(), Type::object);
+      ELLE_ASSERT_LT(index, this->size());
+      auto const& d = *this->_document;
+      auto const id = this->_children()[2 * index];
+      return elle::ConstWeakBuffer(
+        d._strings.data() + d._string_offsets[id],
+        d._string_offsets[id + 1] - d._string_offsets[id]);
+    }
+
+    inline
+    Document::Value
+    Document::Value::value(std::size_t index) const
+    {
+      ELLE_ASSERT_EQ(this->type(), Type::object);
+      ELLE_ASSERT_LT(index, this->size());
+      return Value(*this->_document, this->_children()[2 * index + 1]);
+    }
+
+    inline
+    uint32_t const*
+    Document::Value::_children() const
+    {
+      auto const& d = *this->_document;
+      return d._children.data() + d._tape[this->_index + 1];
+    }
+
+    inline
+    uint64_t
+    Document::Value::_payload() const
+    {
+      return this->_document->_tape[this->_index] & ((uint64_t(1) << 60) - 1);
+    }
+  }
+}
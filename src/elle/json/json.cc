@@ -1,12 +1,13 @@
-#include <json_spirit/reader.h>
 #include <json_spirit/value.h>
 #include <json_spirit/writer.h>
 
 #include <elle/Backtrace.hh>
 #include <elle/IOStream.hh>
 #include <elle/assert.hh>
+#include <elle/err.hh>
 #include <elle/json/exceptions.hh>
 #include <elle/json/json.hh>
+#include <elle/json/scan.hh>
 #include <elle/log.hh>
 #include <elle/printf.hh>
 
@@ -21,41 +22,59 @@ namespace elle
     namespace
     {
       Json
-      from_spirit(json_spirit::Value const& value)
+      from_text(detail::Parser& parser, uint32_t offset)
       {
-        switch (value.type())
+        switch (parser.at(offset))
         {
-          case json_spirit::Value::OBJECT_TYPE:
+          case '{':
           {
             auto res = Object{};
-            for (auto const& element: value.getObject())
-            {
-              // Enforce evulation order.
-              auto key = Config::get_name(element);
-              auto value = from_spirit(Config::get_value(element));
-              res.emplace(key, value);
-            }
+            if (!parser.close('}'))
+              do
+              {
+                auto const key = parser.take();
+                if (parser.at(key) != '"')
+                  parser.error(key, "expected a key");
+                auto scratch = std::string{};
+                auto name = parser.string(key, scratch).string();
+                parser.colon();
+                // Like json_spirit, the first of duplicate keys wins.
+                res.emplace(std::move(name),
+                            from_text(parser, parser.take()));
+              }
+              while (parser.more('}'));
             return res;
           }
-          case json_spirit::Value::ARRAY_TYPE:
+          case '[':
           {
             auto res = Array{};
-            for (auto const& element: value.getArray())
-              res.emplace_back(from_spirit(element));
+            if (!parser.close(']'))
+              do
+                res.emplace_back(from_text(parser, parser.take()));
+              while (parser.more(']'));
             return res;
           }
-          case json_spirit::Value::STRING_TYPE:
-            return value.getString();
-          case json_spirit::Value::BOOL_TYPE:
-            return value.getBool();
-          case json_spirit::Value::INT_TYPE:
-            return value.getInt64();
-          case json_spirit::Value::REAL_TYPE:
-            return value.getReal();
-          case json_spirit::Value::NULL_TYPE:
-            return NullType();
+          case '"':
+          {
+            auto scratch = std::string{};
+            return parser.string(offset, scratch).string();
+          }
           default:
-            ELLE_ABORT("unknown JSON value type");
+          {
+            auto const scalar = parser.scalar(offset);
+            switch (scalar.type)
+            {
+              case detail::Scalar::Type::null:
+                return NullType();
+              case detail::Scalar::Type::boolean:
+                return scalar.boolean;
+              case detail::Scalar::Type::integer:
+                return scalar.integer;
+              case detail::Scalar::Type::real:
+                return scalar.real;
+            }
+            ELLE_ABORT("unknown JSON scalar type");
+          }
         }
       }
 
@@ -136,21 +155,22 @@ namespace elle
     read(std::istream& stream)
     {
       ELLE_TRACE_SCOPE("read json from stream");
-      json_spirit::Value value;
-      if (!json_spirit::read(stream, value))
-        throw ParseError(elle::sprintf("JSON error"));
-      return from_spirit(value);
+      auto text = std::string{};
+      detail::read(stream, text);
+      auto parser = detail::Parser(text.data(), text.size());
+      return from_text(parser, parser.take());
     }
 
     Json
     read(std::string const& json)
     {
-      std::stringstream s(json);
-      auto res = read(s);
+      auto parser = detail::Parser(json.data(), json.size());
+      auto res = from_text(parser, parser.take());
+      if (auto const rest = parser.rest())
       {
-        std::string word;
-        if (s >> word)
-          elle::err("garbage at end of JSON value: %s", word);
+        auto const word = json.substr(
+          *rest, json.find_first_of(" \t\n\r", *rest) - *rest);
+        elle::err("garbage at end of JSON value: %s", word);
       }
       return res;
     }
@@ -0,0 +1,865 @@
+#include <elle/json/scan.hh>
+
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <istream>
+#include <limits>
+
+#include <elle/json/exceptions.hh>
+#include <elle/printf.hh>
+
+#if defined __x86_64__ && (defined __GNUC__ || defined __clang__)
+# define ELLE_JSON_SIMD
+# include <immintrin.h>
+#endif
+
+namespace elle
+{
+  namespace json
+  {
+    namespace detail
+    {
+      namespace
+      {
+        /// Characters of a 64-byte block, one bit per byte.
+        struct Masks
+        {
+          uint64_t quote;
+          uint64_t backslash;
+          /// Brackets, braces, colons and commas.
+          uint64_t op;
+          uint64_t whitespace;
+        };
+
+        Masks
+        classify_scalar(char const* block)
+        {
+          auto res = Masks{0, 0, 0, 0};
+          for (int i = 0; i < 64; ++i)
+          {
+            auto const bit = uint64_t(1) << i;
+            switch (block[i])
+            {
+              case '"':
+                res.quote |= bit;
+                break;
+              case '\\':
+                res.backslash |= bit;
+                break;
+              case '{': case '}': case '[': case ']': case ':': case ',':
+                res.op |= bit;
+                break;
+              case ' ': case '\t': case '\n': case '\r':
+                res.whitespace |= bit;
+                break;
+            }
+          }
+          return res;
+        }
+
+#ifdef ELLE_JSON_SIMD
+        // Brackets and braces only differ by 0x20: '[' | 0x20 is '{' and
+        // ']' | 0x20 is '}'.
+
+        inline
+        uint64_t
+        movemask(__m128i v, int i)
+        {
+          return uint64_t(uint32_t(_mm_movemask_epi8(v))) << (16 * i);
+        }
+
+        Masks
+        classify_sse2(char const* block)
+        {
+          auto res = Masks{0, 0, 0, 0};
+          for (int i = 0; i < 4; ++i)
+          {
+            auto const v = _mm_loadu_si128(
+              reinterpret_cast<__m128i const*>(block + 16 * i));
+            auto const folded = _mm_or_si128(v, _mm_set1_epi8(0x20));
+            res.quote |= movemask(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')), i);
+            res.backslash |=
+              movemask(_mm_cmpeq_epi8(v, _mm_set1_epi8('\\')), i);
+            res.op |= movemask(
+              _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(folded, _mm_set1_epi8('{')),
+                             _mm_cmpeq_epi8(folded, _mm_set1_epi8('}'))),
+                _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(':')),
+                             _mm_cmpeq_epi8(v, _mm_set1_epi8(',')))),
+              i);
+            res.whitespace |= movemask(
+              _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+                             _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))),
+                _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')),
+                             _mm_cmpeq_epi8(v, _mm_set1_epi8('\r')))),
+              i);
+          }
+          return res;
+        }
+
+        __attribute__((target("avx2")))
+        inline
+        uint64_t
+        movemask(__m256i v, int i)
+        {
+          return uint64_t(uint32_t(_mm256_movemask_epi8(v))) << (32 * i);
+        }
+
+        __attribute__((target("avx2")))
+        Masks
+        classify_avx2(char const* block)
+        {
+          auto res = Masks{0, 0, 0, 0};
+          for (int i = 0; i < 2; ++i)
+          {
+            auto const v = _mm256_loadu_si256(
+              reinterpret_cast<__m256i const*>(block + 32 * i));
+            auto const folded = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+            res.quote |=
+              movemask(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')), i);
+            res.backslash |=
+              movemask(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\')), i);
+            res.op |= movemask(
+              _mm256_or_si256(
+                _mm256_or_si256(
+                  _mm256_cmpeq_epi8(folded, _mm256_set1_epi8('{')),
+                  _mm256_cmpeq_epi8(folded, _mm256_set1_epi8('}'))),
+                _mm256_or_si256(
+                  _mm256_cmpeq_epi8(v, _mm256_set1_epi8(':')),
+                  _mm256_cmpeq_epi8(v, _mm256_set1_epi8(',')))),
+              i);
+            res.whitespace |= movemask(
+              _mm256_or_si256(
+                _mm256_or_si256(
+                  _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+                  _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'))),
+                _mm256_or_si256(
+                  _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')),
+                  _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r')))),
+              i);
+          }
+          return res;
+        }
+#endif
+
+        /// Bit i is the parity of bits 0 to i.
+        inline
+        uint64_t
+        prefix_xor(uint64_t bits)
+        {
+          bits ^= bits << 1;
+          bits ^= bits << 2;
+          bits ^= bits << 4;
+          bits ^= bits << 8;
+          bits ^= bits << 16;
+          bits ^= bits << 32;
+          return bits;
+        }
+
+        /// Turn block masks into structural offsets, carrying strings,
+        /// escapes and scalars across blocks.
+        class Scanner
+        {
+        public:
+          Scanner(Structure& structure)
+            : _structure(structure)
+            , _escaped(0)
+            , _in_string(0)
+            , _scalar(0)
+          {}
+
+          void
+          step(Masks const& masks, uint32_t offset)
+          {
+            // Backslashes are rare, find escaped characters one at a time.
+            auto escaped = this->_escaped;
+            auto backslash = masks.backslash & ~escaped;
+            this->_escaped = 0;
+            while (backslash)
+            {
+              auto const i = __builtin_ctzll(backslash);
+              if (i == 63)
+              {
+                this->_escaped = 1;
+                break;
+              }
+              escaped |= uint64_t(2) << i;
+              backslash &= ~(uint64_t(3) << i);
+            }
+            auto const quote = masks.quote & ~escaped;
+            // From opening quotes included to closing quotes excluded.
+            auto const in_string = prefix_xor(quote) ^ this->_in_string;
+            this->_in_string = uint64_t(int64_t(in_string) >> 63);
+            auto const scalar =
+              ~(masks.op | masks.whitespace | quote | in_string);
+            auto const scalar_starts =
+              scalar & ~((scalar << 1) | this->_scalar);
+            this->_scalar = scalar >> 63;
+            auto structurals =
+              (masks.op & ~in_string) | quote | scalar_starts;
+            while (structurals)
+            {
+              this->_structure.push_back(
+                offset + __builtin_ctzll(structurals));
+              structurals &= structurals - 1;
+            }
+          }
+
+          bool
+          in_string() const
+          {
+            return this->_in_string;
+          }
+
+        private:
+          Structure& _structure;
+          uint64_t _escaped;
+          uint64_t _in_string;
+          uint64_t _scalar;
+        };
+
+        template <typename Classify>
+        Structure
+        scan(char const* text, std::size_t size, Classify classify)
+        {
+          if (size > std::numeric_limits<uint32_t>::max())
+            throw ParseError("JSON error: text too large");
+          auto res = Structure{};
+          res.reserve(size / 8);
+          auto scanner = Scanner(res);
+          auto offset = std::size_t(0);
+          for (; offset + 64 <= size; offset += 64)
+            scanner.step(classify(text + offset), offset);
+          if (offset < size)
+          {
+            char block[64];
+            std::memset(block, ' ', sizeof block);
+            std::memcpy(block, text + offset, size - offset);
+            scanner.step(classify(block), offset);
+          }
+          if (scanner.in_string())
+            throw ParseError("JSON error: unterminated string");
+          return res;
+        }
+
+#ifdef ELLE_JSON_SIMD
+        Structure
+        structure_sse2(char const* text, std::size_t size)
+        {
+          return scan(text, size, &classify_sse2);
+        }
+
+        Structure
+        structure_avx2(char const* text, std::size_t size)
+        {
+          return scan(text, size, &classify_avx2);
+        }
+#endif
+
+        using Kernel = Structure (*)(char const*, std::size_t);
+
+        Kernel
+        select_kernel()
+        {
+#ifdef ELLE_JSON_SIMD
+          if (__builtin_cpu_supports("avx2"))
+            return &structure_avx2;
+          return &structure_sse2;
+#else
+          return &structure_scalar;
+#endif
+        }
+
+        unsigned long
+        hexadecimal(char const* digits, char const* end)
+        {
+          if (end - digits < 4)
+            throw ParseError("JSON error: truncated unicode escape");
+          auto res = 0ul;
+          for (int i = 0; i < 4; ++i)
+          {
+            auto const c = digits[i];
+            res <<= 4;
+            if (c >= '0' && c <= '9')
+              res |= c - '0';
+            else if (c >= 'a' && c <= 'f')
+              res |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F')
+              res |= c - 'A' + 10;
+            else
+              throw ParseError("JSON error: invalid unicode escape");
+          }
+          return res;
+        }
+
+        void
+        append_utf8(std::string& res, unsigned long code)
+        {
+          if (code < 0x80)
+            res.push_back(code);
+          else if (code < 0x800)
+          {
+            res.push_back(0xC0 | (code >> 6));
+            res.push_back(0x80 | (code & 0x3F));
+          }
+          else if (code < 0x10000)
+          {
+            res.push_back(0xE0 | (code >> 12));
+            res.push_back(0x80 | ((code >> 6) & 0x3F));
+            res.push_back(0x80 | (code & 0x3F));
+          }
+          else
+          {
+            res.push_back(0xF0 | (code >> 18));
+            res.push_back(0x80 | ((code >> 12) & 0x3F));
+            res.push_back(0x80 | ((code >> 6) & 0x3F));
+            res.push_back(0x80 | (code & 0x3F));
+          }
+        }
+      }
+
+        /// Read exactly one JSON value from a stream, validating it and
+        /// dropping insignificant whitespaces.
+        class Reader
+        {
+        public:
+          Reader(std::istream& input, std::string& text)
+            : _input(input)
+            , _buffer(*input.rdbuf())
+            , _text(text)
+            , _offset(0)
+          {}
+
+          void
+          read()
+          {
+            this->_value();
+          }
+
+        private:
+          using Traits = std::char_traits<char>;
+
+          int
+          _peek()
+          {
+            auto const c = this->_buffer.sgetc();
+            if (c == Traits::eof())
+              this->_input.setstate(std::ios::eofbit);
+            return c;
+          }
+
+          /// Consume and keep the next character.
+          int
+          _take()
+          {
+            auto const c = this->_buffer.sbumpc();
+            if (c == Traits::eof())
+              this->_error("unexpected end of input");
+            ++this->_offset;
+            this->_text.push_back(Traits::to_char_type(c));
+            return c;
+          }
+
+          void
+          _whitespaces()
+          {
+            while (true)
+              switch (this->_peek())
+              {
+                case ' ': case '\t': case '\n': case '\r':
+                  this->_buffer.sbumpc();
+                  ++this->_offset;
+                  break;
+                default:
+                  return;
+              }
+          }
+
+          void
+          _expect(char expected)
+          {
+            this->_whitespaces();
+            if (this->_peek() != expected)
+              this->_error(elle::sprintf("expected '%s'", expected));
+            this->_take();
+          }
+
+          void
+          _value()
+          {
+            this->_whitespaces();
+            switch (this->_peek())
+            {
+              case '{':
+                return this->_object();
+              case '[':
+                return this->_array();
+              case '"':
+                return this->_string();
+              case 't':
+                return this->_literal("true");
+              case 'f':
+                return this->_literal("false");
+              case 'n':
+                return this->_literal("null");
+              case '-': case '0': case '1': case '2': case '3': case '4':
+              case '5': case '6': case '7': case '8': case '9':
+                return this->_number();
+              case Traits::eof():
+                this->_error("unexpected end of input");
+              default:
+                this->_error("expected a value");
+            }
+          }
+
+          void
+          _object()
+          {
+            this->_take();
+            this->_whitespaces();
+            if (this->_peek() == '}')
+            {
+              this->_take();
+              return;
+            }
+            while (true)
+            {
+              this->_whitespaces();
+              if (this->_peek() != '"')
+                this->_error("expected a key");
+              this->_string();
+              this->_expect(':');
+              this->_value();
+              this->_whitespaces();
+              if (this->_take() == '}')
+                return;
+              if (this->_text.back() != ',')
+                this->_error("expected ',' or '}'");
+              if (this->_trailing_comma('}'))
+                return;
+            }
+          }
+
+          void
+          _array()
+          {
+            this->_take();
+            this->_whitespaces();
+            if (this->_peek() == ']')
+            {
+              this->_take();
+              return;
+            }
+            while (true)
+            {
+              this->_value();
+              this->_whitespaces();
+              if (this->_take() == ']')
+                return;
+              if (this->_text.back() != ',')
+                this->_error("expected ',' or ']'");
+              if (this->_trailing_comma(']'))
+                return;
+            }
+          }
+
+          /// Accept, and drop, a trailing comma like the former parser.
+          bool
+          _trailing_comma(char closer)
+          {
+            this->_whitespaces();
+            if (this->_peek() != closer)
+              return false;
+            this->_text.pop_back();
+            this->_take();
+            return true;
+          }
+
+          void
+          _string()
+          {
+            this->_take();
+            while (true)
+              switch (this->_take())
+              {
+                case '"':
+                  return;
+                case '\\':
+                  switch (this->_take())
+                  {
+                    case '"': case '\\': case '/': case 'b': case 'f':
+                    case 'n': case 'r': case 't':
+                      break;
+                    case 'u':
+                      for (int i = 0; i < 4; ++i)
+                        if (!std::isxdigit(this->_take()))
+                          this->_error("invalid unicode escape");
+                      break;
+                    default:
+                      this->_error("invalid escape");
+                  }
+              }
+          }
+
+          void
+          _literal(char const* literal)
+          {
+            for (auto c = literal; *c; ++c)
+              if (this->_take() != *c)
+                this->_error(elle::sprintf("expected %s", literal));
+          }
+
+          void
+          _number()
+          {
+            if (this->_peek() == '-')
+              this->_take();
+            if (this->_peek() == '0')
+              this->_take();
+            else
+              this->_digits();
+            if (this->_peek() == '.')
+            {
+              this->_take();
+              this->_digits();
+            }
+            if (this->_peek() == 'e' || this->_peek() == 'E')
+            {
+              this->_take();
+              if (this->_peek() == '+' || this->_peek() == '-')
+                this->_take();
+              this->_digits();
+            }
+          }
+
+          void
+          _digits()
+          {
+            if (!std::isdigit(this->_peek()))
+              this->_error("expected a digit");
+            while (std::isdigit(this->_peek()))
+              this->_take();
+          }
+
+          [[noreturn]]
+          void
+          _error(std::string const& message)
+          {
+            throw elle::json::ParseError(
+              elle::sprintf("%s at offset %s", message, this->_offset));
+          }
+
+          std::istream& _input;
+          std::streambuf& _buffer;
+          std::string& _text;
+          std::size_t _offset;
+        };
+
+      Structure
+      structure(char const* text, std::size_t size)
+      {
+        static auto const kernel = select_kernel();
+        return kernel(text, size);
+      }
+
+      Structure
+      structure_scalar(char const* text, std::size_t size)
+      {
+        return scan(text, size, &classify_scalar);
+      }
+
+      std::string
+      unescape(char const* begin, char const* end)
+      {
+        auto res = std::string{};
+        unescape(begin, end, res);
+        return res;
+      }
+
+      void
+      unescape(char const* begin, char const* end, std::string& res)
+      {
+        auto it = begin + 1;
+        auto escape = static_cast<char const*>(
+          std::memchr(it, '\\', end - it));
+        if (!escape)
+        {
+          res.append(it, end);
+          return;
+        }
+        res.append(it, escape);
+        for (it = escape; it != end; ++it)
+        {
+          if (*it != '\\')
+          {
+            res.push_back(*it);
+            continue;
+          }
+          switch (*++it)
+          {
+            case '"': case '\\': case '/':
+              res.push_back(*it);
+              break;
+            case 'b':
+              res.push_back('\b');
+              break;
+            case 'f':
+              res.push_back('\f');
+              break;
+            case 'n':
+              res.push_back('\n');
+              break;
+            case 'r':
+              res.push_back('\r');
+              break;
+            case 't':
+              res.push_back('\t');
+              break;
+            case 'u':
+            {
+              auto code = hexadecimal(it + 1, end);
+              it += 4;
+              // Combine surrogate pairs.
+              if (code >= 0xD800 && code < 0xDC00 &&
+                  end - it > 6 && it[1] == '\\' && it[2] == 'u')
+              {
+                auto const low = hexadecimal(it + 3, end);
+                if (low >= 0xDC00 && low < 0xE000)
+                {
+                  code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                  it += 6;
+                }
+              }
+              append_utf8(res, code);
+              break;
+            }
+            default:
+              throw ParseError(
+                elle::sprintf("JSON error: invalid escape: \\%s", *it));
+          }
+        }
+      }
+
+      /*-------.
+      | Parser |
+      `-------*/
+
+      Parser::Parser(char const* text, std::size_t size)
+        : _text(text)
+        , _size(size)
+        , _structure(structure(text, size))
+        , _next(0)
+      {}
+
+      char
+      Parser::at(uint32_t offset) const
+      {
+        return this->_text[offset];
+      }
+
+      uint32_t
+      Parser::take()
+      {
+        if (this->_next == this->_structure.size())
+          this->error(this->_size, "unexpected end of JSON");
+        return this->_structure[this->_next++];
+      }
+
+      boost::optional<uint32_t>
+      Parser::rest() const
+      {
+        if (this->_next < this->_structure.size())
+          return this->_structure[this->_next];
+        else
+          return boost::none;
+      }
+
+      bool
+      Parser::close(char closer)
+      {
+        if (this->_next < this->_structure.size() &&
+            this->_text[this->_structure[this->_next]] == closer)
+        {
+          ++this->_next;
+          return true;
+        }
+        else
+          return false;
+      }
+
+      bool
+      Parser::more(char closer)
+      {
+        auto const offset = this->take();
+        if (this->_text[offset] == closer)
+          return false;
+        if (this->_text[offset] != ',')
+          this->error(offset, elle::sprintf("expected ',' or '%s'", closer));
+        return !this->close(closer);
+      }
+
+      void
+      Parser::colon()
+      {
+        auto const offset = this->take();
+        if (this->_text[offset] != ':')
+          this->error(offset, "expected ':'");
+      }
+
+      elle::ConstWeakBuffer
+      Parser::string(uint32_t offset, std::string& scratch)
+      {
+        // Nothing inside a string is structural, the next one closes it.
+        auto const end = this->take();
+        auto const begin = this->_text + offset + 1;
+        if (!std::memchr(begin, '\\', end - offset - 1))
+          return elle::ConstWeakBuffer(begin, end - offset - 1);
+        scratch.clear();
+        try
+        {
+          unescape(this->_text + offset, this->_text + end, scratch);
+        }
+        catch (ParseError const& e)
+        {
+          this->error(offset, e.what());
+        }
+        return scratch;
+      }
+
+      Scalar
+      Parser::scalar(uint32_t offset) const
+      {
+        auto const begin = this->_text + offset;
+        auto const end = this->_text + this->_token_end(offset);
+        auto literal = [&] (char const* literal)
+          {
+            auto const size = std::strlen(literal);
+            if (std::size_t(end - begin) != size ||
+                std::memcmp(begin, literal, size))
+              this->error(offset, "invalid literal");
+          };
+        switch (*begin)
+        {
+          case 't':
+            literal("true");
+            return Scalar{Scalar::Type::boolean, true, 0, 0};
+          case 'f':
+            literal("false");
+            return Scalar{Scalar::Type::boolean, false, 0, 0};
+          case 'n':
+            literal("null");
+            return Scalar{Scalar::Type::null, false, 0, 0};
+        }
+        auto it = begin;
+        auto digits = [&]
+          {
+            auto const start = it;
+            while (it != end && *it >= '0' && *it <= '9')
+              ++it;
+            return it != start;
+          };
+        bool const negative = it != end && *it == '-';
+        if (negative)
+          ++it;
+        auto const integer = it;
+        if (!digits() || (*integer == '0' && it - integer > 1))
+          this->error(offset, "invalid number");
+        auto const integer_end = it;
+        bool real = false;
+        if (it != end && *it == '.')
+        {
+          ++it;
+          real = true;
+          if (!digits())
+            this->error(offset, "invalid number");
+        }
+        if (it != end && (*it == 'e' || *it == 'E'))
+        {
+          ++it;
+          real = true;
+          if (it != end && (*it == '+' || *it == '-'))
+            ++it;
+          if (!digits())
+            this->error(offset, "invalid number");
+        }
+        if (it != end)
+          this->error(offset, "invalid number");
+        if (!real)
+        {
+          auto value = uint64_t(0);
+          auto overflow = false;
+          for (auto c = integer; c != integer_end && !overflow; ++c)
+            overflow = __builtin_mul_overflow(value, 10, &value) ||
+              __builtin_add_overflow(value, uint64_t(*c - '0'), &value);
+          if (!overflow)
+          {
+            if (!negative)
+              // Like json_spirit, unsigned values are returned as int64_t.
+              return Scalar{Scalar::Type::integer, false, int64_t(value), 0};
+            else if (value <= uint64_t(1) << 63)
+              return Scalar{Scalar::Type::integer, false, int64_t(-value), 0};
+          }
+        }
+        // The number is followed by a delimiter strtod stops at, unless it
+        // ends the text.
+        auto const real_value = end == this->_text + this->_size ?
+          std::strtod(std::string(begin, end).c_str(), nullptr) :
+          std::strtod(begin, nullptr);
+        return Scalar{Scalar::Type::real, false, 0, real_value};
+      }
+
+      void
+      Parser::error(std::size_t offset, std::string const& message) const
+      {
+        throw ParseError(
+          elle::sprintf("JSON error: %s at offset %s", message, offset));
+      }
+
+      uint32_t
+      Parser::_token_end(uint32_t offset) const
+      {
+        auto end = offset;
+        while (end < this->_size)
+        {
+          switch (this->_text[end])
+          {
+            case ' ': case '\t': case '\n': case '\r': case '"':
+            case '{': case '}': case '[': case ']': case ':': case ',':
+              return end;
+          }
+          ++end;
+        }
+        return end;
+      }
+
+      void
+      read(std::istream& input, std::string& text)
+      {
+        Reader(input, text).read();
+      }
+
+      void
+      check_end(std::istream& input)
+      {
+        auto& buffer = *input.rdbuf();
+        while (buffer.in_avail() > 0)
+          switch (buffer.sgetc())
+          {
+            case ' ': case '\t': case '\n': case '\r':
+              buffer.sbumpc();
+              break;
+            default:
+            {
+              auto word = std::string{};
+              while (buffer.in_avail() > 0 && !std::isspace(buffer.sgetc()))
+                word.push_back(buffer.sbumpc());
+              throw ParseError(
+                elle::sprintf("garbage at end of JSON value: %s", word));
+            }
+          }
+      }
+    }
+  }
+}
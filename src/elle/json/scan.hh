@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include <elle/Buffer.hh>
+#include <elle/compiler.hh>
+
+namespace elle
+{
+  namespace json ELLE_API
+  {
+    namespace detail
+    {
+      /// Offsets of the structural characters of a JSON text, in order.
+      using Structure = std::vector<uint32_t>;
+
+      /// Find the structure of a JSON text.
+      ///
+      /// Structural characters are brackets, braces, colons and commas
+      /// outside strings, both quotes of every string and the first
+      /// character of every other scalar. Quotes, backslashes and
+      /// structural characters are classified 64 bytes at a time with AVX2
+      /// or SSE2 when available.
+      ///
+      /// @throw ParseError if a string is not terminated.
+      Structure
+      structure(char const* text, std::size_t size);
+
+      /// Same as structure, whatever the CPU.
+      Structure
+      structure_scalar(char const* text, std::size_t size);
+
+      /// The unescaped content of the string between two quotes.
+      std::string
+      unescape(char const* begin, char const* end);
+
+      /// Append the unescaped content of the string between two quotes.
+      void
+      unescape(char const* begin, char const* end, std::string& res);
+
+      /// A literal or a number.
+      struct Scalar
+      {
+        enum class Type
+        {
+          null,
+          boolean,
+          integer,
+          real,
+        };
+        Type type;
+        bool boolean;
+        int64_t integer;
+        double real;
+      };
+
+      /// Walk a JSON text along its structure, depth first.
+      ///
+      /// Take the offset of a structural character, and read the value
+      /// starting there according to the character.
+      class ELLE_API Parser
+      {
+      public:
+        /// @throw ParseError if a string is not terminated.
+        Parser(char const* text, std::size_t size);
+        /// The character at offset.
+        char
+        at(uint32_t offset) const;
+        /// Consume the next structural character.
+        ///
+        /// @throw ParseError at the end of the text.
+        uint32_t
+        take();
+        /// Offset of the first structural character left, if any.
+        boost::optional<uint32_t>
+        rest() const;
+        /// Consume the end of a container, if next.
+        bool
+        close(char closer);
+        /// Consume the separator after a container element, and whether
+        /// another element follows. Trailing commas are tolerated.
+        bool
+        more(char closer);
+        /// Consume the colon after a key.
+        void
+        colon();
+        /// The content of the string opening at offset, in the text or
+        /// unescaped in scratch.
+        elle::ConstWeakBuffer
+        string(uint32_t offset, std::string& scratch);
+        /// Read the literal or number starting at offset.
+        Scalar
+        scalar(uint32_t offset) const;
+        [[noreturn]]
+        void
+        error(std::size_t offset, std::string const& message) const;
+      private:
+        /// Offset of the end of the scalar starting at offset.
+        uint32_t
+        _token_end(uint32_t offset) const;
+        char const* _text;
+        std::size_t _size;
+        Structure _structure;
+        std::size_t _next;
+      };
+
+      /// Read exactly one JSON value from a stream, validating it, and
+      /// append its text without insignificant whitespaces.
+      ///
+      /// Nothing past the value is consumed, so a stream can hold several
+      /// values and reading never waits for its end.
+      ///
+      /// @throw ParseError if the value is invalid or the stream ends first.
+      void
+      read(std::istream& input, std::string& text);
+
+      /// Check nothing but whitespaces follows in what the stream already
+      /// buffered, without waiting for more.
+      ///
+      /// @throw ParseError if something else follows.
+      void
+      check_end(std::istream& input);
+    }
+  }
+}
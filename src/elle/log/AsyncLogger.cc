@@ -0,0 +1,251 @@
+#ifdef INFINIT_WINDOWS
+# include <io.h>
+#else
+# include <climits>
+# include <sys/uio.h>
+# include <unistd.h>
+#endif
+
+#include <fcntl.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include <elle/compiler.hh>
+#include <elle/err.hh>
+#include <elle/log/AsyncLogger.hh>
+#include <elle/printf.hh>
+
+namespace elle
+{
+  namespace log
+  {
+    namespace
+    {
+      int
+      _open(std::string const& path, bool append)
+      {
+        auto fd = ::open(path.c_str(),
+                         O_WRONLY | O_CREAT | (append ? O_APPEND : O_TRUNC),
+                         0644);
+        if (fd < 0)
+          elle::err("unable to open log file %s: %s",
+                    path, std::strerror(errno));
+        return fd;
+      }
+    }
+
+    /*-------------.
+    | Construction |
+    `-------------*/
+
+    AsyncLogger::AsyncLogger(int fd,
+                             std::string const& log_level,
+                             Overflow overflow,
+                             std::size_t capacity)
+      : Logger(log_level)
+      , _fd(fd)
+      , _owned(false)
+      , _overflow(overflow)
+      , _capacity(capacity)
+      , _queue_mutex()
+      , _pushed()
+      , _written()
+      , _queue()
+      , _batch()
+      , _pushed_count(0)
+      , _written_count(0)
+      , _unreported(0)
+      , _stop(false)
+      , _output()
+      , _formatter(std::make_unique<TextLogger>(this->_output))
+      , _thread()
+      , _dropped(0)
+    {
+      this->_queue.reserve(this->_capacity);
+      this->_batch.reserve(this->_capacity);
+      this->_thread = std::thread([this] { this->_run(); });
+    }
+
+    AsyncLogger::AsyncLogger(std::string const& path,
+                             bool append,
+                             std::string const& log_level,
+                             Overflow overflow,
+                             std::size_t capacity)
+      : AsyncLogger(_open(path, append), log_level, overflow, capacity)
+    {
+      this->_owned = true;
+    }
+
+    AsyncLogger::~AsyncLogger()
+    {
+      {
+        std::unique_lock<std::mutex> lock(this->_queue_mutex);
+        this->_stop = true;
+      }
+      this->_pushed.notify_one();
+      this->_thread.join();
+      if (this->_owned)
+        ::close(this->_fd);
+    }
+
+    void
+    AsyncLogger::flush()
+    {
+      std::unique_lock<std::mutex> lock(this->_queue_mutex);
+      auto const pushed = this->_pushed_count;
+      this->_written.wait(
+        lock, [&] { return this->_written_count >= pushed; });
+    }
+
+    /*----------.
+    | Messaging |
+    `----------*/
+
+    void
+    AsyncLogger::_message(
+      Level level,
+      elle::log::Logger::Type type,
+      std::string const& component,
+      boost::posix_time::ptime const& time,
+      std::string const& message,
+      std::vector<std::pair<std::string, std::string>> const& tags,
+      int indentation,
+      std::string const& file,
+      unsigned int line,
+      std::string const& function)
+    {
+      std::unique_lock<std::mutex> lock(this->_queue_mutex);
+      if (this->_queue.size() >= this->_capacity)
+      {
+        // Blocking the writer on itself, if formatting logs, would deadlock.
+        if (this->_overflow == Overflow::block &&
+            std::this_thread::get_id() != this->_thread.get_id())
+          this->_written.wait(
+            lock,
+            [this] { return this->_queue.size() < this->_capacity; });
+        else
+        {
+          ++this->_dropped;
+          if (this->_overflow == Overflow::count)
+            ++this->_unreported;
+          return;
+        }
+      }
+      this->_queue.emplace_back(
+        Record{level, type, component, time, indentation, message, tags,
+               file, line, function});
+      ++this->_pushed_count;
+      if (this->_queue.size() == 1)
+        this->_pushed.notify_one();
+    }
+
+    void
+    AsyncLogger::_run()
+    {
+      std::unique_lock<std::mutex> lock(this->_queue_mutex);
+      while (true)
+      {
+        this->_pushed.wait(
+          lock, [this] { return !this->_queue.empty() || this->_stop; });
+        if (this->_queue.empty() && !this->_unreported)
+          break;
+        std::swap(this->_queue, this->_batch);
+        auto const dropped = this->_unreported;
+        this->_unreported = 0;
+        // Make room for blocked producers right away.
+        this->_written.notify_all();
+        lock.unlock();
+        this->_write(this->_batch, dropped);
+        auto const written = this->_batch.size();
+        this->_batch.clear();
+        lock.lock();
+        this->_written_count += written;
+        this->_written.notify_all();
+      }
+    }
+
+    void
+    AsyncLogger::_write(Records const& records, std::size_t dropped)
+    {
+      auto texts = std::vector<std::string>{};
+      texts.reserve(records.size() + 1);
+      auto format = [&] (Level level,
+                         Type type,
+                         std::string const& component,
+                         boost::posix_time::ptime const& time,
+                         std::string const& message,
+                         std::vector<std::pair<std::string,
+                                               std::string>> const& tags,
+                         int indentation,
+                         std::string const& file,
+                         unsigned int line,
+                         std::string const& function)
+        {
+          // Level::none is always active, only update the component width.
+          this->_formatter->component_is_active(component, Level::none);
+          this->_output.str("");
+          static_cast<Logger&>(*this->_formatter)._message(
+            level, type, component, time, message, tags, indentation,
+            file, line, function);
+          texts.emplace_back(this->_output.str());
+        };
+      if (dropped)
+        format(Level::log, Type::warning, "elle.log.AsyncLogger",
+               boost::posix_time::microsec_clock::local_time(),
+               elle::sprintf("%s messages dropped", dropped), {}, 0,
+               __FILE__, __LINE__, ELLE_COMPILER_PRETTY_FUNCTION);
+      for (auto const& r: records)
+        format(r.level, r.type, r.component, r.time, r.message, r.tags,
+               r.indentation, r.file, r.line, r.function);
+#ifdef INFINIT_WINDOWS
+      for (auto const& text: texts)
+        ::_write(this->_fd, text.data(), text.size());
+#else
+      auto buffers = std::vector<::iovec>{};
+      buffers.reserve(texts.size());
+      for (auto& text: texts)
+        buffers.push_back(::iovec{&text[0], text.size()});
+      auto i = std::size_t(0);
+      while (i < buffers.size())
+      {
+        auto const count =
+          std::min(buffers.size() - i, std::size_t(IOV_MAX));
+        auto n = ::writev(this->_fd, buffers.data() + i, count);
+        if (n < 0)
+        {
+          if (errno == EINTR)
+            continue;
+          // Nowhere to report the error, give up on this batch.
+          return;
+        }
+        // Skip what was written, including a partial last buffer.
+        while (i < buffers.size() && std::size_t(n) >= buffers[i].iov_len)
+          n -= buffers[i++].iov_len;
+        if (n > 0)
+        {
+          buffers[i].iov_base = static_cast<char*>(buffers[i].iov_base) + n;
+          buffers[i].iov_len -= n;
+        }
+      }
+#endif
+    }
+
+    /*--------.
+    | Metrics |
+    `--------*/
+
+    std::size_t
+    AsyncLogger::queue_depth() const
+    {
+      std::unique_lock<std::mutex> lock(this->_queue_mutex);
+      return this->_queue.size();
+    }
+
+    std::size_t
+    AsyncLogger::dropped() const
+    {
+      return this->_dropped;
+    }
+  }
+}
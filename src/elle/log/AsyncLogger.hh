@@ -0,0 +1,141 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include <elle/log/Logger.hh>
+#include <elle/log/TextLogger.hh>
+
+namespace elle
+{
+  namespace log
+  {
+    /// Logger that formats and writes messages from a background thread.
+    ///
+    /// Log statements only copy their record in a bounded queue. A dedicated
+    /// system thread takes all pending records at once, formats them like a
+    /// TextLogger and writes the batch to a file descriptor with a single
+    /// writev, so a slow output never blocks the logging threads unless the
+    /// overflow policy says so.
+    class ELLE_API AsyncLogger
+      : public Logger
+    {
+    /*------.
+    | Types |
+    `------*/
+    public:
+      /// What to do with a message when the queue is full.
+      enum class Overflow
+      {
+        /// Wait for the writer to make room.
+        block,
+        /// Discard the message.
+        drop,
+        /// Discard the message and report how many were discarded once there
+        /// is room again.
+        count,
+      };
+
+    /*-------------.
+    | Construction |
+    `-------------*/
+    public:
+      /// Create a logger writing to fd, which it does not close.
+      AsyncLogger(int fd,
+                  std::string const& log_level = "",
+                  Overflow overflow = Overflow::block,
+                  std::size_t capacity = 4096);
+      /// Create a logger writing to the file at path, which it closes.
+      ///
+      /// @param append Whether to append to the file rather than truncate it.
+      AsyncLogger(std::string const& path,
+                  bool append,
+                  std::string const& log_level = "",
+                  Overflow overflow = Overflow::block,
+                  std::size_t capacity = 4096);
+      /// Write pending messages and stop the writer thread.
+      ~AsyncLogger();
+      /// Wait until every message logged so far is written.
+      void
+      flush();
+    private:
+      ELLE_ATTRIBUTE_R(int, fd);
+      /// Whether fd is closed with the logger.
+      ELLE_ATTRIBUTE_R(bool, owned);
+      ELLE_ATTRIBUTE_R(Overflow, overflow);
+      ELLE_ATTRIBUTE_R(std::size_t, capacity);
+
+    /*----------.
+    | Messaging |
+    `----------*/
+    protected:
+      void
+      _message(Level level,
+               elle::log::Logger::Type type,
+               std::string const& component,
+               boost::posix_time::ptime const& time,
+               std::string const& message,
+               std::vector<std::pair<std::string, std::string>> const& tags,
+               int indentation,
+               std::string const& file,
+               unsigned int line,
+               std::string const& function) override;
+    private:
+      struct Record
+      {
+        Level level;
+        Type type;
+        std::string component;
+        boost::posix_time::ptime time;
+        int indentation;
+        std::string message;
+        std::vector<std::pair<std::string, std::string>> tags;
+        std::string file;
+        unsigned int line;
+        std::string function;
+      };
+      using Records = std::vector<Record>;
+      /// Writer thread body.
+      void
+      _run();
+      /// Format and write a batch.
+      void
+      _write(Records const& records, std::size_t dropped);
+      mutable std::mutex _queue_mutex;
+      /// Signaled when records are pushed or the logger stops.
+      std::condition_variable _pushed;
+      /// Signaled when the writer takes or writes a batch.
+      std::condition_variable _written;
+      /// Pending records, swapped with the writer's batch so that neither
+      /// side reallocates in steady state.
+      Records _queue;
+      Records _batch;
+      /// Records pushed and written so far, for flush.
+      std::uint64_t _pushed_count;
+      std::uint64_t _written_count;
+      /// Dropped records not yet reported, with Overflow::count.
+      std::size_t _unreported;
+      bool _stop;
+      /// Formats records in the writer thread.
+      std::stringstream _output;
+      std::unique_ptr<TextLogger> _formatter;
+      std::thread _thread;
+
+    /*--------.
+    | Metrics |
+    `--------*/
+    public:
+      /// Number of records waiting to be written.
+      std::size_t
+      queue_depth() const;
+      /// Number of records discarded because the queue was full.
+      std::size_t
+      dropped() const;
+    private:
+      std::atomic<std::size_t> _dropped;
+    };
+  }
+}
@@ -291,17 +291,22 @@ namespace elle
       auto i = this->_component_levels.find(name);
       if (i == this->_component_levels.cend())
       {
+        auto contextual = false;
+        // Several filters might apply (e.g., $ELLE_LOG_LEVEL="LOG,DUMP"),
+        // keep the last one.
         for (auto const& filter: this->_component_patterns)
           if (filter.match(name))
           {
             if (filter.match(this->_component_stack))
               res = filter.level;
-            // If enabled unconditionally, cache it.
-            if (filter.context.empty())
-              // Several filters might apply (e.g.,
-              // $ELLE_LOG_LEVEL="LOG,DUMP"), keep the last one.
-              this->_component_levels[name] = res;
+            if (!filter.context.empty())
+              contextual = true;
           }
+        // If the level does not depend on the component stack, cache it,
+        // including for components no filter matches, so that they are not
+        // matched against every pattern again.
+        if (!contextual)
+          this->_component_levels[name] = res;
       }
       else
         res = i->second;
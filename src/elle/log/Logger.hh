@@ -142,6 +142,7 @@ namespace elle
                std::string const& file,
                unsigned int line,
                std::string const& function) = 0;
+      friend class AsyncLogger;
       friend class CompositeLogger;
 
     /*-----------.
@@ -212,8 +213,8 @@ namespace elle
       /// Translation of $ELLE_LOG_LEVEL into ordered filters.
       std::vector<Filter> _component_patterns;
       /// A cache of the decoding of $ELLE_LOG_LEVEL: component-name
-      /// => Level.  Filled only for unconditional levels (i.e., when
-      /// $ELLE_LOG_LEVEL uses no context specification).
+      /// => Level.  Filled only for unconditional levels (i.e., when no
+      /// filter matching the component has a context specification).
       std::unordered_map<std::string, Level> _component_levels;
       ELLE_ATTRIBUTE_R(unsigned int, component_max_size);
       /// Nested components.
@@ -1,7 +1,14 @@
+#ifdef INFINIT_WINDOWS
+# define STDERR_FILENO 2
+#else
+# include <unistd.h>
+#endif
+
 #include <fstream>
 #include <mutex>
 
 #include <elle/Exception.hh>
+#include <elle/log/AsyncLogger.hh>
 #include <elle/log/Send.hh>
 #include <elle/log/SysLogger.hh>
 #include <elle/log/TextLogger.hh>
@@ -47,7 +54,16 @@ namespace elle
         {
           auto path = elle::os::getenv("ELLE_LOG_FILE", "");
           bool append = !elle::os::getenv("ELLE_LOG_FILE_APPEND", "").empty();
-          if (!path.empty())
+          if (elle::os::inenv("ELLE_LOG_ASYNC"))
+          {
+            if (path.empty())
+              _logger() =
+                std::make_unique<elle::log::AsyncLogger>(STDERR_FILENO);
+            else
+              _logger() =
+                std::make_unique<elle::log::AsyncLogger>(path, append);
+          }
+          else if (!path.empty())
           {
             static std::ofstream out{
               path,
@@ -71,11 +87,14 @@ namespace elle
         logger->_indentation = _logger()->_indentation->clone();
       std::unique_ptr<Logger> prev = std::move(_logger());
       _logger() = std::move(logger);
+      // Levels may have changed, have disabled sites ask again.
+      ++detail::generation;
       return prev;
     }
 
     namespace detail
     {
+      std::atomic<unsigned int> generation{1};
 
       bool
       Send::active(elle::log::Logger::Level level,
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+
 #include <elle/compiler.hh>
 #include <elle/log/Logger.hh>
 #include <elle/memory.hh>
@@ -66,6 +68,33 @@ namespace elle
                    const std::string& msg);
         unsigned int* _indentation = nullptr;
       };
+
+      /// Bumped every time a Logger is installed, invalidating the
+      /// inactive Sites.  Starts at 1 so that a zero-initialized Site is
+      /// stale.
+      ELLE_API
+      extern std::atomic<unsigned int> generation;
+
+      /// Per log statement cache of Send::active.
+      ///
+      /// Constant-initialized, so that it is safe to use during static
+      /// initialization and costs no guard.  An inactive site only checks
+      /// its state against the global generation with relaxed loads, and
+      /// asks the Logger again once it changed.  An active site stays
+      /// active: it must keep pushing its component for context filters and
+      /// indentation, and Logger::message filters its output anyway.
+      struct ELLE_API Site
+      {
+      public:
+        bool
+        active(elle::log::Logger::Level level,
+               elle::log::Logger::Type type,
+               std::string const& component);
+      private:
+        /// Generation it was computed for, shifted left, with the activity
+        /// in the low bit.
+        std::atomic<unsigned int> _state{0};
+      };
     }
   }
 }
@@ -56,6 +56,25 @@ namespace elle
         }
       }
 
+      inline
+      bool
+      Site::active(elle::log::Logger::Level level,
+                   elle::log::Logger::Type type,
+                   std::string const& component)
+      {
+        auto state = this->_state.load(std::memory_order_relaxed);
+        if (state & 1)
+          return true;
+        auto current = generation.load(std::memory_order_relaxed) << 1;
+        if (state == current)
+          return false;
+        // Racing threads compute the same value, no need to synchronize.
+        auto res = Send::active(level, type, component);
+        this->_state.store(current | (res ? 1 : 0),
+                           std::memory_order_relaxed);
+        return res;
+      }
+
       inline
       Send::operator bool() const
       {
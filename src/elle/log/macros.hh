@@ -29,9 +29,8 @@
 
 # define ELLE_LOG_VALUE(Lvl, T, ...)                                    \
     [&] {                                                               \
-      static bool active =                                              \
-        elle::log::detail::Send::active(Lvl, T, _trace_component_);     \
-        return active;}()  ?                                            \
+      static ::elle::log::detail::Site site;                            \
+      return site.active(Lvl, T, _trace_component_);}()  ?              \
     ::elle::log::detail::Send(                                          \
       Lvl,                                                              \
       T, true, _trace_component_,                                       \
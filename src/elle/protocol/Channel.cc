@@ -15,8 +15,15 @@ namespace elle
 
     Channel::Channel(ChanneledStream& backend, int id)
       : Super(backend.scheduler())
+      , _priority(0)
       , _backend(backend)
       , _id(id)
+      , _credit(backend.peer_window())
+      , _credited()
+      , _window_remaining(backend.window())
+      , _consumed(0)
+      , _granting(0)
+      , _grant_queued(false)
     {
       ELLE_DEBUG_SCOPE("%s: open %s", this->_backend, *this);
       this->_backend._channels[this->_id] = this;
@@ -29,10 +36,17 @@ namespace elle
 
     Channel::Channel(Channel&& source)
       : Super(source.scheduler())
+      , _priority(source._priority)
       , _backend(source._backend)
       , _id(source._id)
       , _packets(std::move(source._packets))
       , _available(std::move(source._available))
+      , _credit(source._credit)
+      , _credited(std::move(source._credited))
+      , _window_remaining(source._window_remaining)
+      , _consumed(source._consumed)
+      , _granting(source._granting)
+      , _grant_queued(source._grant_queued)
     {
       source._id = 0;
       ELLE_ASSERT_NEQ(this->_backend._channels.find(this->_id),
@@ -84,7 +98,15 @@ namespace elle
     elle::Buffer
     Channel::_read()
     {
-      return this->_packets.get();
+      return this->_read_shared().copy();
+    }
+
+    elle::SharedBuffer
+    Channel::_read_shared()
+    {
+      auto res = this->_packets.get();
+      this->_backend._consumed(*this, res.size());
+      return res;
     }
 
     /*--------.
@@ -94,7 +116,7 @@ namespace elle
     void
     Channel::_write(elle::Buffer const& packet)
     {
-      this->_backend._write(packet, this->_id);
+      this->_backend._write(packet, *this);
     }
   }
 }
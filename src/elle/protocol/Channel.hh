@@ -87,13 +87,27 @@ namespace elle
       /// @see Stream::read.
       elle::Buffer
       _read() override;
+      /// Read data from the Channel, without copying it out of the packet
+      /// received by the ChanneledStream.
+      ///
+      /// @see Stream::read_shared.
+      elle::SharedBuffer
+      _read_shared() override;
 
     /*--------.
     | Sending |
     `--------*/
+    public:
+      /// Priority of packets written to the Channel.
+      ///
+      /// Packets of higher priority are written to the backend first.
+      ELLE_ATTRIBUTE_RW(int, priority);
     protected:
       /// Write data to the Channel.
       ///
+      /// From version 0.7.0, wait until the peer read enough of the previous
+      /// packets.
+      ///
       /// @see Stream::_write.
       void
       _write(elle::Buffer const& packet) override;
@@ -105,8 +119,20 @@ namespace elle
       friend class ChanneledStream;
       ELLE_ATTRIBUTE(ChanneledStream&, backend);
       ELLE_ATTRIBUTE_R(Id, id);
-      ELLE_ATTRIBUTE(reactor::Channel<elle::Buffer>, packets);
+      ELLE_ATTRIBUTE(reactor::Channel<elle::SharedBuffer>, packets);
       ELLE_ATTRIBUTE(elle::reactor::Signal, available);
+      /// Bytes we may send before the peer grants more.
+      ELLE_ATTRIBUTE(int64_t, credit);
+      /// Signaled when the peer grants credit.
+      ELLE_ATTRIBUTE(elle::reactor::Signal, credited);
+      /// Bytes the peer may send before we grant more.
+      ELLE_ATTRIBUTE(int64_t, window_remaining);
+      /// Bytes read since we last granted credit.
+      ELLE_ATTRIBUTE(int64_t, consumed);
+      /// Credit being sent to the peer.
+      ELLE_ATTRIBUTE(int64_t, granting);
+      /// Whether the Channel awaits its turn to grant credit.
+      ELLE_ATTRIBUTE(bool, grant_queued);
     };
   }
 }
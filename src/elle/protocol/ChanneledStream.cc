@@ -1,8 +1,15 @@
+#include <algorithm>
+#include <deque>
 #include <iostream>
+#include <limits>
 
 #include <elle/find.hh>
+#include <elle/finally.hh>
 #include <elle/log.hh>
 
+#include <elle/With.hh>
+
+#include <elle/reactor/Barrier.hh>
 #include <elle/reactor/scheduler.hh>
 #include <elle/reactor/Thread.hh>
 
@@ -17,18 +24,148 @@ namespace elle
 {
   namespace protocol
   {
+    /// Channel id of the credit granted by the peer, from version 0.7.0.
+    ///
+    /// Each credit packet holds a channel id and a number of bytes.
+    static int const control_channel = std::numeric_limits<int32_t>::min();
+
+    /// Packets sent together, from version 0.6.0.
+    ///
+    /// Each packet is written as its channel id, its size and its content.
+    class ChanneledStream::Batch
+    {
+    public:
+      Batch()
+        : data()
+        , packets(0)
+        , id(0)
+        , priority(std::numeric_limits<int>::min())
+        , full()
+        , sent()
+        , error()
+      {}
+
+      elle::Buffer data;
+      int packets;
+      /// Channel of the first packet, which the batch is scheduled as.
+      int id;
+      /// Highest priority of the packets.
+      int priority;
+      /// Opened when batch_size is reached.
+      elle::reactor::Barrier full;
+      /// Opened once written to the backend, successfully or not.
+      elle::reactor::Barrier sent;
+      std::exception_ptr error;
+    };
+
+    /// Frames of a given priority waiting for the backend.
+    ///
+    /// Channels are served in deficit round robin: each time a channel is
+    /// passed over, it is allowed `quantum` more bytes, so channels share the
+    /// backend by bytes and not by frames.
+    class ChanneledStream::Lane
+    {
+    public:
+      class Sender
+      {
+      public:
+        Sender(elle::Buffer::Size size)
+          : size(size)
+          , turn()
+        {}
+
+        elle::Buffer::Size size;
+        /// Opened when the frame may be written.
+        elle::reactor::Barrier turn;
+      };
+
+      bool
+      empty() const
+      {
+        return this->_active.empty();
+      }
+
+      void
+      push(int id, Sender& sender)
+      {
+        auto& queue = this->_queues[id];
+        if (queue.empty())
+          this->_active.push_back(id);
+        queue.push_back(&sender);
+      }
+
+      void
+      remove(int id, Sender& sender)
+      {
+        auto& queue = this->_queues.at(id);
+        queue.erase(std::find(queue.begin(), queue.end(), &sender));
+        if (queue.empty())
+          this->_drop(id);
+      }
+
+      Sender&
+      pop(elle::Buffer::Size quantum)
+      {
+        while (true)
+        {
+          auto const id = this->_active.front();
+          auto& queue = this->_queues.at(id);
+          auto& deficit = this->_deficits[id];
+          auto& sender = *queue.front();
+          if (sender.size <= deficit)
+          {
+            deficit -= sender.size;
+            queue.pop_front();
+            if (queue.empty())
+              this->_drop(id);
+            return sender;
+          }
+          deficit += quantum;
+          this->_active.pop_front();
+          this->_active.push_back(id);
+        }
+      }
+
+    private:
+      void
+      _drop(int id)
+      {
+        this->_active.erase(
+          std::find(this->_active.begin(), this->_active.end(), id));
+        this->_queues.erase(id);
+        this->_deficits.erase(id);
+      }
+
+      /// Channels with waiting frames, in serving order.
+      std::deque<int> _active;
+      std::unordered_map<int, std::deque<Sender*>> _queues;
+      std::unordered_map<int, elle::Buffer::Size> _deficits;
+    };
+
     /*-------------.
     | Construction |
     `-------------*/
 
     ChanneledStream::ChanneledStream(elle::reactor::Scheduler& scheduler,
-                                     Stream& backend)
+                                     Stream& backend,
+                                     uint32_t window)
       : Super(scheduler)
       , _backend(backend)
       , _thread()
       , _exception()
+      , _window(window)
+      , _peer_window(0)
+      , _grants()
+      , _granter()
       , _master(this->_handshake(backend))
       , _id_current(0)
+      , _batch()
+      , _batch_size(1 << 16)
+      , _batch_delay()
+      , _packets_sent(0)
+      , _frames_sent(0)
+      , _sending(false)
+      , _lanes()
       , _channels()
       , _channels_new()
       , _channel_available()
@@ -37,16 +174,23 @@ namespace elle
       this->_thread.reset(
         new reactor::Thread(
           elle::sprintf("%s", this), [this] { this->_read_thread(); }));
+      if (this->_flow_control() && this->_window)
+        this->_granter.reset(
+          new reactor::Thread(
+            elle::sprintf("%s grants", this),
+            [this] { this->_grant_thread(); }));
     }
 
-    ChanneledStream::ChanneledStream(Stream& backend)
-      : ChanneledStream(*elle::reactor::Scheduler::scheduler(), backend)
+    ChanneledStream::ChanneledStream(Stream& backend, uint32_t window)
+      : ChanneledStream(*elle::reactor::Scheduler::scheduler(), backend, window)
     {}
 
     ChanneledStream::~ChanneledStream()
     {
       try
       {
+        if (this->_granter)
+          this->_granter->terminate_now();
         this->_thread->terminate_now();
       }
       catch (...)
@@ -64,27 +208,23 @@ namespace elle
       {
         while (true)
         {
-          auto p = this->_backend.read();
-          int channel_id = this->uint32_get(p, this->version());
-          // FIXME: The size of the packet isn't adjusted. This is cosmetic
-          // though.
-          if (auto it = elle::find(this->_channels, channel_id))
-          {
-            ELLE_DEBUG("received %f on channel %s", p, *it->second);
-            it->second->_packets.put(std::move(p));
-          }
-          else
-          {
-            if (this->_master && channel_id > 0 ||
-                !this->_master && channel_id < 0)
+          // Channels get a slice of the packet past the channel id.
+          auto p = this->_backend.read_shared();
+          if (this->version() >= elle::Version(0, 6, 0))
+            while (p.size() > 0)
             {
-              ELLE_TRACE("discard orphaned packet on channel %s", channel_id);
-              continue;
+              int channel_id = this->uint32_get(p, this->version());
+              auto const size = this->uint32_get(p, this->version());
+              if (size > p.size())
+                elle::err("%s: truncated batch: %s bytes announced, %s left",
+                          this, size, p.size());
+              this->_receive(channel_id, p.range(0, size));
+              p = p.range(size);
             }
-            Channel res(*this, channel_id);
-            ELLE_DEBUG("received %f on new channel %s", p, channel_id);
-            res._packets.put(std::move(p));
-            this->_channels_new.put(std::move(res));
+          else
+          {
+            int channel_id = this->uint32_get(p, this->version());
+            this->_receive(channel_id, std::move(p));
           }
         }
       }
@@ -96,6 +236,36 @@ namespace elle
         for (auto& c: this->_channels)
           c.second->_packets.raise(std::current_exception());
         this->_exception = std::current_exception();
+        // Do not leave writers waiting for credit that will never come.
+        for (auto& c: this->_channels)
+          c.second->_credited.signal();
+      }
+    }
+
+    void
+    ChanneledStream::_receive(int channel_id, elle::SharedBuffer p)
+    {
+      if (channel_id == control_channel && this->_flow_control())
+        return this->_credit(std::move(p));
+      if (auto it = elle::find(this->_channels, channel_id))
+      {
+        ELLE_DEBUG("received %f on channel %s", p, *it->second);
+        this->_received(*it->second, p.size());
+        it->second->_packets.put(std::move(p));
+      }
+      else
+      {
+        if (this->_master && channel_id > 0 ||
+            !this->_master && channel_id < 0)
+        {
+          ELLE_TRACE("discard orphaned packet on channel %s", channel_id);
+          return;
+        }
+        Channel res(*this, channel_id);
+        ELLE_DEBUG("received %f on new channel %s", p, channel_id);
+        this->_received(res, p.size());
+        res._packets.put(std::move(p));
+        this->_channels_new.put(std::move(res));
       }
     }
 
@@ -107,17 +277,30 @@ namespace elle
         ELLE_TRACE_SCOPE("%s: handshake to determine master", *this);
         char mine = elle::cryptography::random::generate<char>();
         char his;
+        // From version 0.7.0, peers also announce their window.
+        auto const windows = backend.version() >= elle::Version(0, 7, 0);
         {
           elle::Buffer p;
           p.append(&mine, 1);
+          if (windows)
+            this->uint32_put(p, this->_window, backend.version());
           backend.write(p);
           ELLE_DEBUG("%s: my roll: %d", *this, (int)mine);
         }
         {
           elle::Buffer p(backend.read());
-          ELLE_ASSERT_EQ(1, (signed)p.size());
+          if (!windows)
+            ELLE_ASSERT_EQ(1, (signed)p.size());
+          else if (p.size() < 2)
+            elle::err("%s: truncated handshake", *this);
           his = p.contents()[0];
           ELLE_DEBUG("%s: his roll: %d", *this, (int)his);
+          if (windows)
+          {
+            p.pop_front(1);
+            this->_peer_window = this->uint32_get(p, backend.version());
+            ELLE_DEBUG("%s: his window: %s", *this, this->_peer_window);
+          }
         }
         if (mine != his)
         {
@@ -147,12 +330,110 @@ namespace elle
       else
       {
         --this->_id_current;
-        if (this->_id_current > 0)
+        if (this->_id_current > 0 || this->_id_current == control_channel)
           this->_id_current = -1;
       }
       return res;
     }
 
+    /*-------------.
+    | Flow control |
+    `-------------*/
+
+    bool
+    ChanneledStream::_flow_control() const
+    {
+      return this->version() >= elle::Version(0, 7, 0);
+    }
+
+    void
+    ChanneledStream::_received(Channel& channel, elle::Buffer::Size size)
+    {
+      if (!this->_flow_control() || !this->_window)
+        return;
+      // The last packet may overrun the window, as the peer only waits once
+      // its credit is exhausted. Credit being sent may already have reached
+      // the peer.
+      if (channel._window_remaining + channel._granting <= 0)
+        elle::err("%s: peer overran the window of %s", *this, channel);
+      channel._window_remaining -= size;
+    }
+
+    void
+    ChanneledStream::_consumed(Channel& channel, elle::Buffer::Size size)
+    {
+      if (!this->_flow_control() || !this->_window)
+        return;
+      channel._consumed += size;
+      if (channel._consumed >= this->_window / 2 && !channel._grant_queued)
+      {
+        channel._grant_queued = true;
+        this->_grants.put(channel.id());
+      }
+    }
+
+    void
+    ChanneledStream::_grant_thread()
+    {
+      ELLE_TRACE_SCOPE("%s: send grants", this);
+      while (true)
+      {
+        auto const id = this->_grants.get();
+        auto it = elle::find(this->_channels, id);
+        if (!it)
+          continue;
+        auto& channel = *it->second;
+        channel._grant_queued = false;
+        auto const credit = channel._consumed;
+        ELLE_DEBUG("%s: grant %s bytes on %s", *this, credit, channel);
+        channel._granting += credit;
+        auto packet = elle::Buffer{};
+        this->uint32_put(packet, id, this->version());
+        this->uint32_put(packet, credit, this->version());
+        try
+        {
+          // Credit is never held back behind data.
+          this->_write(
+            packet, control_channel, std::numeric_limits<int>::max());
+        }
+        catch (elle::Error const&)
+        {
+          ELLE_TRACE("%s: granting failed: %s", this, elle::exception_string());
+          if (auto it = elle::find(this->_channels, id))
+            it->second->_granting -= credit;
+          return;
+        }
+        // The channel may have been moved or closed meanwhile.
+        if (auto it = elle::find(this->_channels, id))
+        {
+          auto& channel = *it->second;
+          channel._granting -= credit;
+          channel._consumed -= credit;
+          channel._window_remaining += credit;
+          if (channel._consumed >= this->_window / 2 && !channel._grant_queued)
+          {
+            channel._grant_queued = true;
+            this->_grants.put(id);
+          }
+        }
+      }
+    }
+
+    void
+    ChanneledStream::_credit(elle::SharedBuffer packet)
+    {
+      int const id = this->uint32_get(packet, this->version());
+      auto const credit = this->uint32_get(packet, this->version());
+      if (auto it = elle::find(this->_channels, id))
+      {
+        ELLE_DEBUG("%s: granted %s bytes on %s", *this, credit, *it->second);
+        it->second->_credit += credit;
+        it->second->_credited.signal();
+      }
+      else
+        ELLE_DEBUG("%s: discard credit on closed channel %s", *this, id);
+    }
+
     /*----------.
     | Receiving |
     `----------*/
@@ -163,6 +444,12 @@ namespace elle
       return this->_default.read();
     }
 
+    elle::SharedBuffer
+    ChanneledStream::_read_shared()
+    {
+      return this->_default.read_shared();
+    }
+
     Channel
     ChanneledStream::accept()
     {
@@ -181,14 +468,146 @@ namespace elle
     }
 
     void
-    ChanneledStream::_write(elle::Buffer const& packet, int id)
+    ChanneledStream::_write(elle::Buffer const& packet, Channel& channel)
+    {
+      if (this->_flow_control() && this->_peer_window)
+      {
+        while (channel._credit <= 0)
+        {
+          if (this->_exception)
+            std::rethrow_exception(this->_exception);
+          ELLE_DEBUG("%s: wait for credit on %s", *this, channel)
+            elle::reactor::wait(channel._credited);
+        }
+        channel._credit -= packet.size();
+      }
+      this->_write(packet, channel.id(), channel.priority());
+    }
+
+    void
+    ChanneledStream::_write(elle::Buffer const& packet, int id, int priority)
     {
       ELLE_TRACE_SCOPE("%s: send %f on channel %s", *this, packet, id);
 
-      auto backend_packet = elle::Buffer{};
-      this->uint32_put(backend_packet, id, this->version());
-      backend_packet.append(packet.contents(), packet.size());
-      this->_backend.write(backend_packet);
+      if (this->version() < elle::Version(0, 6, 0))
+      {
+        auto backend_packet = elle::Buffer{};
+        this->uint32_put(backend_packet, id, this->version());
+        backend_packet.append(packet.contents(), packet.size());
+        this->_send(backend_packet, id, priority);
+        ++this->_packets_sent;
+        ++this->_frames_sent;
+        return;
+      }
+      // The first packet of a batch sends it, others wait for it.
+      auto batch = this->_batch;
+      bool const first = !batch;
+      if (first)
+      {
+        batch = this->_batch = std::make_shared<Batch>();
+        batch->id = id;
+      }
+      batch->priority = std::max(batch->priority, priority);
+      this->uint32_put(batch->data, id, this->version());
+      this->uint32_put(batch->data, packet.size(), this->version());
+      batch->data.append(packet.contents(), packet.size());
+      ++batch->packets;
+      if (batch->data.size() >= this->_batch_size)
+      {
+        if (this->_batch == batch)
+          this->_batch.reset();
+        batch->full.open();
+      }
+      if (!first)
+      {
+        elle::reactor::wait(batch->sent);
+        if (batch->error)
+          try
+          {
+            std::rethrow_exception(batch->error);
+          }
+          catch (elle::Error const&)
+          {
+            throw;
+          }
+          catch (...)
+          {
+            // Do not propagate the termination of the sending thread.
+            elle::err("%s: batch sending was interrupted", *this);
+          }
+        return;
+      }
+      // Let other threads add their packets, without leaving them behind if
+      // we are interrupted meanwhile.
+      elle::With<elle::reactor::Thread::NonInterruptible>() << [&]
+      {
+        if (!batch->full.opened())
+        {
+          if (this->_batch_delay)
+            elle::reactor::wait(batch->full, this->_batch_delay);
+          else
+            elle::reactor::yield();
+        }
+      };
+      if (this->_batch == batch)
+        this->_batch.reset();
+      ELLE_DEBUG("%s: send batch of %s packets", *this, batch->packets);
+      try
+      {
+        this->_send(batch->data, batch->id, batch->priority);
+      }
+      catch (...)
+      {
+        batch->error = std::current_exception();
+        batch->sent.open();
+        throw;
+      }
+      this->_packets_sent += batch->packets;
+      ++this->_frames_sent;
+      batch->sent.open();
+    }
+
+    void
+    ChanneledStream::_send(elle::Buffer const& frame, int id, int priority)
+    {
+      if (this->_sending)
+      {
+        auto& lane = this->_lanes[priority];
+        if (!lane)
+          lane.reset(new Lane);
+        Lane::Sender sender(frame.size());
+        lane->push(id, sender);
+        try
+        {
+          elle::reactor::wait(sender.turn);
+        }
+        catch (...)
+        {
+          // Pass our turn on, or leave the line.
+          if (sender.turn.opened())
+            this->_send_next();
+          else
+            lane->remove(id, sender);
+          throw;
+        }
+      }
+      else
+        this->_sending = true;
+      elle::SafeFinally next([this] { this->_send_next(); });
+      this->_backend.write(frame);
+    }
+
+    void
+    ChanneledStream::_send_next()
+    {
+      for (auto& lane: this->_lanes)
+        if (!lane.second->empty())
+        {
+          // Let channels send a batch worth of bytes per round.
+          lane.second->pop(this->_batch_size).turn.open();
+          return;
+        }
+      this->_sending = false;
     }
 
     /*--------.
@@ -1,7 +1,12 @@
 #pragma once
 
+#include <functional>
+#include <map>
+#include <memory>
 #include <unordered_map>
 
+#include <elle/Duration.hh>
+
 #include <elle/protocol/Channel.hh>
 #include <elle/protocol/Stream.hh>
 #include <elle/protocol/fwd.hh>
@@ -20,6 +25,18 @@ namespace elle
     /// the socket to communicate through the same socket. Multiplexing and
     /// demultiplexing will be transparent for the user.
     ///
+    /// From version 0.6.0, packets written during the same scheduler round
+    /// are coalesced in a single packet of the backend, up to batch_size
+    /// bytes, and split again by the peer.
+    ///
+    /// From version 0.7.0, channels are flow controlled: a peer may only send
+    /// a channel `window` bytes the other side has not read yet, and then
+    /// waits until they are read.
+    ///
+    /// Frames waiting for the backend are written by order of priority of
+    /// their channel, and in deficit round robin between the channels of a
+    /// given priority, so a bulk transfer cannot starve other channels.
+    ///
     /// \code{.cc}
     ///
     /// // Consider two peers, connected by an arbitrary socket s.
@@ -52,8 +69,15 @@ namespace elle
     | Construction |
     `-------------*/
     public:
-      ChanneledStream(elle::reactor::Scheduler& scheduler, Stream& backend);
-      ChanneledStream(Stream& backend);
+      /// Construct a ChanneledStream.
+      ///
+      /// @param backend The Stream to multiplex.
+      /// @param window  Bytes the peer may send on a channel before we read
+      ///                them, 0 for no limit.
+      ChanneledStream(elle::reactor::Scheduler& scheduler,
+                      Stream& backend,
+                      uint32_t window = 1 << 20);
+      ChanneledStream(Stream& backend, uint32_t window = 1 << 20);
       virtual
       ~ChanneledStream();
     private:
@@ -69,6 +93,38 @@ namespace elle
     public:
       ELLE_attribute_r(elle::Version, version, override);
 
+    /*-------------.
+    | Flow control |
+    `-------------*/
+    public:
+      /// Bytes the peer may send on a channel before we read them.
+      ELLE_ATTRIBUTE_R(uint32_t, window);
+      /// Bytes we may send on a channel before the peer reads them, as
+      /// announced during the handshake.
+      ELLE_ATTRIBUTE_R(uint32_t, peer_window);
+    private:
+      /// Whether channels are flow controlled.
+      bool
+      _flow_control() const;
+      /// Account for \a size bytes received on \a channel.
+      void
+      _received(Channel& channel, elle::Buffer::Size size);
+      /// Account for \a size bytes read from \a channel, and queue a grant
+      /// once half the window was read.
+      ///
+      /// Never blocks nor throws, so reading cannot lose a packet.
+      void
+      _consumed(Channel& channel, elle::Buffer::Size size);
+      /// Send queued grants, accounting for them once sent.
+      void
+      _grant_thread();
+      /// Channels with credit to grant back to the peer.
+      ELLE_ATTRIBUTE(reactor::Channel<int>, grants);
+      ELLE_ATTRIBUTE(reactor::Thread::unique_ptr, granter);
+      /// Add the credit granted by the peer to its channel.
+      void
+      _credit(elle::SharedBuffer packet);
+
     /*----.
     | IDs |
     `----*/
@@ -80,6 +136,9 @@ namespace elle
       _id_generate();
       bool
       _handshake(Stream& backend);
+      /// Hand a packet received on \a id to its Channel.
+      void
+      _receive(int id, elle::SharedBuffer packet);
 
     /*----------.
     | Receiving |
@@ -93,6 +152,8 @@ namespace elle
     protected:
       elle::Buffer
       _read() override;
+      elle::SharedBuffer
+      _read_shared() override;
 
     /*--------.
     | Sending |
@@ -101,8 +162,38 @@ namespace elle
       void
       _write(elle::Buffer const& packet) override;
     private:
+      /// Write \a packet on \a channel once the peer granted enough credit.
       void
-      _write(elle::Buffer const& packet, int id);
+      _write(elle::Buffer const& packet, Channel& channel);
+      void
+      _write(elle::Buffer const& packet, int id, int priority);
+      /// Write \a frame to the backend once its turn comes.
+      void
+      _send(elle::Buffer const& frame, int id, int priority);
+      /// Give the backend to the next frame in line, if any.
+      void
+      _send_next();
+      class Batch;
+      /// The batch packets are being added to, if any.
+      ELLE_ATTRIBUTE(std::shared_ptr<Batch>, batch);
+    public:
+      /// Size from which a batch is sent without waiting for more packets.
+      ELLE_ATTRIBUTE_RW(elle::Buffer::Size, batch_size);
+      /// How long a batch waits for more packets, one scheduler round if
+      /// unset.
+      ELLE_ATTRIBUTE_RW(elle::DurationOpt, batch_delay);
+      /// Number of packets sent.
+      ELLE_ATTRIBUTE_R(int64_t, packets_sent);
+      /// Number of packets written to the backend, each of them holding one
+      /// or more packets.
+      ELLE_ATTRIBUTE_R(int64_t, frames_sent);
+    private:
+      class Lane;
+      using Lanes = std::map<int, std::unique_ptr<Lane>, std::greater<int>>;
+      /// Whether a frame is being written to the backend.
+      ELLE_ATTRIBUTE(bool, sending);
+      /// Frames waiting for the backend, by decreasing priority.
+      ELLE_ATTRIBUTE(Lanes, lanes);
 
     /*----------.
     | Printable |
@@ -1,8 +1,9 @@
 #pragma once
 
+#include <deque>
 #include <ostream>
 #include <memory>
-#include <unordered_map>
+#include <vector>
 
 #include <boost/function.hpp>
 #include <boost/noncopyable.hpp>
@@ -11,6 +12,7 @@
 
 #include <elle/reactor/Thread.hh>
 
+#include <elle/protocol/Channel.hh>
 #include <elle/protocol/fwd.hh>
 
 namespace elle
@@ -118,6 +120,33 @@ namespace elle
       , public boost::noncopyable
     {
     public:
+      /// A call sent to the peer whose response was not read yet.
+      ///
+      /// Each call has its own Channel, so responses are matched to their
+      /// call whatever order they arrive in.
+      ///
+      /// Destroying a PendingCall without calling get() closes its Channel:
+      /// the remote procedure still runs, but its response, or its failure,
+      /// is discarded by the ChanneledStream when it arrives.
+      template <typename R>
+      class PendingCall
+      {
+      public:
+        PendingCall(PendingCall&& source) = default;
+        /// Wait for the response.
+        ///
+        /// @returns The result of the remote procedure.
+        /// @throws RPCError if the remote procedure failed.
+        R
+        get();
+      private:
+        template <typename I, typename O>
+        friend class RPC;
+        PendingCall(std::string const& name, Channel channel);
+        ELLE_ATTRIBUTE(std::string, name);
+        ELLE_ATTRIBUTE(Channel, channel);
+      };
+
       template <typename R, typename ... Args>
       class RemoteProcedure
       {
@@ -129,6 +158,11 @@ namespace elle
         RemoteProcedure(std::string const& name,
                         RPC<ISerializer, OSerializer>& owner);
         R operator() (Args ...);
+        /// Send the call without waiting for its response.
+        ///
+        /// Many calls can be in flight on the same ChanneledStream.
+        PendingCall<R>
+        async(Args ...);
         void operator = (boost::function<R (Args...)> const& implem);
         template <typename I, typename O>
         friend class RPC;
@@ -158,15 +192,32 @@ namespace elle
       void
       run(ExceptionHandler = {}) override;
 
+      /// Serve requests concurrently.
+      ///
+      /// @param concurrency How many requests may be processed at once, 0
+      ///                    for no limit. Further requests wait to be read.
       virtual
       void
-      parallel_run();
+      parallel_run(int concurrency = 0);
+
+      /// Whether failure replies carry the backtrace of the error.
+      ///
+      /// Backtraces often weigh kilobytes, against a few bytes for the rest of
+      /// the reply, hence they are only sent on demand.
+      ELLE_ATTRIBUTE_RW(bool, backtraces);
 
     protected:
       using LocalProcedure = BaseProcedure<ISerializer, OSerializer>;
       using NamedProcedure = std::pair<std::string,
                         std::unique_ptr<LocalProcedure>>;
-      using Procedures = std::unordered_map<uint32_t, NamedProcedure>;
+      /// Procedures, indexed by their id.
+      ///
+      /// Adding procedures must not move existing ones, which may be running.
+      using Procedures = std::deque<NamedProcedure>;
+
+      /// The procedure with \a id, or null if there is none.
+      NamedProcedure*
+      _procedure(uint32_t id);
 
       ELLE_ATTRIBUTE(Procedures, procedures, protected);
       ELLE_ATTRIBUTE(std::vector<BaseRPC*>, rpcs, protected);
@@ -1,12 +1,14 @@
 #include <type_traits>
 
 #include <elle/Backtrace.hh>
+#include <elle/finally.hh>
 #include <elle/log.hh>
 #include <elle/printf.hh>
 #include <elle/memory.hh>
 
 #include <elle/reactor/network/Error.hh>
 #include <elle/reactor/Scope.hh>
+#include <elle/reactor/semaphore.hh>
 #include <elle/reactor/scheduler.hh>
 #include <elle/reactor/Thread.hh>
 
@@ -63,6 +65,65 @@ namespace elle
     Procedure<IS, OS, R, Args ...>::~Procedure()
     {}
 
+    /*---------.
+    | Messages |
+    `---------*/
+
+    /// Run \a f with an OS appending to \a buffer.
+    ///
+    /// Serializers constructible from a Buffer write straight into it, others
+    /// go through a streambuf.
+    template <typename OS, typename F>
+    static
+    std::enable_if_t<std::is_constructible<OS, elle::Buffer&>::value>
+    with_output(elle::Buffer& buffer, F const& f)
+    {
+      OS output(buffer);
+      f(output);
+    }
+
+    template <typename OS, typename F>
+    static
+    std::enable_if_t<!std::is_constructible<OS, elle::Buffer&>::value>
+    with_output(elle::Buffer& buffer, F const& f)
+    {
+      elle::IOStream outs(buffer.ostreambuf());
+      {
+        OS output(outs);
+        f(output);
+      }
+      outs.flush();
+    }
+
+    /// Run \a f with an IS reading \a buffer, and return its result.
+    ///
+    /// Serializers constructible from a ConstWeakBuffer read straight from
+    /// it, others go through a streambuf.
+    template <typename IS, typename F>
+    static
+    auto
+    with_input(elle::ConstWeakBuffer buffer, F const& f)
+      -> std::enable_if_t<
+        std::is_constructible<IS, elle::ConstWeakBuffer>::value,
+        decltype(f(std::declval<IS&>()))>
+    {
+      IS input(buffer);
+      return f(input);
+    }
+
+    template <typename IS, typename F>
+    static
+    auto
+    with_input(elle::ConstWeakBuffer buffer, F const& f)
+      -> std::enable_if_t<
+        !std::is_constructible<IS, elle::ConstWeakBuffer>::value,
+        decltype(f(std::declval<IS&>()))>
+    {
+      elle::IOStream ins(buffer.istreambuf());
+      IS input(ins);
+      return f(input);
+    }
+
     /*------------------------.
     | RemoteProcedure helpers |
     `------------------------*/
@@ -143,10 +204,10 @@ namespace elle
     RPC<IS, OS>::RemoteProcedure<R, Args ...>::
     operator = (boost::function<R (Args...)> const& f)
     {
-      auto proc = this->_owner._procedures.find(this->_id);
-      assert(proc != this->_owner._procedures.end());
-      assert(proc->second.second == nullptr);
-      this->_owner._procedures[_id].second.reset(
+      auto proc = this->_owner._procedure(this->_id);
+      assert(proc != nullptr);
+      assert(proc->second == nullptr);
+      proc->second.reset(
         new Procedure<IS, OS, R, Args...>(
           this->_name, this->_owner, this->_id, f));
     }
@@ -159,6 +220,17 @@ namespace elle
     R
     RPC<IS, OS>::RemoteProcedure<R, Args...>::
     operator () (Args ... args)
+    {
+      return this->async(args...).get();
+    }
+
+    template <typename IS,
+              typename OS>
+    template <typename R,
+              typename ... Args>
+    typename RPC<IS, OS>::template PendingCall<R>
+    RPC<IS, OS>::RemoteProcedure<R, Args...>::
+    async(Args ... args)
     {
       ELLE_LOG_COMPONENT("elle.protocol.RPC");
 
@@ -166,20 +238,40 @@ namespace elle
                        this->_owner, this->_name);
 
       Channel channel(this->_owner._channels);
+      elle::Buffer question;
+      with_output<OS>(question, [&] (OS& output)
       {
-        elle::Buffer question;
-        {
-          elle::IOStream outs(question.ostreambuf());
-          OS output(outs);
-          output << this->_id;
-          put_args<OS, Args...>(output, args...);
-        }
-        channel.write(question);
-      }
+        output << this->_id;
+        put_args<OS, Args...>(output, args...);
+      });
+      channel.write(question);
+      return PendingCall<R>(this->_name, std::move(channel));
+    }
+
+    /*------------.
+    | PendingCall |
+    `------------*/
+
+    template <typename IS,
+              typename OS>
+    template <typename R>
+    RPC<IS, OS>::PendingCall<R>::PendingCall(std::string const& name,
+                                             Channel channel)
+      : _name(name)
+      , _channel(std::move(channel))
+    {}
+
+    template <typename IS,
+              typename OS>
+    template <typename R>
+    R
+    RPC<IS, OS>::PendingCall<R>::get()
+    {
+      ELLE_LOG_COMPONENT("elle.protocol.RPC");
+
+      auto response = this->_channel.read_shared();
+      return with_input<IS>(response, [&] (IS& input) -> R
       {
-        elle::Buffer response(channel.read());
-        elle::IOStream ins(response.istreambuf());
-        IS input(ins);
         bool res;
         input >> res;
         if (res)
@@ -189,7 +281,7 @@ namespace elle
           std::string error;
           input >> error;
           ELLE_TRACE_SCOPE("%s: remote procedure call failed: %s",
-                           this->_owner, error);
+                           this->_channel, error);
           uint16_t bt_size;
           input >> bt_size;
           std::vector<elle::StackFrame> frames;
@@ -212,7 +304,7 @@ namespace elle
           e.inner_exception(std::make_exception_ptr(inner_exception));
           throw e;
         }
-      }
+      });
     }
 
     /*------------------.
@@ -328,9 +420,12 @@ namespace elle
     RPC<IS, OS>::add(boost::function<R (Args...)> const& f)
     {
       uint32_t id = this->_id++;
+      assert(id == this->_procedures.size());
       using Proc = Procedure<IS, OS, R, Args...>;
-      this->_procedures[id] = std::unique_ptr<Proc>(new Proc(*this, id, f));
-      return RemoteProcedure<R, Args...>(*this, id);
+      this->_procedures.emplace_back(
+        std::string(),
+        std::unique_ptr<LocalProcedure>(new Proc("", *this, id, f)));
+      return RemoteProcedure<R, Args...>("", *this, id);
     }
 
     template <typename IS,
@@ -341,7 +436,8 @@ namespace elle
     RPC<IS, OS>::add(std::string const& name)
     {
       uint32_t id = this->_id++;
-      this->_procedures[id] = NamedProcedure(name, nullptr);
+      assert(id == this->_procedures.size());
+      this->_procedures.emplace_back(name, nullptr);
       return RemoteProcedure<R, Args...>(name, *this, id);
     }
 
@@ -349,13 +445,52 @@ namespace elle
               typename OS>
     RPC<IS, OS>::RPC(ChanneledStream& channels)
       : BaseRPC(channels)
+      , _backtraces(false)
     {}
 
+    template <typename IS,
+              typename OS>
+    typename RPC<IS, OS>::NamedProcedure*
+    RPC<IS, OS>::_procedure(uint32_t id)
+    {
+      if (id < this->_procedures.size())
+        return &this->_procedures[id];
+      else
+        return nullptr;
+    }
+
+    /// Write a failure reply, with the frames of \a backtrace if given.
+    template <typename OS>
+    static
+    void
+    put_error(OS& output,
+              std::string const& message,
+              elle::Backtrace const* backtrace = nullptr)
+    {
+      output << false;
+      output << message;
+      if (backtrace)
+      {
+        output << uint16_t(backtrace->frames().size());
+        for (auto const& frame: backtrace->frames())
+        {
+          output << frame.symbol;
+          output << frame.symbol_mangled;
+          output << frame.symbol_demangled;
+          output << frame.address;
+          output << frame.offset;
+        }
+      }
+      else
+        output << uint16_t(0);
+    }
+
     template<typename T>
     bool
     handle_exception(ExceptionHandler & handler,
                      T& output,
-                     std::exception_ptr ex)
+                     std::exception_ptr ex,
+                     bool backtraces)
     {
       ELLE_LOG_COMPONENT("elle.protocol.RPC");
       bool res = false;
@@ -372,31 +507,17 @@ namespace elle
           res = true;
         ELLE_TRACE_SCOPE("RPC procedure failed: %s (stop_request = %s)",
           e.what(), res);
-        output << false;
-        output << std::string(e.what());
-        output << uint16_t(e.backtrace().frames().size());
-        for (auto const& frame: e.backtrace().frames())
-        {
-          output << frame.symbol;
-          output << frame.symbol_mangled;
-          output << frame.symbol_demangled;
-          output << frame.address;
-          output << frame.offset;
-        }
+        put_error(output, e.what(), backtraces ? &e.backtrace() : nullptr);
       }
       catch (std::exception& e)
       {
         ELLE_TRACE_SCOPE("RPC procedure failed: %s", e.what());
-        output << false;
-        output << std::string(e.what());
-        output << uint16_t(0);
+        put_error(output, e.what());
       }
       catch (...)
       {
         ELLE_TRACE_SCOPE("RPC procedure failed: unknown error");
-        output << false;
-        output << std::string("unknown error");
-        output << uint16_t(0);
+        put_error(output, "unknown error");
       }
       return res;
     }
@@ -417,45 +538,46 @@ namespace elle
         {
           ELLE_TRACE_SCOPE("%s: Accepting new request...", *this);
           Channel c(this->_channels.accept());
-          elle::Buffer question(c.read());
-          elle::IOStream ins(question.istreambuf());
-          IS input(ins);
-          uint32_t id;
-          input >> id;
-          ELLE_TRACE_SCOPE("%s: Processing request for %s...", *this, id);
-          auto procedure = this->_procedures.find(id);
-
+          auto question = c.read_shared();
           elle::Buffer answer;
-          elle::IOStream outs(answer.ostreambuf());
-          OS output(outs);
-          try
+          with_input<IS>(question, [&] (IS& input)
           {
-            if (procedure == this->_procedures.end())
-              throw Exception(sprintf("call to unknown procedure: %s", id));
-            else if (procedure->second.second == nullptr)
-            {
-              throw Exception(sprintf("remote call to non-local procedure: %s",
-                                      procedure->second.first));
-            }
-            else
+            uint32_t id;
+            input >> id;
+            ELLE_TRACE_SCOPE("%s: Processing request for %s...", *this, id);
+            auto procedure = this->_procedure(id);
+            with_output<OS>(answer, [&] (OS& output)
             {
-              auto const &name = procedure->second.first;
+              try
+              {
+                if (procedure == nullptr)
+                  throw Exception(sprintf("call to unknown procedure: %s", id));
+                else if (procedure->second == nullptr)
+                {
+                  throw Exception(sprintf("remote call to non-local procedure: %s",
+                                          procedure->first));
+                }
+                else
+                {
+                  auto const &name = procedure->first;
 
-              ELLE_TRACE("%s: remote procedure called: %s", *this, name)
-                procedure->second.second->_call(input, output);
-              ELLE_TRACE("%s: procedure %s succeeded", *this, name);
-            }
-          }
-          catch (elle::reactor::Terminate const&)
-          {
-            ELLE_TRACE("%s: terminating as requested", *this);
-            throw;
-          }
-          catch (...)
-          { // Pass exception through handler if present, reply with an error
-            stop_request = handle_exception(handler, output, std::current_exception());
-          }
-          outs.flush();
+                  ELLE_TRACE("%s: remote procedure called: %s", *this, name)
+                    procedure->second->_call(input, output);
+                  ELLE_TRACE("%s: procedure %s succeeded", *this, name);
+                }
+              }
+              catch (elle::reactor::Terminate const&)
+              {
+                ELLE_TRACE("%s: terminating as requested", *this);
+                throw;
+              }
+              catch (...)
+              { // Pass exception through handler if present, reply with an error
+                stop_request = handle_exception(
+                  handler, output, std::current_exception(), this->_backtraces);
+              }
+            });
+          });
           c.write(answer);
         }
       }
@@ -468,17 +590,17 @@ namespace elle
     }
 
     // XXX: factor with run().
-    // XXX: unsafe, rpc calls must finish in the order they were started,
-    // there is no mechanism to match a rpc call with associated return
     template <typename IS,
               typename OS>
     void
-    RPC<IS, OS>::parallel_run()
+    RPC<IS, OS>::parallel_run(int concurrency)
     {
       ELLE_LOG_COMPONENT("elle.protocol.RPC");
 
       using elle::sprintf;
       using elle::Exception;
+      // Requests being processed, when limited.
+      elle::reactor::Semaphore slots(concurrency);
       try
       {
         elle::With<elle::reactor::Scope>("RPC // run") << [&] (elle::reactor::Scope& scope)
@@ -486,75 +608,69 @@ namespace elle
           int i = 0;
           while (true)
           {
+            if (concurrency > 0)
+              while (!slots.acquire())
+                elle::reactor::wait(slots);
             auto chan = std::make_shared<Channel>(this->_channels.accept());
             ++i;
 
             auto call_procedure = [&, chan] {
               ELLE_LOG_COMPONENT("elle.protocol.RPC");
+              elle::SafeFinally release([&] {
+                if (concurrency > 0)
+                  slots.release();
+              });
 
-              elle::Buffer question(chan->read());
-              elle::IOStream ins(question.istreambuf());
-              IS input(ins);
-              uint32_t id;
-              input >> id;
-              auto procedure = this->_procedures.find(id);
-
+              auto question = chan->read_shared();
               elle::Buffer answer;
-              elle::IOStream outs(answer.ostreambuf());
-              OS output(outs);
-              try
+              with_input<IS>(question, [&] (IS& input)
               {
-                if (procedure == _procedures.end())
-                  throw Exception(sprintf("call to unknown procedure: %s", id));
-                else if (procedure->second.second == nullptr)
+                uint32_t id;
+                input >> id;
+                auto procedure = this->_procedure(id);
+                with_output<OS>(answer, [&] (OS& output)
                 {
-                  throw Exception(sprintf("remote call to non-local procedure: %s",
-                                          procedure->second.first));
-                }
-                else
-                {
-                  auto const &name = procedure->second.first;
-
-                  ELLE_TRACE("%s: remote procedure called: %s", *this, name)
-                    procedure->second.second->_call(input, output);
-                  ELLE_TRACE("%s: procedure %s succeeded", *this, name);
-                }
-              }
-              catch (elle::Error const& e)
-              {
-                ELLE_TRACE("%s: procedure failed: %s", *this, e.what());
-                output << false;
-                output << std::string(e.what());
-                output << uint16_t(e.backtrace().frames().size());
-                for (auto const& frame: e.backtrace().frames())
-                {
-                  output << frame.symbol;
-                  output << frame.symbol_mangled;
-                  output << frame.symbol_demangled;
-                  output << frame.address;
-                  output << frame.offset;
-                }
-              }
-              catch (elle::reactor::Terminate const&)
-              {
-                ELLE_TRACE("%s: terminating as requested", *this);
-                throw;
-              }
-              catch (std::exception& e)
-              {
-                ELLE_TRACE("%s: procedure failed: %s", *this, e.what());
-                output << false;
-                output << std::string(e.what());
-                output << uint16_t(0);
-              }
-              catch (...)
-              {
-                ELLE_TRACE("%s: procedure failed: unknown error", *this);
-                output << false;
-                output << std::string("unknown error");
-                output << uint16_t(0);
-              }
-              outs.flush();
+                  try
+                  {
+                    if (procedure == nullptr)
+                      throw Exception(sprintf("call to unknown procedure: %s", id));
+                    else if (procedure->second == nullptr)
+                    {
+                      throw Exception(sprintf("remote call to non-local procedure: %s",
+                                              procedure->first));
+                    }
+                    else
+                    {
+                      auto const &name = procedure->first;
+
+                      ELLE_TRACE("%s: remote procedure called: %s", *this, name)
+                        procedure->second->_call(input, output);
+                      ELLE_TRACE("%s: procedure %s succeeded", *this, name);
+                    }
+                  }
+                  catch (elle::Error const& e)
+                  {
+                    ELLE_TRACE("%s: procedure failed: %s", *this, e.what());
+                    put_error(output, e.what(),
+                              this->_backtraces ? &e.backtrace() : nullptr);
+                  }
+                  catch (elle::reactor::Terminate const&)
+                  {
+                    ELLE_TRACE("%s: terminating as requested", *this);
+                    throw;
+                  }
+                  catch (std::exception& e)
+                  {
+                    ELLE_TRACE("%s: procedure failed: %s", *this, e.what());
+                    put_error(output, e.what());
+                  }
+                  catch (...)
+                  {
+                    ELLE_TRACE("%s: procedure failed: unknown error", *this);
+                    put_error(output, "unknown error");
+                  }
+                });
+              });
               chan->write(answer);
             };
             scope.run_background(elle::sprintf("RPC %s", i), call_procedure);
@@ -5,6 +5,7 @@
 #endif
 
 #include <elle/Buffer.hh>
+#include <elle/crc32c.hh>
 #include <elle/log.hh>
 
 #include <elle/cryptography/hash.hh>
@@ -16,6 +17,7 @@
 #include <elle/reactor/exception.hh>
 #include <elle/reactor/Barrier.hh>
 #include <elle/reactor/network/socket.hh>
+#include <elle/reactor/network/TCPSocket.hh>
 #include <elle/reactor/network/utp-socket.hh>
 
 #include <elle/protocol/Serializer.hh>
@@ -74,16 +76,27 @@ namespace elle
       return content;
     }
 
-    // Return the sha1 of a given buffer.
+    // Return the checksum of a given buffer: a big-endian CRC-32C from
+    // version 0.4.0, its sha1 before.
     static
     elle::Buffer
-    compute_checksum(elle::Buffer const& content)
+    compute_checksum(elle::Buffer const& content,
+                     elle::Version const& version)
     {
       ELLE_DUMP("compute checksum of '%x'", content);
-      auto hash = elle::cryptography::hash(
-        elle::ConstWeakBuffer(content.contents(),
-                              content.size()),
-        elle::cryptography::Oneway::sha1);
+      auto hash = [&]
+      {
+        if (version >= elle::Version(0, 4, 0))
+        {
+          auto const crc = htonl(elle::crc32c(content));
+          return elle::Buffer(&crc, sizeof crc);
+        }
+        else
+          return elle::cryptography::hash(
+            elle::ConstWeakBuffer(content.contents(),
+                                  content.size()),
+            elle::cryptography::Oneway::sha1);
+      }();
       ELLE_DUMP("checksum: '%x'", hash);
       return hash;
     }
@@ -92,11 +105,12 @@ namespace elle
     static
     void
     enforce_checksums_equal(elle::Buffer const& content,
-                            elle::Buffer const& expected_checksum)
+                            elle::Buffer const& expected_checksum,
+                            elle::Version const& version)
     {
       ELLE_DUMP_SCOPE("compare '%x' checksum with expected '%x'",
                        content, expected_checksum);
-      auto checksum = compute_checksum(content);
+      auto checksum = compute_checksum(content, version);
       ELLE_DUMP("checksum: '%x'", checksum);
       if (checksum != expected_checksum)
       {
@@ -170,6 +184,7 @@ namespace elle
             this->_pinger.async_wait(this->_pinger_handler);
           })
         , _stream(stream)
+        , _socket(dynamic_cast<elle::reactor::network::Socket*>(&stream))
         , _chunk_size(chunk_size)
         , _checksum(checksum)
         , _version(version)
@@ -178,6 +193,12 @@ namespace elle
       {
         if (bool(this->_ping_period) != bool(this->_ping_delay))
           elle::err("specify either both ping period and timeout or neither");
+        // Packets are flushed whole, Nagle's algorithm would only hold their
+        // tail back until the peer acknowledges the rest, which it may delay
+        // by tens of milliseconds once the stream pauses.
+        if (auto tcp =
+            dynamic_cast<elle::reactor::network::TCPSocket*>(&stream))
+          tcp->socket()->set_option(boost::asio::ip::tcp::no_delay(true));
         if (this->_ping_period && this->version() >= elle::Version(0, 3, 0))
           this->_pinger_handler({});
       }
@@ -220,7 +241,7 @@ namespace elle
         // return elle::With<elle::reactor::Thread::NonInterruptible>() << [&]
         // {
           elle::Buffer hash;
-          if (this->_checksum)
+          if (this->_checksum && !this->_chunk_checksums())
           {
             ELLE_DEBUG("read checksum")
               if (this->version() >= elle::Version(0, 2, 0))
@@ -238,12 +259,28 @@ namespace elle
               ELLE_DEBUG("packet size: %s", total_size);
               elle::Buffer packet(static_cast<std::size_t>(total_size));
               elle::Buffer::Size offset = 0;
+              // Verify chunks while they are hot in cache, but only report
+              // corruption once the whole packet is read, to stay in sync
+              // with the peer.
+              auto corrupted = false;
               while (true)
               {
                 uint32_t size =
                   std::min(total_size - offset, this->_chunk_size);
+                auto expected = uint32_t(0);
+                if (this->_chunk_checksums())
+                {
+                  auto crc = elle::Buffer(sizeof expected);
+                  elle::protocol::read(this->_stream, crc, sizeof expected);
+                  memcpy(&expected, crc.contents(), sizeof expected);
+                }
                 ELLE_DEBUG("read chunk of size %s", size);
                 elle::protocol::read(this->_stream, packet, size, offset);
+                if (this->_chunk_checksums() &&
+                    elle::crc32c(elle::ConstWeakBuffer(
+                                   packet.contents() + offset, size))
+                    != ntohl(expected))
+                  corrupted = true;
                 offset += size;
                 ELLE_ASSERT_LTE(offset, total_size);
                 if (offset >= total_size)
@@ -251,6 +288,11 @@ namespace elle
                 if (!this->read_control())
                   throw InterruptionError();
               }
+              if (corrupted)
+              {
+                ELLE_ERR("wrong packet checksum")
+                  throw ChecksumError();
+              }
               return packet;
             }
             else
@@ -258,14 +300,19 @@ namespace elle
           }();
           ELLE_DUMP("packet content: %s", packet);
           // Check checksums match.
-          if (this->_checksum)
-            enforce_checksums_equal(packet, hash);
+          if (this->_checksum && !this->_chunk_checksums())
+            enforce_checksums_equal(packet, hash, this->version());
           return packet;
         }
         catch (InterruptionError const&)
         {
           throw;
         }
+        // The whole packet was read, the stream is still in sync.
+        catch (ChecksumError const&)
+        {
+          throw;
+        }
         catch (...)
         {
           ELLE_TRACE("read interrupted, switching to broken state: %s",
@@ -285,31 +332,43 @@ namespace elle
 
       void
       write_control(Control control)
+      {
+        this->write_control(this->_stream, control);
+      }
+
+      void
+      write_control(std::ostream& output, Control control)
       {
         if (control != Control::pong && control != Control::ping)
-          this->write_pings_pongs(false);
+          this->write_pings_pongs(output);
         ELLE_DEBUG_SCOPE("send control %s", (int) control);
         char c = static_cast<char>(control);
-        this->_stream.write(&c, 1);
+        output.write(&c, 1);
       }
 
       void
       write_pings_pongs(bool flush)
+      {
+        this->write_pings_pongs(this->_stream);
+        if (flush)
+          this->_stream.flush();
+      }
+
+      void
+      write_pings_pongs(std::ostream& output)
       {
         while (this->_pongs || this->_pings)
         {
           while (this->_pongs)
           {
             --this->_pongs;
-            this->write_control(Control::pong);
+            this->write_control(output, Control::pong);
           }
           while (this->_pings)
           {
             --this->_pings;
-            this->write_control(Control::ping);
+            this->write_control(output, Control::ping);
           }
-         if (flush)
-           this->_stream.flush();
         }
       }
 
@@ -393,20 +452,57 @@ namespace elle
       ELLE_ATTRIBUTE(std::list<boost::asio::deadline_timer>, ping_timers);
       ELLE_ATTRIBUTE_RX(boost::signals2::signal<void ()>, ping_timeout);
 
+      /// Send header, then size bytes of packet at offset, and flush.
+      ///
+      /// On sockets, the header and the payload go out in a single gather
+      /// write, without copying the payload in the stream buffer.
+      void
+      _send(elle::Buffer& header,
+            elle::Buffer const& packet,
+            elle::Buffer::Size offset,
+            elle::Buffer::Size size)
+      {
+        ELLE_DEBUG_SCOPE("send %s bytes of header and %s bytes of data "
+                         "at offset %s", header.size(), size, offset);
+        if (this->_socket)
+        {
+          // Data already buffered in the stream must go first.
+          this->_stream.flush();
+          this->_socket->write(
+            std::vector<elle::ConstWeakBuffer>{
+              elle::ConstWeakBuffer(header),
+              elle::ConstWeakBuffer(packet.contents() + offset, size)});
+        }
+        else
+        {
+          this->_stream.write(
+            reinterpret_cast<char const*>(header.contents()), header.size());
+          this->_stream.write(
+            reinterpret_cast<char const*>(packet.contents()) + offset, size);
+          this->_stream.flush();
+        }
+        header.size(0);
+      }
+
       void
       _write(elle::Buffer const& packet)
       {
-        if (this->version() >= elle::Version(0, 3, 0))
-          this->write_control(Control::keep_going);
-        if (this->_checksum)
+        // Headers preceding the next payload slice.
+        auto header = elle::Buffer{};
         {
-          // Compute and send checksum.
-          auto hash = compute_checksum(packet);
-          elle::With<elle::reactor::Thread::NonInterruptible>() << [&]
+          elle::IOStream output(header.ostreambuf());
+          if (this->version() >= elle::Version(0, 3, 0))
+            this->write_control(output, Control::keep_going);
+          if (this->_checksum && !this->_chunk_checksums())
           {
+            // Compute and send checksum.
+            auto hash = compute_checksum(packet, this->version());
             ELLE_DEBUG("send checksum: 0x%x", hash)
-              elle::protocol::write(this->_stream, this->version(), hash);
-          };
+              elle::protocol::write(output, this->version(), hash);
+          }
+          auto size = packet.size();
+          ELLE_DEBUG("send packet size %s", size)
+            Serializer::Super::uint32_put(output, size, this->version());
         }
         if (this->version() >= elle::Version(0, 2, 0))
         {
@@ -416,32 +512,28 @@ namespace elle
             auto send = [&]
               {
                 auto to_send = std::min(this->_chunk_size, packet.size() - offset);
-                ELLE_DEBUG_SCOPE("send %s bytes of data at offset %s",
-                                 to_send, offset);
-                elle::protocol::write(
-                  this->_stream,
-                  this->version(), packet, false, offset, to_send);
-                offset += to_send;
-                this->_stream.flush();
-              };
-            {
-              elle::With<elle::reactor::Thread::NonInterruptible>() << [&]
-              {
-                // Send the size.
+                if (this->_chunk_checksums())
                 {
-                  auto size = packet.size();
-                  ELLE_DEBUG("send packet size %s", size)
-                    Serializer::Super::uint32_put(this->_stream, size, this->version());
+                  auto const crc = htonl(elle::crc32c(
+                    elle::ConstWeakBuffer(packet.contents() + offset, to_send)));
+                  header.append(&crc, sizeof crc);
                 }
-                // Send first chunk
-                send();
+                this->_send(header, packet, offset, to_send);
+                offset += to_send;
               };
-            }
+            // Send the size and first chunk
+            elle::With<elle::reactor::Thread::NonInterruptible>() << [&]
+            {
+              send();
+            };
             while (offset < packet.size())
             {
               elle::With<elle::reactor::Thread::NonInterruptible>() << [&]
               {
-                this->write_control(Control::keep_going);
+                {
+                  elle::IOStream output(header.ostreambuf());
+                  this->write_control(output, Control::keep_going);
+                }
                 send();
               };
               this->write_pings_pongs(true);
@@ -465,12 +557,19 @@ namespace elle
           elle::With<elle::reactor::Thread::NonInterruptible>() << [&]
           {
             ELLE_DEBUG("send actual data")
-              elle::protocol::write(this->_stream, this->version(), packet);
-            this->_stream.flush();
+              this->_send(header, packet, 0, packet.size());
           };
       }
+      /// Whether the checksum is computed per chunk instead of per packet.
+      bool
+      _chunk_checksums() const
+      {
+        return this->_checksum && this->version() >= elle::Version(0, 5, 0);
+      }
     private:
       ELLE_ATTRIBUTE_RX(std::iostream&, stream, protected);
+      /// The stream as a socket, to send packets with gather writes.
+      ELLE_ATTRIBUTE(elle::reactor::network::Socket*, socket);
       ELLE_ATTRIBUTE(elle::Buffer::Size, chunk_size, protected);
       ELLE_ATTRIBUTE(bool, checksum, protected);
       ELLE_ATTRIBUTE_R(elle::Version, version);
@@ -519,7 +618,7 @@ namespace elle
       }
       ELLE_TRACE("using version: '%s'", this->version());
       this->_impl.reset(
-        new Impl(stream, this->_chunk_size, checksum, version,
+        new Impl(stream, this->_chunk_size, checksum, this->_version,
                  std::move(ping_period), std::move(ping_timeout)));
       this->_impl->ping_timeout().connect(this->_ping_timeout);
     }
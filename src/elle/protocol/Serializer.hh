@@ -63,7 +63,9 @@ namespace elle
       /// @param stream The underlying std::iostream.
       /// @param version The version of the protocol.
       /// @param checksum Whether it should read and write the checksum of
-      ///                 packets sent.
+      ///                 packets sent: a CRC-32C of every chunk from
+      ///                 version 0.5.0, of the whole packet from 0.4.0, a
+      ///                 sha1 before.
       Serializer(std::iostream& stream,
                  elle::Version const& version = elle::Version(0, 1, 0),
                  bool checksum = true,
@@ -13,6 +13,7 @@
 #endif
 
 #include <elle/serialization/binary.hh>
+#include <elle/serialization/binary/number.hh>
 
 ELLE_LOG_COMPONENT("elle.protocol.Stream");
 
@@ -48,6 +49,19 @@ namespace elle
       return this->_read();
     }
 
+    elle::SharedBuffer
+    Stream::read_shared()
+    {
+      ELLE_TRACE_SCOPE("%s: read shared packet", this);
+      return this->_read_shared();
+    }
+
+    elle::SharedBuffer
+    Stream::_read_shared()
+    {
+      return this->_read();
+    }
+
     /*--------.
     | Sending |
     `--------*/
@@ -68,8 +82,10 @@ namespace elle
     {
       if (v >= elle::Version(0, 3, 0))
       {
-        elle::IOStream output(b.ostreambuf());
-        SerializerOut::serialize_number(output, i);
+        auto const size = b.size();
+        b.size(size + number_max_size);
+        b.size(write_number(b.mutable_contents() + size, i) -
+               b.mutable_contents());
       }
       else
       {
@@ -83,9 +99,9 @@ namespace elle
     {
       if (v >= elle::Version(0, 3, 0))
       {
-        elle::IOStream input(b.istreambuf());
-        int64_t res;
-        b.pop_front(SerializerIn::serialize_number(input, res));
+        elle::Buffer::Byte const* p = b.contents();
+        auto const res = read_number(p, p + b.size());
+        b.pop_front(p - b.contents());
         return (uint32_t) res;
       }
       else
@@ -98,6 +114,26 @@ namespace elle
       }
     }
 
+    uint32_t
+    Stream::uint32_get(elle::SharedBuffer& b, elle::Version const& v)
+    {
+      if (v >= elle::Version(0, 3, 0))
+      {
+        auto p = b.contents();
+        auto const res = read_number(p, p + b.size());
+        b = b.range(p - b.contents());
+        return (uint32_t) res;
+      }
+      else
+      {
+        uint32_t i;
+        ELLE_ASSERT_GTE((signed)b.size(), 4);
+        memcpy(&i, b.contents(), 4);
+        b = b.range(4);
+        return ntohl(i);
+      }
+    }
+
     void
     Stream::uint32_put(std::ostream& s, uint32_t i, elle::Version const& v)
     {
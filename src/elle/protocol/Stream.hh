@@ -50,10 +50,22 @@ namespace elle
       /// @returns A Buffer.
       elle::Buffer
       read();
+      /// Read a buffer, possibly a slice of a larger packet.
+      ///
+      /// Unlike read, this lets streams hand out part of a packet they
+      /// received without copying it.
+      ///
+      /// @returns A SharedBuffer.
+      elle::SharedBuffer
+      read_shared();
     protected:
       virtual
       elle::Buffer
       _read() = 0;
+      /// Read a shared buffer. Defaults to sharing the result of _read.
+      virtual
+      elle::SharedBuffer
+      _read_shared();
 
     /*--------.
     | Sending |
@@ -115,6 +127,14 @@ namespace elle
       static
       uint32_t
       uint32_get(elle::Buffer& s, elle::Version const& v);
+      /// Read an uint32_t from \a given buffer, and drop it from the buffer
+      /// without moving the rest of the data.
+      ///
+      /// @param b The buffer to read from.
+      /// @param v The version.
+      static
+      uint32_t
+      uint32_get(elle::SharedBuffer& b, elle::Version const& v);
     };
   }
 }
@@ -0,0 +1,311 @@
+#include <algorithm>
+
+#include <elle/finally.hh>
+#include <elle/log.hh>
+#include <elle/reactor/Barrier.hh>
+#include <elle/reactor/ShardedScheduler.hh>
+#include <elle/reactor/Thread.hh>
+
+ELLE_LOG_COMPONENT("elle.reactor.ShardedScheduler");
+
+namespace elle
+{
+  namespace reactor
+  {
+    /*------.
+    | Shard |
+    `------*/
+
+    class ShardedScheduler::Shard
+    {
+    public:
+      Shard(int index)
+        : index(index)
+        , scheduler()
+        , mutex()
+        , queue()
+        , load(0)
+        , idle(false)
+        , wake(elle::sprintf("shard %s wake", index))
+      {}
+
+      int index;
+      Scheduler scheduler;
+      /// Protect queue, which is accessed by spawners and thieves.
+      std::mutex mutex;
+      std::deque<std::pair<std::string, Action>> queue;
+      /// Queued and live Threads.
+      std::atomic<int> load;
+      /// Whether the dispatcher is waiting for work.
+      std::atomic<bool> idle;
+      /// Only ever touched from the shard system thread.
+      Barrier wake;
+    };
+
+    /*-------------.
+    | Construction |
+    `-------------*/
+
+    ShardedScheduler::ShardedScheduler(int shards, bool steal)
+      : _shards()
+      , _steal(steal)
+      , _stopping(false)
+      , _steals(0)
+      , _exception_mutex()
+      , _exception()
+    {
+      if (shards <= 0)
+        shards = std::max(1u, std::thread::hardware_concurrency());
+      for (int i = 0; i < shards; ++i)
+        this->_shards.emplace_back(std::make_unique<Shard>(i));
+    }
+
+    ShardedScheduler::~ShardedScheduler()
+    {}
+
+    /*-------.
+    | Shards |
+    `-------*/
+
+    int
+    ShardedScheduler::size() const
+    {
+      return this->_shards.size();
+    }
+
+    Scheduler&
+    ShardedScheduler::shard(int i)
+    {
+      return this->_shards.at(i)->scheduler;
+    }
+
+    int
+    ShardedScheduler::least_loaded() const
+    {
+      int res = 0;
+      int min = this->_shards[0]->load;
+      for (int i = 1; i < this->size(); ++i)
+      {
+        int load = this->_shards[i]->load;
+        if (load < min)
+        {
+          min = load;
+          res = i;
+        }
+      }
+      return res;
+    }
+
+    int
+    ShardedScheduler::load(int i) const
+    {
+      return this->_shards.at(i)->load;
+    }
+
+    int
+    ShardedScheduler::steals() const
+    {
+      return this->_steals;
+    }
+
+    /*--------.
+    | Threads |
+    `--------*/
+
+    void
+    ShardedScheduler::spawn(std::string name, Action action, int shard)
+    {
+      if (shard < 0)
+        shard = this->least_loaded();
+      auto& s = *this->_shards.at(shard);
+      ELLE_DEBUG("%s: queue %s on shard %s", *this, name, shard);
+      ++s.load;
+      {
+        std::unique_lock<std::mutex> lock(s.mutex);
+        s.queue.emplace_back(std::move(name), std::move(action));
+      }
+      this->_wake(s);
+      if (this->_steal)
+        for (auto& peer: this->_shards)
+          if (peer.get() != &s && peer->idle)
+          {
+            this->_wake(*peer);
+            break;
+          }
+    }
+
+    void
+    ShardedScheduler::_wake(Shard& shard)
+    {
+      // The barrier belongs to the shard system thread: bounce through asio,
+      // which is the only thread-safe way in.
+      shard.scheduler.io_service().post([&shard] { shard.wake.open(); });
+    }
+
+    bool
+    ShardedScheduler::_pop(Shard& shard, std::pair<std::string, Action>& task)
+    {
+      {
+        std::unique_lock<std::mutex> lock(shard.mutex);
+        if (!shard.queue.empty())
+        {
+          task = std::move(shard.queue.front());
+          shard.queue.pop_front();
+          return true;
+        }
+      }
+      if (!this->_steal)
+        return false;
+      // Steal from the back of the longest queue, leaving the victim the
+      // actions it would run first.
+      Shard* victim = nullptr;
+      std::size_t longest = 0;
+      for (auto& peer: this->_shards)
+        if (peer.get() != &shard)
+        {
+          std::unique_lock<std::mutex> lock(peer->mutex);
+          if (peer->queue.size() > longest)
+          {
+            longest = peer->queue.size();
+            victim = peer.get();
+          }
+        }
+      if (!victim)
+        return false;
+      {
+        std::unique_lock<std::mutex> lock(victim->mutex);
+        if (victim->queue.empty())
+          return false;
+        task = std::move(victim->queue.back());
+        victim->queue.pop_back();
+      }
+      --victim->load;
+      ++shard.load;
+      ++this->_steals;
+      ELLE_DEBUG("%s: shard %s steals %s from shard %s",
+                 *this, shard.index, task.first, victim->index);
+      return true;
+    }
+
+    void
+    ShardedScheduler::_dispatch(Shard& shard)
+    {
+      ELLE_TRACE_SCOPE("%s: dispatch shard %s", *this, shard.index);
+      std::pair<std::string, Action> task;
+      while (true)
+      {
+        shard.wake.close();
+        if (this->_pop(shard, task))
+        {
+          shard.idle = false;
+          new Thread(
+            shard.scheduler, task.first,
+            [this, &shard, action = std::move(task.second)]
+            {
+              elle::SafeFinally release(
+                [&]
+                {
+                  if (--shard.load == 0 && this->_stopping)
+                    shard.wake.open();
+                });
+              action();
+            },
+            true);
+          // Start at most one action per round so the remainder of the queue
+          // stays up for grabs by idle shards.
+          reactor::yield();
+        }
+        else if (this->_stopping && shard.load == 0)
+          break;
+        else
+        {
+          shard.idle = true;
+          reactor::wait(shard.wake);
+        }
+      }
+      shard.idle = false;
+      ELLE_TRACE("%s: shard %s is done", *this, shard.index);
+    }
+
+    /*----.
+    | Run |
+    `----*/
+
+    void
+    ShardedScheduler::run()
+    {
+      ELLE_TRACE_SCOPE("%s: run %s shards", *this, this->size());
+      for (auto& shard: this->_shards)
+      {
+        auto* s = shard.get();
+        new Thread(s->scheduler,
+                   elle::sprintf("shard %s dispatcher", s->index),
+                   [this, s] { this->_dispatch(*s); },
+                   true);
+      }
+      std::vector<std::thread> threads;
+      for (auto& shard: this->_shards)
+      {
+        auto* s = shard.get();
+        threads.emplace_back(
+          [this, s]
+          {
+            try
+            {
+              s->scheduler.run();
+            }
+            catch (...)
+            {
+              ELLE_WARN("%s: shard %s failed: %s",
+                        *this, s->index, elle::exception_string());
+              {
+                std::unique_lock<std::mutex> lock(this->_exception_mutex);
+                if (!this->_exception)
+                  this->_exception = std::current_exception();
+              }
+              this->terminate();
+            }
+          });
+      }
+      for (auto& thread: threads)
+        thread.join();
+      ELLE_TRACE("%s: done, %s steals", *this, this->steals());
+      if (auto e = this->_exception)
+      {
+        this->_exception = nullptr;
+        std::rethrow_exception(e);
+      }
+    }
+
+    void
+    ShardedScheduler::stop()
+    {
+      ELLE_TRACE_SCOPE("%s: stop", *this);
+      this->_stopping = true;
+      for (auto& shard: this->_shards)
+        this->_wake(*shard);
+    }
+
+    void
+    ShardedScheduler::terminate()
+    {
+      ELLE_TRACE_SCOPE("%s: terminate", *this);
+      this->_stopping = true;
+      for (auto& shard: this->_shards)
+      {
+        auto* s = &shard->scheduler;
+        s->io_service().post([s] { s->terminate_later(); });
+      }
+    }
+
+    /*----------.
+    | Printable |
+    `----------*/
+
+    void
+    ShardedScheduler::print(std::ostream& s) const
+    {
+      s << "ShardedScheduler " << this;
+    }
+  }
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <elle/Printable.hh>
+#include <elle/attribute.hh>
+#include <elle/reactor/fwd.hh>
+#include <elle/reactor/scheduler.hh>
+
+namespace elle
+{
+  namespace reactor
+  {
+    /// A set of Schedulers, each driven by its own system thread.
+    ///
+    /// A single Scheduler runs every Thread on one system thread. A
+    /// ShardedScheduler runs one Scheduler (a shard) per core, and lets
+    /// Threads be spawned on a given shard or on the least loaded one.
+    ///
+    /// Spawned actions are first queued on their shard, and each shard
+    /// dispatcher starts at most one of them per scheduler round. Idle shards
+    /// steal queued actions from busy ones. Once started, a Thread stays on
+    /// its shard for its whole life: its timers, waitables and coroutine
+    /// context all belong to its Scheduler, so only runnable Threads that
+    /// were never stepped migrate.
+    ///
+    /// \code{.cc}
+    ///
+    /// auto shards = elle::reactor::ShardedScheduler{4};
+    /// for (auto& socket: sockets)
+    ///   shards.spawn("serve", [&] { serve(socket); });
+    /// shards.spawn("stopper", [&] { wait(done); shards.stop(); });
+    /// shards.run();
+    ///
+    /// \endcode
+    class ShardedScheduler
+      : public elle::Printable
+    {
+    /*------.
+    | Types |
+    `------*/
+    public:
+      using Self = ShardedScheduler;
+      using Action = std::function<void ()>;
+
+    /*-------------.
+    | Construction |
+    `-------------*/
+    public:
+      /// Create a ShardedScheduler.
+      ///
+      /// \param shards Number of shards, the number of cores if zero.
+      /// \param steal  Whether idle shards steal work from busy ones.
+      ShardedScheduler(int shards = 0, bool steal = true);
+      ~ShardedScheduler();
+
+    /*-------.
+    | Shards |
+    `-------*/
+    public:
+      /// Number of shards.
+      int
+      size() const;
+      /// The Scheduler of the \a i-th shard.
+      Scheduler&
+      shard(int i);
+      /// Index of the shard with the fewest queued and live Threads.
+      int
+      least_loaded() const;
+      /// Number of queued and live Threads on the \a i-th shard.
+      int
+      load(int i) const;
+      /// Number of actions stolen by idle shards so far.
+      int
+      steals() const;
+    private:
+      class Shard;
+      ELLE_ATTRIBUTE(std::vector<std::unique_ptr<Shard>>, shards);
+      ELLE_ATTRIBUTE_R(bool, steal);
+
+    /*--------.
+    | Threads |
+    `--------*/
+    public:
+      /// Spawn a Thread running \a action.
+      ///
+      /// This is safe to call from any system thread, including a Thread of
+      /// one of the shards.
+      ///
+      /// \param name   A descriptive name of the Thread.
+      /// \param action The action to run.
+      /// \param shard  The shard to run on, the least loaded one if negative.
+      void
+      spawn(std::string name, Action action, int shard = -1);
+    private:
+      bool
+      _pop(Shard& shard, std::pair<std::string, Action>& task);
+      void
+      _dispatch(Shard& shard);
+      void
+      _wake(Shard& shard);
+
+    /*----.
+    | Run |
+    `----*/
+    public:
+      /// Run every shard on its own system thread and block until they are
+      /// all done.
+      ///
+      /// Shards keep waiting for work until stop() is called. If an exception
+      /// escapes a shard, every shard is terminated and the first exception
+      /// is rethrown.
+      void
+      run();
+      /// Let shards finish once their queued and live Threads are done.
+      void
+      stop();
+      /// Terminate every Thread of every shard.
+      void
+      terminate();
+    private:
+      ELLE_ATTRIBUTE(std::atomic<bool>, stopping);
+      ELLE_ATTRIBUTE(std::atomic<int>, steals);
+      ELLE_ATTRIBUTE(std::mutex, exception_mutex);
+      ELLE_ATTRIBUTE(std::exception_ptr, exception);
+
+    /*----------.
+    | Printable |
+    `----------*/
+    public:
+      void
+      print(std::ostream& s) const override;
+    };
+  }
+}
@@ -38,6 +38,8 @@ namespace elle
                   name,
                   std::bind(&Thread::_action_wrapper, this, std::move(action))))
       , _scheduler(scheduler)
+      , _scheduler_queue(Queue::none)
+      , _scheduler_hook()
       , _terminating(false)
       , _interruptible(true)
     {
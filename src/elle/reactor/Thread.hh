@@ -1,5 +1,6 @@
 #pragma once
 
+#include <boost/intrusive/list_hook.hpp>
 #include <boost/signals2.hpp>
 #include <boost/system/error_code.hpp>
 
@@ -367,6 +368,18 @@ namespace elle
       friend class Scheduler;
       ELLE_ATTRIBUTE(std::unique_ptr<backend::Thread>, thread);
       ELLE_ATTRIBUTE(Scheduler&, scheduler);
+      /// The Scheduler queue this is linked in.
+      enum class Queue
+      {
+        none,
+        starting,
+        running,
+        frozen,
+      };
+      ELLE_ATTRIBUTE(Queue, scheduler_queue);
+      /// Intrusive link in the Scheduler queues, so moving between them never
+      /// allocates.
+      ELLE_ATTRIBUTE(boost::intrusive::list_member_hook<>, scheduler_hook);
       ELLE_ATTRIBUTE_R(bool, terminating);
       /// If set to false, do not rethrow Terminate exception.
       ELLE_ATTRIBUTE_Rw(bool, interruptible);
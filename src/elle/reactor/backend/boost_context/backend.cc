@@ -1,3 +1,6 @@
+#include <sys/mman.h>
+#include <unistd.h>
+
 #include <boost/context/fcontext.hpp>
 
 #ifdef VALGRIND
@@ -7,6 +10,7 @@
 #include <elle/Backtrace.hh>
 #include <elle/assert.hh>
 #include <elle/log.hh>
+#include <elle/os/environ.hh>
 #include <elle/reactor/backend/boost_context/backend.hh>
 #include <elle/reactor/exception.hh>
 
@@ -46,17 +50,34 @@ namespace elle
             return Min;
           }
 
+          static
+          std::size_t
+          guard_size()
+          {
+            static auto const res = std::size_t(::sysconf(_SC_PAGESIZE));
+            return res;
+          }
+
+          /// Map a stack of \a size bytes, preceded by a guard page so an
+          /// overflow faults instead of silently corrupting the heap.
           void*
           allocate(std::size_t size) const
           {
             ELLE_ASSERT(minimum_stack_size() <= size);
             ELLE_ASSERT(maximum_stack_size() >= size);
 
-            void* limit = std::malloc(size);
-            if (!limit)
+            void* limit = ::mmap(nullptr, size + guard_size(),
+                                 PROT_READ | PROT_WRITE,
+                                 MAP_PRIVATE | MAP_ANON, -1, 0);
+            if (limit == MAP_FAILED)
               throw std::bad_alloc();
-
-            return static_cast<char*>(limit) + size;
+            // Stacks grow downward: the guard goes at the lowest address.
+            if (::mprotect(limit, guard_size(), PROT_NONE))
+            {
+              ::munmap(limit, size + guard_size());
+              throw std::bad_alloc();
+            }
+            return static_cast<char*>(limit) + guard_size() + size;
           }
 
           void
@@ -66,8 +87,8 @@ namespace elle
             ELLE_ASSERT(minimum_stack_size() <= size);
             ELLE_ASSERT(maximum_stack_size() >= size);
 
-            void* limit = static_cast<char*>(vp) - size;
-            std::free(limit);
+            void* limit = static_cast<char*>(vp) - size - guard_size();
+            ::munmap(limit, size + guard_size());
           }
         };
 
@@ -112,7 +133,7 @@ namespace elle
             : Super(name, std::move(action))
             , _backend(backend)
             , _stack_size(StackAllocator::default_stack_size())
-            , _stack_pointer(stack_allocator.allocate(this->_stack_size))
+            , _stack_pointer(backend._stack_allocate())
             , _context(make_fcontext(this->_stack_pointer,
                                      this->_stack_size, wrapped_run))
             , _caller(nullptr)
@@ -135,8 +156,7 @@ namespace elle
             if (this->_context)
             {
               this->_context = nullptr;
-              stack_allocator.deallocate(this->_stack_pointer,
-                                         StackAllocator::default_stack_size());
+              this->_backend._stack_release(this->_stack_pointer);
             }
 #ifdef VALGRIND
             VALGRIND_STACK_DEREGISTER(this->_valgrind_stack);
@@ -308,13 +328,76 @@ namespace elle
         | Backend |
         `--------*/
 
-        Backend::Backend():
-          _self(new Thread(*this)),
-          _current(this->_self.get())
+        Backend::Backend()
+          : _stack_pool_capacity(
+            elle::os::getenv("ELLE_REACTOR_STACK_POOL", 64))
+          , _stack_pool_hits(0)
+          , _stack_pool_misses(0)
+          , _stack_pool_mutex()
+          , _stack_pool()
+          , _self(new Thread(*this))
+          , _current(this->_self.get())
         {}
 
         Backend::~Backend()
-        = default;
+        {
+          this->_self.reset();
+          this->stack_pool_capacity(0);
+        }
+
+        /*-------.
+        | Stacks |
+        `-------*/
+
+        void
+        Backend::stack_pool_capacity(std::size_t capacity)
+        {
+          std::vector<void*> released;
+          {
+            std::unique_lock<std::mutex> lock(this->_stack_pool_mutex);
+            this->_stack_pool_capacity = capacity;
+            while (this->_stack_pool.size() > capacity)
+            {
+              released.push_back(this->_stack_pool.back());
+              this->_stack_pool.pop_back();
+            }
+          }
+          for (auto stack: released)
+            stack_allocator.deallocate(stack,
+                                       StackAllocator::default_stack_size());
+        }
+
+        void*
+        Backend::_stack_allocate()
+        {
+          {
+            std::unique_lock<std::mutex> lock(this->_stack_pool_mutex);
+            if (!this->_stack_pool.empty())
+            {
+              auto res = this->_stack_pool.back();
+              this->_stack_pool.pop_back();
+              ++this->_stack_pool_hits;
+              return res;
+            }
+            ++this->_stack_pool_misses;
+          }
+          return stack_allocator.allocate(StackAllocator::default_stack_size());
+        }
+
+        void
+        Backend::_stack_release(void* stack)
+        {
+          {
+            std::unique_lock<std::mutex> lock(this->_stack_pool_mutex);
+            if (this->_stack_pool.size() < this->_stack_pool_capacity)
+            {
+              this->_stack_pool.push_back(stack);
+              return;
+            }
+          }
+          stack_allocator.deallocate(stack,
+                                     StackAllocator::default_stack_size());
+        }
 
         std::unique_ptr<backend::Thread>
         Backend::make_thread(const std::string& name, Action action)
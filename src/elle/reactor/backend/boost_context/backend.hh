@@ -1,7 +1,10 @@
 #pragma once
 
+#include <mutex>
 #include <string>
+#include <vector>
 
+#include <elle/attribute.hh>
 #include <elle/reactor/backend/backend.hh>
 
 namespace elle
@@ -40,6 +43,32 @@ namespace elle
           backend::Thread*
           current() const override;
 
+        /*-------.
+        | Stacks |
+        `-------*/
+        public:
+          /// Set the maximum number of released stacks kept for reuse.
+          ///
+          /// Pooled stacks stay mapped, trading memory for cheaper Thread
+          /// creation. Zero disables pooling.
+          void
+          stack_pool_capacity(std::size_t capacity);
+          /// Maximum number of released stacks kept for reuse, from
+          /// ELLE_REACTOR_STACK_POOL, 64 by default.
+          ELLE_ATTRIBUTE_R(std::size_t, stack_pool_capacity);
+          /// Number of stacks served from the pool.
+          ELLE_ATTRIBUTE_R(std::size_t, stack_pool_hits);
+          /// Number of stacks that had to be mapped.
+          ELLE_ATTRIBUTE_R(std::size_t, stack_pool_misses);
+        private:
+          void*
+          _stack_allocate();
+          void
+          _stack_release(void* stack);
+          /// Threads may be created from other system threads (mt_run).
+          ELLE_ATTRIBUTE(std::mutex, stack_pool_mutex);
+          ELLE_ATTRIBUTE(std::vector<void*>, stack_pool);
+
         /*--------.
         | Details |
         `--------*/
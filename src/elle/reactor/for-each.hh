@@ -1,5 +1,7 @@
 #pragma once
 
+# include <vector>
+
 # include <elle/Exception.hh>
 # include <elle/With.hh>
 # include <elle/compiler.hh>
@@ -35,6 +37,42 @@ namespace elle
     void
     for_each_parallel(C& c, F const& f, std::string const& name = std::string{});
 
+    /// Apply a given function to every item of a given container in parallel,
+    /// and return as soon as enough calls succeeded.
+    ///
+    /// The function returns whether its call counts toward the quorum. This
+    /// returns once \a quorum calls counted, or once so many failed that the
+    /// quorum can no longer be reached. Calling break_parallel stops waiting
+    /// right away, and an exception escaping the function is rethrown.
+    ///
+    /// Calls still running then are terminated, unless \a stragglers is
+    /// given, in which case they keep running in threads appended to it. The
+    /// container is copied so stragglers can still refer to its items, but
+    /// their function must not refer to the caller's stack.
+    ///
+    /// \code{.cc}
+    ///
+    /// // Consider five replicas, one of them slow.
+    ///
+    /// auto stored = elle::reactor::for_each_quorum(
+    ///   replicas, 3,
+    ///   [&] (Replica* r)
+    ///   {
+    ///     return r->store(block);
+    ///   });
+    /// // Returns as soon as three of them stored the block.
+    ///
+    /// \endcode
+    ///
+    /// @returns The number of calls that counted toward the quorum.
+    template <typename C, typename F>
+    int
+    for_each_quorum(C c,
+                    int quorum,
+                    F const& f,
+                    std::string const& name = std::string{},
+                    std::vector<Thread::unique_ptr>* stragglers = nullptr);
+
     /// Break exception used to break for_each_parallel execution.
     class Break
       : public elle::Exception
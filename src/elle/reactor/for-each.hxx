@@ -1,6 +1,11 @@
 #pragma once
 
+# include <algorithm>
+# include <memory>
+
+# include <elle/reactor/Barrier.hh>
 # include <elle/reactor/Scope.hh>
+# include <elle/reactor/exception.hh>
 # include <elle/reactor/scheduler.hh>
 
 namespace elle
@@ -39,6 +44,99 @@ namespace elle
       };
     }
 
+    namespace _details
+    {
+      /// State of a for_each_quorum, shared with its stragglers.
+      template <typename C, typename F>
+      struct Quorum
+      {
+        Quorum(C items, F const& f, int quorum)
+          : items(std::move(items))
+          , f(f)
+          , quorum(quorum)
+          , left(0)
+          , reached(0)
+          , error()
+          , done()
+        {}
+
+        C items;
+        F f;
+        int quorum;
+        /// Calls still running.
+        int left;
+        /// Calls that counted.
+        int reached;
+        std::exception_ptr error;
+        reactor::Barrier done;
+      };
+    }
+
+    template <typename C, typename F>
+    int
+    for_each_quorum(C c,
+                    int quorum,
+                    F const& f,
+                    std::string const& name,
+                    std::vector<Thread::unique_ptr>* stragglers)
+    {
+      using State = _details::Quorum<C, F>;
+      auto state = std::make_shared<State>(std::move(c), f, quorum);
+      auto threads = std::vector<Thread::unique_ptr>{};
+      for (auto& elt: state->items)
+      {
+        ++state->left;
+        threads.emplace_back(new Thread(
+          elle::sprintf("%s: %s: %s",
+                        reactor::scheduler().current()->name(),
+                        name.empty() ? "for-each" : name,
+                        elt),
+          [state, &elt]
+          {
+            try
+            {
+              if (state->f(elt))
+                ++state->reached;
+            }
+            catch (Terminate const&)
+            {
+              throw;
+            }
+            catch (Break const&)
+            {
+              state->done.open();
+            }
+            catch (...)
+            {
+              if (!state->error)
+                state->error = std::current_exception();
+              state->done.open();
+            }
+            --state->left;
+            if (state->reached >= state->quorum ||
+                state->reached + state->left < state->quorum)
+              state->done.open();
+          }));
+      }
+      if (state->reached + state->left < state->quorum)
+        state->done.open();
+      reactor::wait(state->done);
+      if (stragglers)
+      {
+        stragglers->erase(
+          std::remove_if(stragglers->begin(), stragglers->end(),
+                         [] (Thread::unique_ptr const& t) { return t->done(); }),
+          stragglers->end());
+        for (auto& t: threads)
+          if (!t->done())
+            stragglers->emplace_back(std::move(t));
+      }
+      threads.clear();
+      if (state->error)
+        std::rethrow_exception(state->error);
+      return state->reached;
+    }
+
     inline
     void
     break_parallel()
@@ -17,6 +17,7 @@ namespace elle
     class Operation;
     class Scheduler;
     class Semaphore;
+    class ShardedScheduler;
     class Signal;
     class Sleep;
     class Thread;
@@ -152,6 +152,17 @@ namespace elle
         static_cast<StreamBuffer*>(this->rdbuf())->pacified(true);
       }
 
+      /*------.
+      | Write |
+      `------*/
+
+      void
+      Socket::write(std::vector<elle::ConstWeakBuffer> const& buffers)
+      {
+        for (auto const& buffer: buffers)
+          this->write(buffer);
+      }
+
       /*-----.
       | Read |
       `-----*/
@@ -86,6 +86,15 @@ namespace elle
         virtual
         void
         write(elle::ConstWeakBuffer buffer) = 0;
+        /// Write the given buffers to the Socket, in order.
+        ///
+        /// Buffered stream data is not flushed first. By default buffers are
+        /// written one by one, stream sockets gather them in a single write.
+        ///
+        /// @param buffers The payloads to write.
+        virtual
+        void
+        write(std::vector<elle::ConstWeakBuffer> const& buffers);
 
       /*-----.
       | Read |
@@ -342,6 +351,9 @@ namespace elle
         /// @Socket::write.
         void
         write(elle::ConstWeakBuffer buffer) override;
+        /// @Socket::write.
+        void
+        write(std::vector<elle::ConstWeakBuffer> const& buffers) override;
       protected:
         void
         _final_flush();
@@ -515,17 +515,33 @@ namespace elle
               elle::ConstWeakBuffer buffer)
           : Super(Spe::socket(socket))
           , _socket(plain)
-          , _buffer(std::move(buffer))
+          , _buffers{
+            boost::asio::buffer(buffer.contents(), buffer.size())}
           , _written(0)
         {}
 
+        /// Gather the buffers in a single write.
+        Write(PlainSocket& plain,
+              AsioSocket& socket,
+              std::vector<elle::ConstWeakBuffer> const& buffers)
+          : Super(Spe::socket(socket))
+          , _socket(plain)
+          , _buffers()
+          , _written(0)
+        {
+          this->_buffers.reserve(buffers.size());
+          for (auto const& b: buffers)
+            this->_buffers.emplace_back(
+              boost::asio::buffer(b.contents(), b.size()));
+        }
+
       protected:
         void
         _start() override
         {
           boost::asio::async_write(
             *this->_socket.socket(),
-            boost::asio::buffer(this->_buffer.contents(), this->_buffer.size()),
+            this->_buffers,
             [this](const boost::system::error_code& error,
                    std::size_t written)
             {
@@ -548,7 +564,7 @@ namespace elle
         }
 
         ELLE_ATTRIBUTE(PlainSocket const&, socket);
-        ELLE_ATTRIBUTE(elle::ConstWeakBuffer, buffer);
+        ELLE_ATTRIBUTE(std::vector<boost::asio::const_buffer>, buffers);
         ELLE_ATTRIBUTE_R(Size, written);
       };
 
@@ -574,6 +590,33 @@ namespace elle
         }
       }
 
+      template <typename AsioSocket, typename EndPoint>
+      void
+      StreamSocket<AsioSocket, EndPoint>::write(
+        std::vector<elle::ConstWeakBuffer> const& buffers)
+      {
+        ELLE_LOG_COMPONENT("elle.reactor.network.Socket");
+        if (reactor::scheduler().current())
+        {
+          {
+            Lock lock(this->_write_mutex);
+            ELLE_TRACE_SCOPE("%s: write %s buffers", this, buffers.size());
+            Write<Self, AsioSocket> write(*this, *this->socket(), buffers);
+            write.run();
+          }
+          this->_async_write();
+        }
+        else
+        {
+          // The buffers must outlive the asynchronous write, copy them.
+          auto buffer = elle::Buffer{};
+          for (auto const& b: buffers)
+            buffer.append(b.contents(), b.size());
+          this->_async_writes.emplace_back(std::move(buffer));
+          this->_async_write();
+        }
+      }
+
       template <typename AsioSocket, typename EndPoint>
       void
       StreamSocket<AsioSocket, EndPoint>::_async_write()
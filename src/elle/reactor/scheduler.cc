@@ -4,7 +4,6 @@
 #include <elle/attribute.hh>
 #include <elle/finally.hh>
 #include <elle/log.hh>
-#include <elle/make-vector.hh>
 #include <elle/memory.hh>
 #include <elle/os/environ.hh>
 #include <elle/reactor/BackgroundOperation.hh>
@@ -175,20 +174,20 @@ namespace elle
       if (!this->_frozen.empty())
       {
         std::cerr << "== FROZEN THREADS ==" << std::endl;
-        for (auto thread: this->_frozen)
-          print_thread(*thread);
+        for (auto& thread: this->_frozen)
+          print_thread(thread);
       }
       if (!this->_running.empty())
       {
         std::cerr << "== RUNNING THREADS ==" << std::endl;
-        for (auto thread: this->_running)
-          print_thread(*thread);
+        for (auto& thread: this->_running)
+          print_thread(thread);
       }
       if (!this->_starting.empty())
       {
         std::cerr << "== STARTING THREADS ==" << std::endl;
-        for (auto thread: this->_starting)
-          print_thread(*thread);
+        for (auto& thread: this->_starting)
+          print_thread(thread);
       }
     }
 
@@ -256,48 +255,66 @@ namespace elle
       // Could avoid locking if no jobs are pending with a boolean.
       {
         std::unique_lock<std::mutex> lock(this->_starting_mtx);
-        auto& ordered = this->_starting.get<1>();
-        this->_running.insert(ordered.begin(), ordered.end());
-        this->_starting.clear();
+        for (auto& t: this->_starting)
+          t._scheduler_queue = Thread::Queue::running;
+        this->_running.splice(this->_running.end(), this->_starting);
       }
-      auto& ordered = this->_running.get<1>();
-      auto running = make_vector(ordered);
-      ELLE_TRACE_SCOPE("Scheduler: new round with %s jobs", running.size());
+      auto const count = this->_running.size();
+      ELLE_TRACE_SCOPE("Scheduler: new round with %s jobs", count);
 
-      ELLE_DUMP("%s: starting: %s", *this, this->_starting);
-      ELLE_DUMP("%s: running: %s", *this, this->_running);
-      ELLE_DUMP("%s: frozen: %s", *this, this->_frozen);
+      ELLE_DUMP("%s: starting: %s", *this, this->_starting.size());
+      ELLE_DUMP("%s: running: %s", *this, this->_running.size());
+      ELLE_DUMP("%s: frozen: %s", *this, this->_frozen.size());
       ELLE_MEASURE("Scheduler round")
-        for (Thread* t: running)
-        {
-          // If the thread was stopped during this round, skip. Can be caused by
-          // terminate_now, for instance.
-          if (this->_running.find(t) == this->_running.end())
-            continue;
-          ELLE_TRACE("Scheduler: schedule %s", *t);
-          this->_step(t);
-        }
-      ELLE_TRACE("%s: run asynchronous jobs", *this)
       {
-        ELLE_MEASURE_SCOPE("Asio callbacks");
-        try
+        // Only the stepped thread can leave the running queue while it runs,
+        // and threads woken during this round are appended after the ones
+        // that were there when it started: advance before stepping and stop
+        // after as many threads as the round started with.
+        auto it = this->_running.begin();
+        for (std::size_t i = 0; i < count && it != this->_running.end(); ++i)
         {
-          this->_io_service.reset();
-          auto n = this->_io_service.poll();
-          ELLE_DEBUG("%s: %s callback called", *this, n);
+          auto& t = *it++;
+          ELLE_TRACE("Scheduler: schedule %s", t);
+          this->_step(&t);
         }
-        catch (std::exception const& e)
+      }
+      auto asio = [this] (std::function<void ()> const& run)
         {
-          ELLE_WARN("%s: asynchronous job threw an exception: %s",
-                    *this, e.what());
-          this->_eptr = std::current_exception();
-          this->terminate();
-        }
-        catch (...)
+          try
+          {
+            run();
+          }
+          catch (std::exception const& e)
+          {
+            ELLE_WARN("%s: asynchronous job threw an exception: %s",
+                      *this, e.what());
+            this->_eptr = std::current_exception();
+            this->terminate();
+          }
+          catch (...)
+          {
+            ELLE_WARN("%s: asynchronous jobs threw an unknown exception",
+                      *this);
+            this->_eptr = std::current_exception();
+            this->terminate();
+          }
+        };
+      bool const idle = this->_running.empty() && this->_starting.empty();
+      // With nothing runnable but frozen threads, go straight to blocking on
+      // asio for the next ready handler instead of polling first.
+      if (!idle || this->_frozen.empty())
+      {
+        ELLE_TRACE("%s: run asynchronous jobs", *this)
         {
-          ELLE_WARN("%s: asynchronous jobs threw an unknown exception", *this);
-          this->_eptr = std::current_exception();
-          this->terminate();
+          ELLE_MEASURE_SCOPE("Asio callbacks");
+          asio(
+            [this]
+            {
+              this->_io_service.reset();
+              auto n = this->_io_service.poll();
+              ELLE_DEBUG("%s: %s callback called", *this, n);
+            });
         }
       }
       if (this->_running.empty() && this->_starting.empty())
@@ -312,20 +329,24 @@ namespace elle
           {
             ELLE_TRACE_SCOPE("%s: nothing to do, "
                        "polling asio in a blocking fashion", *this);
-            this->_io_service.reset();
-            boost::system::error_code err;
-            std::size_t run = this->_io_service.run_one(err);
-            ELLE_DEBUG("%s: %s callback called", *this, run);
-            if (err)
-            {
-              std::cerr << "fatal ASIO error: " << err << std::endl;
-              std::abort();
-            }
-            else if (run == 0)
-            {
-              std::cerr << "ASIO service is dead." << std::endl;
-              std::abort();
-            }
+            asio(
+              [this]
+              {
+                this->_io_service.reset();
+                boost::system::error_code err;
+                std::size_t run = this->_io_service.run_one(err);
+                ELLE_DEBUG("%s: %s callback called", *this, run);
+                if (err)
+                {
+                  std::cerr << "fatal ASIO error: " << err << std::endl;
+                  std::abort();
+                }
+                else if (run == 0)
+                {
+                  std::cerr << "ASIO service is dead." << std::endl;
+                  std::abort();
+                }
+              });
             if (this->_shallstop)
               break;
           }
@@ -362,7 +383,8 @@ namespace elle
       if (thread->state() == Thread::State::done)
       {
         ELLE_TRACE("%s: %s finished", *this, *thread);
-        this->_running.erase(thread);
+        this->_running.erase(this->_running.iterator_to(*thread));
+        thread->_scheduler_queue = Thread::Queue::none;
         thread->_scheduler_release();
       }
     }
@@ -381,9 +403,10 @@ namespace elle
     Scheduler::_freeze(Thread& thread)
     {
       ELLE_ASSERT_EQ(thread.state(), Thread::State::running);
-      ELLE_ASSERT_NEQ(this->_running.find(&thread), this->_running.end());
-      this->_running.erase(&thread);
-      this->_frozen.insert(&thread);
+      ELLE_ASSERT(thread._scheduler_queue == Thread::Queue::running);
+      this->_running.erase(this->_running.iterator_to(thread));
+      this->_frozen.push_back(thread);
+      thread._scheduler_queue = Thread::Queue::frozen;
       thread.frozen()();
     }
 
@@ -400,7 +423,8 @@ namespace elle
       // FIXME: be thread safe only if needed
       {
         std::unique_lock<std::mutex> lock(this->_starting_mtx);
-        this->_starting.insert(&thread);
+        this->_starting.push_back(thread);
+        thread._scheduler_queue = Thread::Queue::starting;
         // Wake the scheduler.
         this->_io_service.post(nothing);
       }
@@ -410,11 +434,14 @@ namespace elle
     Scheduler::_unfreeze(Thread& thread, std::string const& reason)
     {
       ELLE_ASSERT_EQ(thread.state(), Thread::State::frozen);
-      this->_frozen.erase(&thread);
-      this->_running.insert(&thread);
+      ELLE_ASSERT(thread._scheduler_queue == Thread::Queue::frozen);
+      this->_frozen.erase(this->_frozen.iterator_to(thread));
+      this->_running.push_back(thread);
+      thread._scheduler_queue = Thread::Queue::running;
       thread.unfrozen()(reason);
-      if (this->_running.size() == 1)
-        this->_io_service.post(nothing);
+      // No need to wake the scheduler: threads are only ever woken from the
+      // scheduler system thread, either by another thread or by an asio
+      // handler after which poll/run_one return.
     }
 
     void
@@ -424,30 +451,34 @@ namespace elle
       this->io_service().post([&] {});
     }
 
-    Scheduler::Threads
+    std::vector<Thread*>
     Scheduler::terminate()
     {
       ELLE_TRACE_SCOPE("%s: terminate", *this);
-      Threads terminated;
-      for(Thread* t: this->_starting)
+      std::vector<Thread*> terminated;
+      Threads starting;
       {
-        // Threads expect to be done when deleted. For this very
-        // particuliar case, hack the state before deletion.
-        t->_state = Thread::State::done;
-        t->_scheduler_release();
+        std::unique_lock<std::mutex> lock(this->_starting_mtx);
+        starting.swap(this->_starting);
       }
-      this->_starting.clear();
-      for(Thread* t: Threads(this->_running))
-        if (t != this->_current)
-        {
-          t->terminate();
-          terminated.insert(t);
-        }
-      for(Thread* t: Threads(this->_frozen))
+      while (!starting.empty())
       {
+        auto& t = starting.front();
+        starting.pop_front();
+        t._scheduler_queue = Thread::Queue::none;
+        // Threads expect to be done when deleted. For this very
+        // particuliar case, hack the state before deletion.
+        t._state = Thread::State::done;
+        t._scheduler_release();
+      }
+      // Terminating threads moves them between queues, work on a copy.
+      for (auto& t: this->_running)
+        if (&t != this->_current)
+          terminated.push_back(&t);
+      for (auto& t: this->_frozen)
+        terminated.push_back(&t);
+      for (auto t: terminated)
         t->terminate();
-        terminated.insert(t);
-      }
       return terminated;
     }
 
@@ -470,7 +501,17 @@ namespace elle
         throw Terminate(thread->name());
       }
       // If the underlying coroutine was never run, nothing to do.
-      if (this->_starting.erase(thread))
+      bool starting = false;
+      {
+        std::unique_lock<std::mutex> lock(this->_starting_mtx);
+        if (thread->_scheduler_queue == Thread::Queue::starting)
+        {
+          this->_starting.erase(this->_starting.iterator_to(*thread));
+          thread->_scheduler_queue = Thread::Queue::none;
+          starting = true;
+        }
+      }
+      if (starting)
       {
         ELLE_DEBUG("thread was starting, discard it");
         thread->_state = Thread::State::done;
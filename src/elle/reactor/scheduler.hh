@@ -4,10 +4,7 @@
 #include <mutex>
 #include <thread>
 
-#include <boost/multi_index_container.hpp>
-#include <boost/multi_index/hashed_index.hpp>
-#include <boost/multi_index/identity.hpp>
-#include <boost/multi_index/sequenced_index.hpp>
+#include <boost/intrusive/list.hpp>
 #ifdef INFINIT_WINDOWS
 # include <winsock2.h>
 #endif
@@ -17,6 +14,7 @@
 #include <elle/Printable.hh>
 #include <elle/attribute.hh>
 #include <elle/reactor/asio.hh>
+#include <elle/reactor/Thread.hh>
 #include <elle/reactor/duration.hh>
 #include <elle/reactor/fwd.hh>
 #include <elle/reactor/backend/fwd.hh>
@@ -126,13 +124,17 @@ namespace elle
     | Threads management |
     `-------------------*/
     public:
-      using Threads = boost::multi_index::multi_index_container<
-      Thread*,
-      boost::multi_index::indexed_by<
-        boost::multi_index::hashed_unique<boost::multi_index::identity<Thread*>>,
-        boost::multi_index::sequenced<>
-        >
-      >;
+      /// Intrusive queue of Threads, linked through Thread::_scheduler_hook.
+      ///
+      /// A Thread is in at most one queue at a time, so moving it between the
+      /// starting, running and frozen queues is a constant-time relink that
+      /// never allocates.
+      using Threads = boost::intrusive::list<
+        Thread,
+        boost::intrusive::member_hook<
+          Thread,
+          boost::intrusive::list_member_hook<>,
+          &Thread::_scheduler_hook>>;
       /// Return a pointer to the current Thread.
       ///
       /// \pre Being called from a Thread managed by a scheduler.
@@ -142,7 +144,7 @@ namespace elle
       current() const;
       /// Mark for termination all running Threads and return the list of
       /// affected Threads.
-      Threads
+      std::vector<Thread*>
       terminate();
       /// Terminate all running Threads and wait until they exit.
       void
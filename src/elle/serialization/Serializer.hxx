@@ -1538,7 +1538,7 @@ namespace elle
     std::unordered_map<elle::TypeInfo, elle::Version>
     get_serialization_versions(elle::Version const& version)
     {
-      auto versions = ST::dependencies.at(version);
+      auto versions = _details::dependencies<ST>(version, 42);
       versions.emplace(elle::type_info<ST>(), version);
       return versions;
     }
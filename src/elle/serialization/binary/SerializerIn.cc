@@ -1,5 +1,10 @@
 #include <elle/serialization/binary/SerializerIn.hh>
 
+#include <algorithm>
+#include <cstring>
+
+#include <elle/assert.hh>
+#include <elle/serialization/binary/number.hh>
 #include <elle/serialization/json/Error.hh>
 
 ELLE_LOG_COMPONENT("elle.serialization.binary.SerializerIn")
@@ -13,26 +18,57 @@ namespace elle
       SerializerIn::SerializerIn(std::istream& input,
                                  bool versioned)
         : Super(versioned)
-        , _input(input)
+        , _input(&input)
+        , _cursor(nullptr)
+        , _end(nullptr)
       {
-        this->_check_magic(input);
+        this->_check_magic();
       }
 
       SerializerIn::SerializerIn(std::istream& input,
                                  Versions versions,
                                  bool versioned)
         : Super(std::move(versions), versioned)
-        , _input(input)
+        , _input(&input)
+        , _cursor(nullptr)
+        , _end(nullptr)
+      {
+        this->_check_magic();
+      }
+
+      SerializerIn::SerializerIn(elle::ConstWeakBuffer input,
+                                 bool versioned)
+        : Super(versioned)
+        , _input(nullptr)
+        , _cursor(input.contents())
+        , _end(input.contents() + input.size())
+      {
+        this->_check_magic();
+      }
+
+      SerializerIn::SerializerIn(elle::ConstWeakBuffer input,
+                                 Versions versions,
+                                 bool versioned)
+        : Super(std::move(versions), versioned)
+        , _input(nullptr)
+        , _cursor(input.contents())
+        , _end(input.contents() + input.size())
+      {
+        this->_check_magic();
+      }
+
+      std::istream&
+      SerializerIn::input() const
       {
-        this->_check_magic(input);
+        ELLE_ASSERT(this->_input);
+        return *this->_input;
       }
 
       void
-      SerializerIn::_check_magic(std::istream& input)
+      SerializerIn::_check_magic()
       {
         char magic;
-        input.read(&magic, 1);
-        if (input.gcount() != 1)
+        if (this->_read(&magic, 1) != 1)
           err<Error>("unable to read magic");
         if (magic != 0)
           err<Error>("wrong magic for binary serialization: 0x%2x",
@@ -114,7 +150,9 @@ namespace elle
       void
       SerializerIn::_serialize(double& v)
       {
-        input().read((char*)(void*)&v, sizeof(double));
+        if (this->_read(&v, sizeof(double)) != sizeof(double))
+          err<Error>("%s: short read when deserializing \"%s\"",
+                     *this, this->current_name());
       }
 
       void
@@ -148,9 +186,26 @@ namespace elle
       void
       SerializerIn::_serialize(std::string& v)
       {
-        elle::Buffer b;
-        this->_serialize(b);
-        v = b.string();
+        this->_serialize_string(this->_serialize_number(), v);
+      }
+
+      void
+      SerializerIn::_serialize_string(int64_t sz, std::string& v)
+      {
+        if (sz < 0)
+          err<Error>("%s: invalid size when deserializing \"%s\": %s",
+                     *this, this->current_name(), sz);
+        if (!this->_input && this->_end - this->_cursor < sz)
+          err<Error>("%s: short read when deserializing \"%s\":"
+                     " expected %s, got %s",
+                     *this, this->current_name(), sz,
+                     this->_end - this->_cursor);
+        v.resize(sz);
+        auto const read = this->_read(&v[0], sz);
+        if (signed(read) != sz)
+          err<Error>("%s: short read when deserializing \"%s\":"
+                     " expected %s, got %s",
+                     *this, this->current_name(), sz, read);
       }
 
       void
@@ -158,19 +213,52 @@ namespace elle
       {
         int sz = _serialize_number();
         ELLE_DEBUG("%s: deserialize size: %s", *this, sz);
+        if (sz < 0)
+          err<Error>("%s: invalid size when deserializing \"%s\": %s",
+                     *this, this->current_name(), sz);
+        if (!this->_input && this->_end - this->_cursor < sz)
+          err<Error>("%s: short read when deserializing \"%s\":"
+                     " expected %s, got %s",
+                     *this, this->current_name(), sz,
+                     this->_end - this->_cursor);
         buffer.size(sz);
-        input().read((char*)buffer.mutable_contents(), sz);
-        if (input().gcount() != sz)
+        auto const read = this->_read(buffer.mutable_contents(), sz);
+        if (signed(read) != sz)
           err<Error>("%s: short read when deserializing \"%s\":"
                      " expected %s, got %s",
-                     *this, this->current_name(), sz, input().gcount());
+                     *this, this->current_name(), sz, read);
       }
 
       void
       SerializerIn::_serialize(boost::posix_time::ptime& time)
       {
+        auto const tag = this->_serialize_number();
+        switch (TimeTag(tag))
+        {
+          case TimeTag::time:
+          {
+            static auto const epoch =
+              boost::posix_time::ptime(boost::gregorian::date(1970, 1, 1));
+            time = epoch +
+              boost::posix_time::microseconds(this->_serialize_number());
+            return;
+          }
+          case TimeTag::not_a_date_time:
+            time = boost::posix_time::not_a_date_time;
+            return;
+          case TimeTag::pos_infin:
+            time = boost::posix_time::pos_infin;
+            return;
+          case TimeTag::neg_infin:
+            time = boost::posix_time::neg_infin;
+            return;
+        }
+        if (tag < 0)
+          err<Error>("%s: invalid date tag when deserializing \"%s\": %s",
+                     *this, this->current_name(), tag);
+        // Before times were written natively, they were ISO 8601 strings.
         std::string str;
-        this->_serialize(str);
+        this->_serialize_string(tag, str);
         // Use the ISO extended input facet to interpret the string.
         std::stringstream ss(str);
         auto input_facet =
@@ -276,9 +364,31 @@ namespace elle
       int64_t
       SerializerIn::_serialize_number()
       {
-        int64_t res;
-        SerializerIn::serialize_number(this->input(), res);
-        return res;
+        if (this->_input)
+        {
+          int64_t res;
+          SerializerIn::serialize_number(*this->_input, res);
+          return res;
+        }
+        else
+          return read_number(this->_cursor, this->_end);
+      }
+
+      std::size_t
+      SerializerIn::_read(void* data, std::size_t size)
+      {
+        if (this->_input)
+        {
+          this->_input->read(static_cast<char*>(data), size);
+          return this->_input->gcount();
+        }
+        else
+        {
+          size = std::min<std::size_t>(size, this->_end - this->_cursor);
+          std::memcpy(data, this->_cursor, size);
+          this->_cursor += size;
+          return size;
+        }
       }
 
       size_t
@@ -14,9 +14,8 @@ namespace elle
     {
       /// A specialized SerializerIn for binary.
       ///
-      /// Deserialize objects from their binary representations.
-      ///
-      ///
+      /// Deserialize objects from their binary representations, read from a
+      /// stream or straight from memory.
       class ELLE_API SerializerIn
         : public serialization::SerializerIn
       {
@@ -34,9 +33,21 @@ namespace elle
         SerializerIn(std::istream& input, bool versioned = true);
         SerializerIn(std::istream& input,
                      Versions versions, bool versioned = true);
+        /// Construct a SerializerIn reading from memory.
+        ///
+        /// The input must outlive the SerializerIn. Reads check the bounds
+        /// once per value instead of going through a streambuf per byte.
+        SerializerIn(elle::ConstWeakBuffer input, bool versioned = true);
+        SerializerIn(elle::ConstWeakBuffer input,
+                     Versions versions, bool versioned = true);
+        /// The input stream.
+        ///
+        /// @pre Not reading from memory.
+        std::istream&
+        input() const;
       private:
         void
-        _check_magic(std::istream& input);
+        _check_magic();
 
       /*--------------.
       | Serialization |
@@ -97,12 +108,22 @@ namespace elle
         size_t
         serialize_number(std::istream& output,
                          int64_t& value);
-        ELLE_ATTRIBUTE_R(std::istream&, input);
       private:
         int64_t _serialize_number();
+        /// Read a string whose size was already read.
+        void
+        _serialize_string(int64_t size, std::string& v);
         template <typename T>
         void
         _serialize_int(T& v);
+        /// Read up to size bytes, return how many were read.
+        std::size_t
+        _read(void* data, std::size_t size);
+        /// The input stream, if not reading from memory.
+        ELLE_ATTRIBUTE(std::istream*, input);
+        /// The unread memory, if not reading from a stream.
+        ELLE_ATTRIBUTE(elle::Buffer::Byte const*, cursor);
+        ELLE_ATTRIBUTE(elle::Buffer::Byte const*, end);
     };
   }
 }
@@ -4,6 +4,8 @@
 #include <elle/finally.hh>
 #include <elle/format/base64.hh>
 #include <elle/json/json.hh>
+#include <elle/serialization.hh>
+#include <elle/serialization/binary/number.hh>
 
 ELLE_LOG_COMPONENT("elle.serialization.binary.SerializerOut")
 
@@ -19,25 +21,52 @@ namespace elle
 
       SerializerOut::SerializerOut(std::ostream& output, bool versioned)
         : Super(versioned)
-        , _output(output)
+        , _output(&output)
+        , _buffer(nullptr)
       {
-        this->_write_magic(output);
+        this->_write_magic();
       }
 
       SerializerOut::SerializerOut(std::ostream& output,
                                    Versions versions,
                                    bool versioned)
         : Super(std::move(versions), versioned)
-        , _output(output)
+        , _output(&output)
+        , _buffer(nullptr)
       {
-        this->_write_magic(output);
+        this->_write_magic();
+      }
+
+      SerializerOut::SerializerOut(elle::Buffer& output, bool versioned)
+        : Super(versioned)
+        , _output(nullptr)
+        , _buffer(&output)
+      {
+        this->_write_magic();
+      }
+
+      SerializerOut::SerializerOut(elle::Buffer& output,
+                                   Versions versions,
+                                   bool versioned)
+        : Super(std::move(versions), versioned)
+        , _output(nullptr)
+        , _buffer(&output)
+      {
+        this->_write_magic();
+      }
+
+      std::ostream&
+      SerializerOut::output() const
+      {
+        ELLE_ASSERT(this->_output);
+        return *this->_output;
       }
 
       void
-      SerializerOut::_write_magic(std::ostream& output)
+      SerializerOut::_write_magic()
       {
         static char const magic = 0;
-        output.write(&magic, 1);
+        this->_write(&magic, 1);
       }
 
       SerializerOut::~SerializerOut()
@@ -60,60 +89,38 @@ namespace elle
       }
 
       void
-      SerializerOut::_serialize_number(int64_t n_)
+      SerializerOut::_serialize_number(int64_t n)
+      {
+        if (this->_buffer)
+        {
+          auto& b = *this->_buffer;
+          auto const size = b.size();
+          b.size(size + number_max_size);
+          b.size(write_number(b.mutable_contents() + size, n) -
+                 b.mutable_contents());
+        }
+        else
+          SerializerOut::serialize_number(*this->_output, n);
+      }
+
+      void
+      SerializerOut::_write(void const* data, std::size_t size)
       {
-        SerializerOut::serialize_number(this->output(), n_);
+        if (this->_buffer)
+          this->_buffer->append(data, size);
+        else
+          this->_output->write(static_cast<char const*>(data), size);
       }
 
       size_t
       SerializerOut::serialize_number(std::ostream& output,
-                                      int64_t n_)
-      {
-        int64_t n = n_;
-        bool neg = n < 0;
-        if (neg)
-          n = -n;
-        if (n <= 0x3f)
-        { // sgn 0 val
-          unsigned char ser = (neg ? 0x80 : 0) + n;
-          ELLE_DUMP("serialize %s as 0x%02x", n_, int(ser));
-          output.write((const char*)&ser, 1);
-          return 1;
-        }
-        else if (n <= 0x1fff)
-        { // sgn 1 0 val val2
-          unsigned char ser[2];
-          ser[0] = (neg ? 0xC0 : 0x40) + (n >> 8);
-          ser[1] = n;
-          ELLE_DUMP("serialize %s as 0x%02x%02x", n_, int(ser[0]), int(ser[1]));
-          output.write((const char*)ser, 2);
-          return 2;
-        } // sgn 1 1 0 val val2 val3
-        else if (n <= 0x0fffff)
-        {
-          unsigned char ser[3];
-          ser[0] = (neg ? 0xe0 : 0x60) + (n >> 16);
-          ser[1] = n >> 8;
-          ser[2] = n;
-          ELLE_DUMP("serialize %s as 0x%02x%02x%02x",
-                    n_, int(ser[0]), int(ser[1]), int(ser[2]));
-          output.write((const char*)ser, 3);
-          return 3;
-        }
-        else
-        {
-          unsigned char c = neg? 0xFF : 0x7F;
-          output.write((const char*)&c, 1);
-          output.write((const char*)(const void*)&n, 8);
-          ELLE_DUMP("serialize %s as 0x%02x%08x", n_, int(c), n);
-          return 9;
-          /*
-          unsigned char ser[9];
-          ser[0] = neg? 0xFF : 0x7F;
-          for (int i=1; i<9; ++i)
-            ser[i] = n >> ((i-1)*8);
-          output.write((const char*)ser, 9);*/
-        }
+                                      int64_t n)
+      {
+        elle::Buffer::Byte ser[number_max_size];
+        auto const size = write_number(ser, n) - ser;
+        ELLE_DUMP("serialize %s as %x", n, elle::ConstWeakBuffer(ser, size));
+        output.write(reinterpret_cast<char const*>(ser), size);
+        return size;
       }
 
       void
@@ -183,7 +190,7 @@ namespace elle
       void
       SerializerOut::_serialize(double& v)
       {
-        output().write((const char*)&v, sizeof(double));
+        this->_write(&v, sizeof(double));
       }
 
       void
@@ -195,8 +202,8 @@ namespace elle
       void
       SerializerOut::_serialize(std::string& v)
       {
-        elle::Buffer buffer(v.c_str(), v.size());
-        this->_serialize(buffer);
+        this->_serialize_number(v.size());
+        this->_write(v.data(), v.size());
       }
 
       void
@@ -205,20 +212,53 @@ namespace elle
         ELLE_DEBUG("serialize size: %s", buffer.size())
           this->_serialize_number(buffer.size());
         ELLE_DEBUG("serialize content: %f", buffer)
-          output().write((const char*)buffer.contents(), buffer.size());
+          this->_write(buffer.contents(), buffer.size());
       }
 
       void
       SerializerOut::_serialize(boost::posix_time::ptime& time)
       {
-        std::stringstream ss;
-        auto output_facet = std::make_unique<boost::posix_time::time_facet>();
-        // ISO 8601
-        output_facet->format("%Y-%m-%dT%H:%M:%S%F%q");
-        ss.imbue(std::locale(ss.getloc(), output_facet.release()));
-        ss << time;
-        std::string s(ss.str());
-        this->_serialize(s);
+        if (!this->_native_times())
+        {
+          std::stringstream ss;
+          auto output_facet =
+            std::make_unique<boost::posix_time::time_facet>();
+          // ISO 8601
+          output_facet->format("%Y-%m-%dT%H:%M:%S%F%q");
+          ss.imbue(std::locale(ss.getloc(), output_facet.release()));
+          ss << time;
+          auto s = ss.str();
+          this->_serialize(s);
+        }
+        else if (time.is_not_a_date_time())
+          this->_serialize_number(int64_t(TimeTag::not_a_date_time));
+        else if (time.is_pos_infinity())
+          this->_serialize_number(int64_t(TimeTag::pos_infin));
+        else if (time.is_neg_infinity())
+          this->_serialize_number(int64_t(TimeTag::neg_infin));
+        else
+        {
+          static auto const epoch =
+            boost::posix_time::ptime(boost::gregorian::date(1970, 1, 1));
+          this->_serialize_number(int64_t(TimeTag::time));
+          this->_serialize_number((time - epoch).total_microseconds());
+        }
+      }
+
+      bool
+      SerializerOut::_native_times() const
+      {
+        // Only releases at least as recent as this one are known to read
+        // native times. Older or unknown targets get ISO 8601 strings, which
+        // every release reads.
+        if (auto const& versions = this->versions())
+        {
+          auto const it =
+            versions->find(elle::type_info<elle::serialization_tag>());
+          if (it != versions->end())
+            return !(it->second < elle::serialization_tag::version);
+        }
+        return false;
       }
 
       void
@@ -14,7 +14,8 @@ namespace elle
     {
       /// A specialized SerializerOut for binary.
       ///
-      /// Serialize object to their binary representation.
+      /// Serialize object to their binary representation, written to a stream
+      /// or appended to a Buffer.
       ///
       /// Details:
       /// - In binary, order matters. Do not reorder members afterward,
@@ -43,11 +44,23 @@ namespace elle
         /// @see elle::serialization::SerializerOut.
         SerializerOut(std::ostream& output,
                       Versions versions, bool versioned = true);
+        /// Construct a SerializerOut appending to a Buffer.
+        ///
+        /// The output must outlive the SerializerOut. Values are written in
+        /// place, without a streambuf.
+        SerializerOut(elle::Buffer& output, bool versioned = true);
+        SerializerOut(elle::Buffer& output,
+                      Versions versions, bool versioned = true);
         virtual
         ~SerializerOut();
+        /// The output stream.
+        ///
+        /// @pre Not writing to a Buffer.
+        std::ostream&
+        output() const;
       private:
         void
-        _write_magic(std::ostream& output);
+        _write_magic();
 
       /*--------------.
       | Serialization |
@@ -105,10 +118,20 @@ namespace elle
         size_t
         serialize_number(std::ostream& output,
                          int64_t number);
-        ELLE_ATTRIBUTE_R(std::ostream&, output);
       private:
         void
         _serialize_number(int64_t number);
+        /// Whether times are written natively rather than as ISO 8601
+        /// strings: only when targeting an elle::serialization_tag version
+        /// at least elle::serialization_tag::version.
+        bool
+        _native_times() const;
+        void
+        _write(void const* data, std::size_t size);
+        /// The output stream, if not writing to a Buffer.
+        ELLE_ATTRIBUTE(std::ostream*, output);
+        /// The output Buffer, if not writing to a stream.
+        ELLE_ATTRIBUTE(elle::Buffer*, buffer);
       };
     }
   }
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#include <elle/Buffer.hh>
+#include <elle/err.hh>
+#include <elle/serialization/Error.hh>
+
+namespace elle
+{
+  namespace serialization
+  {
+    namespace binary
+    {
+      /// The largest encoding of a number.
+      constexpr std::size_t number_max_size = 9;
+
+      /// Encode a number in the binary serialization format.
+      ///
+      /// Small magnitudes take one to three bytes, the sign being the high
+      /// bit of the first one; others take a marker byte and the eight bytes
+      /// of the magnitude.
+      ///
+      /// @param output Where to write, with room for number_max_size bytes.
+      /// @return The end of the encoding.
+      inline
+      elle::Buffer::Byte*
+      write_number(elle::Buffer::Byte* output, int64_t number)
+      {
+        auto n = number;
+        bool const neg = n < 0;
+        if (neg)
+          n = -n;
+        if (n <= 0x3f)
+        {
+          output[0] = (neg ? 0x80 : 0) + n;
+          return output + 1;
+        }
+        else if (n <= 0x1fff)
+        {
+          output[0] = (neg ? 0xC0 : 0x40) + (n >> 8);
+          output[1] = n;
+          return output + 2;
+        }
+        else if (n <= 0x0fffff)
+        {
+          output[0] = (neg ? 0xe0 : 0x60) + (n >> 16);
+          output[1] = n >> 8;
+          output[2] = n;
+          return output + 3;
+        }
+        else
+        {
+          output[0] = neg ? 0xFF : 0x7F;
+          std::memcpy(output + 1, &n, 8);
+          return output + 9;
+        }
+      }
+
+      /// Decode a number written by write_number.
+      ///
+      /// @param input The encoding, advanced past it.
+      /// @param end   The end of the available bytes.
+      /// @throw Error if the encoding is truncated.
+      inline
+      int64_t
+      read_number(elle::Buffer::Byte const*& input,
+                  elle::Buffer::Byte const* end)
+      {
+        if (input == end)
+          err<Error>("end of stream while reading number");
+        auto const c = *input;
+        auto const size =
+          !(c & 0x40) ? 1 : !(c & 0x20) ? 2 : !(c & 0x10) ? 3 : 9;
+        if (end - input < size)
+          err<Error>("end of stream while reading number");
+        int64_t value;
+        switch (size)
+        {
+          case 1:
+            value = c & 0x3f;
+            break;
+          case 2:
+            value = ((c & 0x1f) << 8) + input[1];
+            break;
+          case 3:
+            value = ((c & 0x0f) << 16) + (input[1] << 8) + input[2];
+            break;
+          default:
+            std::memcpy(&value, input + 1, 8);
+        }
+        input += size;
+        return (c & 0x80) ? -value : value;
+      }
+
+      /// Tags leading a natively encoded boost::posix_time::ptime.
+      ///
+      /// Times used to be written as ISO 8601 strings, which start with their
+      /// size. Tags are negative so the two forms cannot be confused. A time
+      /// tag is followed by the microseconds since the epoch.
+      enum class TimeTag: int64_t
+      {
+        time = -1,
+        not_a_date_time = -2,
+        pos_infin = -3,
+        neg_infin = -4,
+      };
+    }
+  }
+}
@@ -1,5 +1,6 @@
 #include <elle/serialization/json/SerializerIn.hh>
 
+#include <cstring>
 #include <limits>
 
 #include <elle/Backtrace.hh>
@@ -7,10 +8,13 @@
 #include <elle/format/base64.hh>
 #include <elle/finally.hh>
 #include <elle/json/exceptions.hh>
+#include <elle/json/scan.hh>
+#include <elle/log.hh>
 #include <elle/memory.hh>
 #include <elle/printf.hh>
 #include <elle/serialization/Error.hh>
 #include <elle/serialization/json/Error.hh>
+#include <elle/unreachable.hh>
 
 ELLE_LOG_COMPONENT("elle.serialization.json.SerializerIn");
 
@@ -20,6 +24,43 @@ namespace elle
   {
     namespace json
     {
+      namespace
+      {
+        std::type_info const&
+        json_type(elle::json::Document::Value const& value)
+        {
+          using Type = elle::json::Document::Type;
+          switch (value.type())
+          {
+            case Type::null:
+              return typeid(elle::json::NullType);
+            case Type::boolean:
+              return typeid(bool);
+            case Type::integer:
+              return typeid(int64_t);
+            case Type::real:
+              return typeid(double);
+            case Type::string:
+              return typeid(std::string);
+            case Type::array:
+              return typeid(elle::json::Array);
+            case Type::object:
+              return typeid(elle::json::Object);
+          }
+          elle::unreachable();
+        }
+
+        template <typename ... Types>
+        bool
+        is_one_of(std::type_info const& type)
+        {
+          for (auto t: {&typeid(Types)...})
+            if (*t == type)
+              return true;
+          return false;
+        }
+      }
+
       /*-------------.
       | Construction |
       `-------------*/
@@ -28,7 +69,7 @@ namespace elle
                                  bool versioned)
         : Super(versioned)
         , _partial(false)
-        , _json()
+        , _document()
         , _current()
       {
         this->_load_json(input);
@@ -39,7 +80,7 @@ namespace elle
                                  bool versioned)
         : Super(std::move(versions), versioned)
         , _partial(false)
-        , _json()
+        , _document()
         , _current()
       {
         this->_load_json(input);
@@ -48,19 +89,32 @@ namespace elle
       SerializerIn::SerializerIn(elle::json::Json input, bool versioned)
         : Super(versioned)
         , _partial(false)
-        , _json(std::move(input))
+        , _document(std::make_unique<elle::json::Document>(input))
         , _current()
       {
-        this->_current.push_back(&this->_json);
+        this->_current.push_back(Value{this->_document->root(), 0});
+      }
+
+      SerializerIn::SerializerIn(elle::json::Document const& input,
+                                 bool versioned)
+        : Super(versioned)
+        , _partial(false)
+        , _document()
+        , _current()
+      {
+        this->_current.push_back(Value{input.root(), 0});
       }
 
       void
       SerializerIn::_load_json(std::istream& input)
       {
+        ELLE_TRACE_SCOPE("%s: read JSON", this);
         try
         {
-          this->_json = elle::json::read(input);
-          this->_current.push_back(&this->_json);
+          auto text = std::string{};
+          elle::json::detail::read(input, text);
+          ELLE_DEBUG("read %s bytes", text.size());
+          this->_document = std::make_unique<elle::json::Document>(text);
         }
         catch (elle::json::ParseError const& e)
         {
@@ -68,12 +122,18 @@ namespace elle
           exception.inner_exception(std::current_exception());
           throw exception;
         }
+        this->_current.push_back(Value{this->_document->root(), 0});
       }
 
+      /*--------------.
+      | Serialization |
+      `--------------*/
+
       void
       SerializerIn::_serialize(int64_t& v)
       {
-        v = this->_check_type<int64_t>();
+        this->_check_type<int64_t>();
+        v = this->_current.back().value.integer();
       }
 
       void
@@ -140,13 +200,19 @@ namespace elle
       void
       SerializerIn::_serialize(double& v)
       {
-        v = this->_check_type<double, int64_t>();
+        auto const& type = this->_check_type<double, int64_t>();
+        auto const& value = this->_current.back().value;
+        if (type == typeid(int64_t))
+          v = value.integer();
+        else
+          v = value.real();
       }
 
       void
       SerializerIn::_serialize(bool& v)
       {
-        v = this->_check_type<bool>();
+        this->_check_type<bool>();
+        v = this->_current.back().value.boolean();
       }
 
       void
@@ -154,9 +220,8 @@ namespace elle
                                             bool,
                                             std::function<void ()> const& f)
       {
-        auto& object = this->_check_type<elle::json::Object>();
-        auto it = object.find(name);
-        if (it != object.end())
+        this->_check_type<elle::json::Object>();
+        if (this->_current.back().value.get(name))
           f();
         else
           ELLE_DEBUG("skip option as JSON key is missing");
@@ -166,7 +231,8 @@ namespace elle
       SerializerIn::_serialize_option(bool,
                                       std::function<void ()> const& f)
       {
-        if (this->_current.back()->type() != typeid(elle::json::NullType))
+        if (this->_current.back().value.type() !=
+            elle::json::Document::Type::null)
           f();
         else
           ELLE_DEBUG("skip option as JSON value is null");
@@ -175,27 +241,21 @@ namespace elle
       void
       SerializerIn::_serialize(std::string& v)
       {
-        v = this->_check_type<std::string>();
+        v = this->_string();
       }
 
       void
       SerializerIn::_serialize(elle::Buffer& buffer)
       {
-        auto& str = this->_check_type<std::string>();
-        std::stringstream encoded(str);
-        elle::format::base64::Stream base64(encoded);
-        {
-          elle::IOStream output(buffer.ostreambuf());
-          std::copy(std::istreambuf_iterator<char>(base64),
-                    std::istreambuf_iterator<char>(),
-                    std::ostreambuf_iterator<char>(output));
-        }
+        this->_check_type<std::string>();
+        buffer =
+          elle::format::base64::decode(this->_current.back().value.bytes());
       }
 
       void
       SerializerIn::_serialize(boost::posix_time::ptime& time)
       {
-        auto& str = this->_check_type<std::string>();
+        auto const str = this->_string();
         // Use the ISO extended input facet to interpret the string.
         std::stringstream ss(str);
         auto input_facet =
@@ -246,25 +306,34 @@ namespace elle
                                              std::int64_t& num,
                                              std::int64_t& denom)
       {
-        auto const repr = this->_check_type<std::string>();
+        auto const repr = this->_string();
         elle::chrono::duration_parse(repr, ticks, num, denom);
       }
 
       bool
       SerializerIn::_enter(std::string const& name)
       {
-        auto& object = this->_check_type<elle::json::Object>();
-        auto it = object.find(name);
-        if (it == object.end())
-          if (this->_partial)
-            return false;
-          else
-            throw MissingKey(name);
-        else
+        this->_check_type<elle::json::Object>();
+        auto& current = this->_current.back();
+        auto const size = current.value.size();
+        for (std::size_t i = 0; i < size; ++i)
         {
-          this->_current.push_back(&it->second);
-          return true;
+          auto const index = (current.next + i) % size;
+          auto const key = current.value.key(index);
+          if (key.size() == name.size() &&
+              !std::memcmp(key.contents(), name.data(), name.size()))
+          {
+            current.next = index + 1;
+            // Copy before pushing, which may move the current value.
+            auto const value = current.value.value(index);
+            this->_current.push_back(Value{value, 0});
+            return true;
+          }
         }
+        if (this->_partial)
+          return false;
+        else
+          throw MissingKey(name);
       }
 
       void
@@ -278,12 +347,14 @@ namespace elle
         int size,
         std::function<void ()> const& serialize_element)
       {
-        auto& array = this->_check_type<elle::json::Array>();
-        for (auto& elt: array)
+        this->_check_type<elle::json::Array>();
+        auto const array = this->_current.back().value;
+        auto const count = array.size();
+        for (std::size_t i = 0; i < count; ++i)
         {
-          this->_current.push_back(&elt);
+          this->_current.push_back(Value{array[i], 0});
+          elle::SafeFinally pop([&] { this->_current.pop_back(); });
           serialize_element();
-          this->_current.pop_back();
         }
       }
 
@@ -291,77 +362,58 @@ namespace elle
       SerializerIn::_deserialize_dict_key(
         std::function<void (std::string const&)> const& f)
       {
-        auto& current = *this->_current.back();
-        if (current.type() == typeid(elle::json::Object))
+        using Type = elle::json::Document::Type;
+        auto const current = this->_current.back().value;
+        if (current.type() == Type::object)
         {
-          const auto& object = boost::any_cast<elle::json::Object>(current);
-          for (auto& elt: object)
-            if (this->_enter(elt.first))
-            {
-              elle::SafeFinally leave([&] { this->_leave(elt.first); });
-              f(elt.first);
-            }
+          auto const size = current.size();
+          for (std::size_t i = 0; i < size; ++i)
+          {
+            auto const key = current.key(i).string();
+            this->_current.push_back(Value{current.value(i), 0});
+            elle::SafeFinally leave([&] { this->_leave(key); });
+            f(key);
+          }
         }
-        else if (current.type() == typeid(elle::json::Array))
+        else if (current.type() == Type::array)
         {
-          auto& array = boost::any_cast<elle::json::Array&>(current);
-          for (auto& elt: array)
+          auto const size = current.size();
+          for (std::size_t i = 0; i < size; ++i)
           {
-            if (elt.type() == typeid(elle::json::Array))
+            auto const pair = current[i];
+            // Only consider [key, value] pairs.
+            if (pair.type() == Type::array && pair.size() == 2 &&
+                pair[0].type() == Type::string)
             {
-              auto& subarray = boost::any_cast<elle::json::Array&>(elt);
-              if (subarray.size() == 2
-                  && subarray.front().type() == typeid(std::string))
-              {
-                auto key = boost::any_cast<std::string>(subarray.front());
-                elle::SafeFinally leave([&] { this->_leave(key); });
-                this->_current.push_back(&subarray.back());
-                f(key);
-              }
+              auto const key = pair[0].string();
+              this->_current.push_back(Value{pair[1], 0});
+              elle::SafeFinally leave([&] { this->_leave(key); });
+              f(key);
             }
           }
         }
       }
 
-      template <typename T, typename ... Types>
-      struct
-      any_casts
-      {
-        static
-        T&
-        cast(std::string const& name, boost::any& value)
-        {
-          throw TypeError(name, typeid(T), value.type());
-        }
-      };
-
-      template <typename T, typename First, typename ... Tail>
-      struct
-      any_casts<T, First, Tail ...>
-      {
-        static
-        T&
-        cast(std::string const& name, boost::any& value)
-        {
-          if (value.type() == typeid(First))
-          {
-            value = T(boost::any_cast<First&>(value));
-            return boost::any_cast<T&>(value);
-          }
-          else
-            return any_casts<T, Tail ...>::cast(name, value);
-        }
-      };
+      /*-----.
+      | JSON |
+      `-----*/
 
       template <typename T, typename ... Alternatives>
-      T&
+      std::type_info const&
       SerializerIn::_check_type()
       {
-        auto& current = *this->_current.back();
+        auto const& type = json_type(this->_current.back().value);
+        if (is_one_of<T, Alternatives...>(type))
+          return type;
         auto name = this->_names.empty() ? "" : this->_names.back();
-        if (current.type() == typeid(T))
-          return boost::any_cast<T&>(current);
-        return any_casts<T, Alternatives ...>::cast(name, current);
+        throw TypeError(name, typeid(T), type);
+      }
+
+      std::string
+      SerializerIn::_string()
+      {
+        this->_check_type<std::string>();
+        return this->_current.back().value.string();
       }
     }
   }
@@ -1,5 +1,10 @@
 #pragma once
 
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <elle/json/Document.hh>
 #include <elle/json/json.hh>
 #include <elle/serialization/SerializerIn.hh>
 
@@ -12,6 +17,10 @@ namespace elle
       /// A specialized SerializerIn for JSON.
       ///
       /// Deserialize objects from their JSON representations.
+      ///
+      /// The JSON value is read from the input into a json::Document, or
+      /// from a Document directly, so values are deserialized without going
+      /// through boost::any.
       class ELLE_API SerializerIn
         : public serialization::SerializerIn
       {
@@ -37,10 +46,19 @@ namespace elle
                      Versions versions, bool versioned = true);
         /// Construct a SerializerIn from a JSON object.
         ///
+        /// The object is converted to a Document, prefer the other
+        /// constructors when the text or a Document is at hand.
+        ///
         /// @param input A json object.
         /// @param versioned Whether the Serializer will read the version of
         ///                  objects.
         SerializerIn(elle::json::Json input, bool versioned = true);
+        /// Construct a SerializerIn reading from a Document.
+        ///
+        /// @param input A document, which must outlive the SerializerIn.
+        /// @param versioned Whether the Serializer will read the version of
+        ///                  objects.
+        SerializerIn(elle::json::Document const& input, bool versioned = true);
       private:
         void
         _load_json(std::istream& input);
@@ -103,15 +121,30 @@ namespace elle
         void
         _leave(std::string const& name) override;
 
-        ELLE_ATTRIBUTE(boost::any, json);
-        ELLE_ATTRIBUTE(std::vector<boost::any*>, current);
+      /*-----.
+      | JSON |
+      `-----*/
       private:
+        /// A value being read, from the root to the current one.
+        struct Value
+        {
+          elle::json::Document::Value value;
+          /// Where to start looking for the next key, since keys are usually
+          /// read in the order they were written.
+          std::size_t next;
+        };
+        /// The JSON type of the current value, or fail.
         template <typename T, typename ... Alternatives>
-        T&
+        std::type_info const&
         _check_type();
+        std::string
+        _string();
         template <typename T>
         void
         _serialize_int(T& v);
+        /// The document read from a stream or converted from a Json.
+        ELLE_ATTRIBUTE(std::unique_ptr<elle::json::Document>, document);
+        ELLE_ATTRIBUTE(std::vector<Value>, current);
       };
     }
   }
@@ -1,9 +1,10 @@
 #include <elle/serialization/json/SerializerOut.hh>
 
-#include <elle/Lazy.hh>
+#include <cstdio>
+#include <cstring>
+
 #include <elle/assert.hh>
 #include <elle/format/base64.hh>
-#include <elle/json/json.hh>
 #include <elle/log.hh>
 
 ELLE_LOG_COMPONENT("elle.serialization.json.SerializerOut")
@@ -22,12 +23,11 @@ namespace elle
                                    bool versioned,
                                    bool pretty)
         : Super(versioned)
-        , _json()
         , _current()
         , _pretty(pretty)
         , _output(output)
       {
-        this->_current.push_back(&this->_json);
+        this->_current.push_back(Value());
       }
 
       SerializerOut::SerializerOut(std::ostream& output,
@@ -35,24 +35,24 @@ namespace elle
                                    bool versioned,
                                    bool pretty)
         : Super(std::move(versions), versioned)
-        , _json()
         , _current()
         , _pretty(pretty)
         , _output(output)
       {
-        this->_current.push_back(&this->_json);
+        this->_current.push_back(Value());
       }
 
       SerializerOut::~SerializerOut() noexcept(false)
       {
-        ELLE_TRACE_SCOPE("%s: write JSON %s", this, this->output());
-        ELLE_DUMP(
-          "%s",
-          elle::lazy([&] { return elle::json::pretty_print(this->_json); }));
-        if (this->_pretty)
-          this->output() << elle::json::pretty_print(this->_json);
-        else
-          elle::json::write(this->output(), this->_json);
+        ELLE_TRACE_SCOPE("%s: finish JSON %s", this, this->output());
+        while (!this->_current.empty())
+        {
+          this->_close();
+          this->_current.pop_back();
+        }
+        if (!this->_pretty)
+          this->_output.put('\n');
+        this->_output.flush();
       }
 
       /*--------------.
@@ -63,29 +63,30 @@ namespace elle
       SerializerOut::_enter(std::string const& name)
       {
         ELLE_ASSERT(!this->_current.empty());
-        auto& current = *this->_current.back();
-        if (current.empty())
+        auto& current = this->_current.back();
+        if (current.kind == Value::Kind::none)
         {
           ELLE_DEBUG("create current object");
-          current = elle::json::Object();
+          this->_open(Value::Kind::object);
+          this->_output.put('{');
         }
-        if (current.type() == typeid(elle::json::Object))
+        if (current.kind == Value::Kind::object)
         {
           ELLE_DEBUG_SCOPE("insert key \"%s\"", name);
-          auto& object = boost::any_cast<elle::json::Object&>(current);
           // FIXME: hackish way to not serialize version twice when
           // serialize_forward is used.
-          if (name == ".version" && object.find(name) != object.end())
-            return false;
-          auto it = object.emplace(name, boost::any());
-          this->_current.push_back(&it.first->second);
+          if (name == ".version")
+          {
+            if (current.versioned)
+              return false;
+            current.versioned = true;
+          }
+          this->_current.push_back(Value(name));
         }
-        else if (current.type() == typeid(elle::json::Array))
+        else if (current.kind == Value::Kind::array)
         {
           ELLE_DEBUG_SCOPE("insert array element");
-          auto& array = boost::any_cast<elle::json::Array&>(current);
-          array.emplace_back();
-          this->_current.push_back(&array.back());
+          this->_current.push_back(Value());
         }
         else
         {
@@ -99,6 +100,7 @@ namespace elle
       SerializerOut::_leave(std::string const& name)
       {
         ELLE_ASSERT(!this->_current.empty());
+        this->_close();
         this->_current.pop_back();
       }
 
@@ -107,9 +109,8 @@ namespace elle
                                       std::function<void ()> const& f)
       {
         ELLE_ASSERT(!this->_current.empty());
-        auto& current = *this->_current.back();
-        ELLE_ASSERT(current.empty());
-        current = elle::json::Array();
+        this->_open(Value::Kind::array);
+        this->_output.put('[');
         f();
       }
 
@@ -126,91 +127,89 @@ namespace elle
       void
       SerializerOut::_serialize(int64_t& v)
       {
-        auto& current = this->_get_current();
-        current = v;
+        this->_scalar() << v;
       }
 
       void
       SerializerOut::_serialize(uint64_t& v)
       {
-        auto& current = this->_get_current();
-        current = v;
+        this->_scalar() << v;
       }
 
       void
       SerializerOut::_serialize(int32_t& v)
       {
-        auto& current = this->_get_current();
-        current = v;
+        this->_scalar() << v;
       }
 
       void
       SerializerOut::_serialize(uint32_t& v)
       {
-        auto& current = this->_get_current();
-        current = v;
+        this->_scalar() << v;
       }
 
       void
       SerializerOut::_serialize(int16_t& v)
       {
-        auto& current = this->_get_current();
-        current = v;
+        this->_scalar() << v;
       }
 
       void
       SerializerOut::_serialize(uint16_t& v)
       {
-        auto& current = this->_get_current();
-        current = v;
+        this->_scalar() << v;
       }
 
       void
       SerializerOut::_serialize(int8_t& v)
       {
-        auto& current = this->_get_current();
-        current = int(v);
+        this->_scalar() << int(v);
       }
 
       void
       SerializerOut::_serialize(uint8_t& v)
       {
-        auto& current = this->_get_current();
-        current = int(v);
+        this->_scalar() << int(v);
       }
 
       void
       SerializerOut::_serialize(double& v)
       {
-        auto& current = this->_get_current();
-        current = v;
+        // Enough digits to read the same double back.
+        char repr[32];
+        auto size = std::snprintf(repr, sizeof repr, "%.17g", v);
+        // Keep integral values reals: 1.0 must not read back as 1.
+        if (!std::strpbrk(repr, ".eEn"))
+        {
+          repr[size++] = '.';
+          repr[size++] = '0';
+        }
+        this->_scalar().write(repr, size);
       }
 
       void
       SerializerOut::_serialize(bool& v)
       {
-        auto& current = this->_get_current();
-        current = v;
+        if (v)
+          this->_scalar().write("true", 4);
+        else
+          this->_scalar().write("false", 5);
       }
 
       void
       SerializerOut::_serialize(std::string& v)
       {
-        auto& current = this->_get_current();
-        current = v;
+        this->_open(Value::Kind::scalar);
+        this->_write_string(v.data(), v.size());
       }
 
       void
       SerializerOut::_serialize(elle::Buffer& buffer)
       {
-        std::stringstream encoded;
-        {
-          elle::format::base64::Stream base64(encoded);
-          base64.write(reinterpret_cast<char*>(buffer.contents()),
-                       buffer.size());
-        }
-        auto& current = this->_get_current();
-        current = encoded.str();
+        auto const encoded = elle::format::base64::encode(buffer);
+        this->_open(Value::Kind::scalar);
+        this->_write_string(reinterpret_cast<char const*>(encoded.contents()),
+                            encoded.size());
       }
 
       void
@@ -223,7 +222,8 @@ namespace elle
         output_facet->format("%Y-%m-%dT%H:%M:%S%F%q");
         ss.imbue(std::locale(ss.getloc(), output_facet.release()));
         ss << time;
-        this->_get_current() = ss.str();
+        auto repr = ss.str();
+        this->_serialize(repr);
       }
 
       void
@@ -277,8 +277,8 @@ namespace elle
             }
           }
         }
-        auto& current = this->_get_current();
-        current = elle::sprintf("%s%s", ticks, orders[order]);
+        auto repr = elle::sprintf("%s%s", ticks, orders[order]);
+        this->_serialize(repr);
       }
 
       void
@@ -298,29 +298,138 @@ namespace elle
           f();
         else
         {
-          *this->_current.back() = elle::json::NullType();
+          auto const size = this->_current.size();
           if (!this->_names.empty())
+            ELLE_ASSERT_GT(size, 1u);
+          if (!this->_names.empty() &&
+              this->_current[size - 2].kind == Value::Kind::object)
+            this->_current.back().omitted = true;
+          else
+            this->_scalar().write("null", 4);
+        }
+      }
+
+      /*-----.
+      | JSON |
+      `-----*/
+
+      void
+      SerializerOut::_open(Value::Kind kind)
+      {
+        ELLE_ASSERT(!this->_current.empty());
+        auto const depth = this->_current.size() - 1;
+        auto& value = this->_current.back();
+        if (value.kind != Value::Kind::none)
+          ELLE_ABORT("%s: serializing in-place to an already filled object",
+                     *this);
+        if (depth > 0)
+        {
+          auto& parent = this->_current[depth - 1];
+          if (parent.filled)
+            this->_output.put(',');
+          parent.filled = true;
+          if (this->_pretty)
+            this->_indent(depth);
+          if (parent.kind == Value::Kind::object)
           {
-            ELLE_ASSERT_GT(signed(this->_current.size()), 1);
-            auto& last = *this->_current[this->_current.size() - 2];
-            if (last.type() == typeid(elle::json::Object))
-              ELLE_ENFORCE(boost::any_cast<elle::json::Object&>(last).erase(
-                             this->_names.back()));
+            this->_write_string(value.key.data(), value.key.size());
+            if (this->_pretty)
+              this->_output.write(": ", 2);
+            else
+              this->_output.put(':');
           }
         }
+        value.kind = kind;
       }
 
-      boost::any&
-      SerializerOut::_get_current()
+      void
+      SerializerOut::_close()
       {
-        ELLE_ASSERT(!this->_current.empty());
-        auto& current = *this->_current.back();
-        if (!current.empty())
+        auto& value = this->_current.back();
+        switch (value.kind)
         {
-          ELLE_ABORT("%s: serializing in-place to an already filled object: %s",
-                     *this, elle::json::pretty_print(current));
+          case Value::Kind::none:
+            // Entered but never filled, like an empty any.
+            if (!value.omitted)
+              this->_scalar().write("null", 4);
+            break;
+          case Value::Kind::object:
+            if (this->_pretty && value.filled)
+              this->_indent(this->_current.size() - 1);
+            this->_output.put('}');
+            break;
+          case Value::Kind::array:
+            if (this->_pretty && value.filled)
+              this->_indent(this->_current.size() - 1);
+            this->_output.put(']');
+            break;
+          case Value::Kind::scalar:
+            break;
         }
-        return current;
+      }
+
+      std::ostream&
+      SerializerOut::_scalar()
+      {
+        this->_open(Value::Kind::scalar);
+        return this->_output;
+      }
+
+      void
+      SerializerOut::_write_string(char const* data, std::size_t size)
+      {
+        auto& output = this->_output;
+        output.put('"');
+        auto const end = data + size;
+        auto plain = data;
+        for (auto it = data; it != end; ++it)
+        {
+          auto const c = static_cast<unsigned char>(*it);
+          if (c >= 0x20 && c != '"' && c != '\\')
+            continue;
+          output.write(plain, it - plain);
+          plain = it + 1;
+          switch (c)
+          {
+            case '"':
+              output.write("\\\"", 2);
+              break;
+            case '\\':
+              output.write("\\\\", 2);
+              break;
+            case '\b':
+              output.write("\\b", 2);
+              break;
+            case '\f':
+              output.write("\\f", 2);
+              break;
+            case '\n':
+              output.write("\\n", 2);
+              break;
+            case '\r':
+              output.write("\\r", 2);
+              break;
+            case '\t':
+              output.write("\\t", 2);
+              break;
+            default:
+            {
+              char escaped[8];
+              std::snprintf(escaped, sizeof escaped, "\\u%04x", c);
+              output.write(escaped, 6);
+            }
+          }
+        }
+        output.write(plain, end - plain);
+        output.put('"');
+      }
+
+      void
+      SerializerOut::_indent(int depth)
+      {
+        this->_output.put('\n');
+        for (int i = 0; i < depth; ++i)
+          this->_output.write("    ", 4);
       }
     }
   }
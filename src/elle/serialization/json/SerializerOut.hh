@@ -2,8 +2,6 @@
 
 #include <vector>
 
-#include <boost/any.hpp>
-
 #include <elle/attribute.hh>
 #include <elle/serialization/SerializerOut.hh>
 
@@ -17,6 +15,10 @@ namespace elle
       ///
       /// Serialize object to their JSON representation.
       ///
+      /// The JSON is streamed to the output as objects are serialized, without
+      /// building the document in memory first. Keys are written in the order
+      /// they are serialized.
+      ///
       /// Details:
       /// - Optional non initialized are not serialized.
       /// - unordered_map and map are serialized dict {x: y}.
@@ -126,16 +128,53 @@ namespace elle
         void
         _serialize_option(bool filled,
                           std::function<void ()> const& f) override;
-      private:
-        boost::any&
-        _get_current();
 
       /*-----.
       | JSON |
       `-----*/
       private:
-        ELLE_ATTRIBUTE(boost::any, json);
-        ELLE_ATTRIBUTE(std::vector<boost::any*>, current);
+        /// A value being written, from the root to the current one.
+        struct Value
+        {
+          enum class Kind
+          {
+            /// Nothing written yet.
+            none,
+            object,
+            array,
+            scalar,
+          };
+          Value(std::string key = {}, Kind kind = Kind::none)
+            : key(std::move(key))
+            , kind(kind)
+            , filled(false)
+            , versioned(false)
+            , omitted(false)
+          {}
+          /// Key of the value in the enclosing object.
+          std::string key;
+          Kind kind;
+          /// Whether members or elements were written.
+          bool filled;
+          /// Whether the object version was written.
+          bool versioned;
+          /// Whether the value is omitted, for null options in objects.
+          bool omitted;
+        };
+        /// Write what precedes the current value: separator and key.
+        void
+        _open(Value::Kind kind);
+        /// Write what follows the current value.
+        void
+        _close();
+        /// Start writing a scalar as the current value.
+        std::ostream&
+        _scalar();
+        void
+        _write_string(char const* data, std::size_t size);
+        void
+        _indent(int depth);
+        ELLE_ATTRIBUTE(std::vector<Value>, current);
         ELLE_ATTRIBUTE(bool, pretty);
         ELLE_ATTRIBUTE_R(std::ostream&, output);
       };
@@ -4,6 +4,7 @@
 #include <elle/test.hh>
 
 #include <elle/Buffer.hh>
+#include <elle/serialization/binary.hh>
 
 static
 void
@@ -199,7 +200,123 @@ test_capacity()
   b.size(8);
   BOOST_CHECK_EQUAL(b.capacity(), prev);
   b.shrink_to_fit();
-  BOOST_CHECK_EQUAL(b.capacity(), 8);
+  BOOST_CHECK_EQUAL(b.capacity(), elle::Buffer::inline_capacity);
+}
+
+static
+void
+test_inline()
+{
+  auto const allocations = elle::Buffer::allocations();
+  elle::Buffer b("small");
+  BOOST_CHECK_EQUAL(b.capacity(), elle::Buffer::inline_capacity);
+  auto const begin = reinterpret_cast<char const*>(&b);
+  auto const contents = reinterpret_cast<char const*>(b.contents());
+  BOOST_CHECK(contents >= begin && contents < begin + sizeof(b));
+  elle::Buffer moved(std::move(b));
+  BOOST_CHECK_EQUAL(moved, "small");
+  BOOST_CHECK_EQUAL(b.size(), 0);
+  elle::Buffer copy(moved);
+  BOOST_CHECK_EQUAL(copy, "small");
+  BOOST_CHECK_EQUAL(elle::Buffer::allocations(), allocations);
+  // Growing past the inline storage moves the content to the heap.
+  copy.size(elle::Buffer::inline_capacity + 1);
+  BOOST_CHECK_EQUAL(elle::Buffer::allocations(), allocations + 1);
+  BOOST_CHECK_EQUAL(copy.range(0, 5), "small");
+  auto const reallocations = elle::Buffer::reallocations();
+  copy.size(copy.capacity() + 1);
+  BOOST_CHECK_EQUAL(elle::Buffer::reallocations(), reallocations + 1);
+  BOOST_CHECK_EQUAL(copy.range(0, 5), "small");
+  // Heap content is stolen by moves.
+  auto const heap = copy.contents();
+  elle::Buffer stolen(std::move(copy));
+  BOOST_CHECK_EQUAL(stolen.contents(), heap);
+  // Released content is always malloc'd.
+  auto released = moved.release();
+  BOOST_CHECK_EQUAL(released.second, 5);
+  BOOST_CHECK_EQUAL(
+    elle::ConstWeakBuffer(released.first.get(), released.second), "small");
+  BOOST_CHECK_EQUAL(moved.size(), 0);
+}
+
+static
+void
+test_reserve()
+{
+  elle::Buffer b("data");
+  b.reserve(1024);
+  BOOST_CHECK_GE(b.capacity(), 1024);
+  BOOST_CHECK_EQUAL(b, "data");
+  auto const reallocations = elle::Buffer::reallocations();
+  b.size(1000);
+  BOOST_CHECK_EQUAL(elle::Buffer::reallocations(), reallocations);
+  b.reserve(16);
+  BOOST_CHECK_GE(b.capacity(), 1024);
+  BOOST_CHECK_EQUAL(b.size(), 1000);
+}
+
+namespace
+{
+  class CountingAllocator
+    : public elle::Buffer::Allocator
+  {
+  public:
+    void*
+    allocate(elle::Buffer::Size size) override
+    {
+      ++this->allocated;
+      return ::malloc(size);
+    }
+
+    void*
+    reallocate(void* data,
+               elle::Buffer::Size,
+               elle::Buffer::Size size) override
+    {
+      ++this->reallocated;
+      return ::realloc(data, size);
+    }
+
+    void
+    deallocate(void* data, elle::Buffer::Size) override
+    {
+      ++this->deallocated;
+      ::free(data);
+    }
+
+    int allocated = 0;
+    int reallocated = 0;
+    int deallocated = 0;
+  };
+}
+
+static
+void
+test_allocator()
+{
+  CountingAllocator allocator;
+  {
+    elle::Buffer b(allocator);
+    BOOST_CHECK_EQUAL(b.allocator(), &allocator);
+    b.append("small", 5);
+    BOOST_CHECK_EQUAL(allocator.allocated, 0);
+    b.size(256);
+    BOOST_CHECK_EQUAL(allocator.allocated, 1);
+    b.size(4096);
+    BOOST_CHECK_EQUAL(allocator.reallocated, 1);
+    BOOST_CHECK_EQUAL(b.range(0, 5), "small");
+    // The allocator follows the content.
+    elle::Buffer moved(std::move(b));
+    BOOST_CHECK_EQUAL(moved.allocator(), &allocator);
+    BOOST_CHECK_EQUAL(allocator.deallocated, 0);
+    // Allocator memory is copied to malloc'd memory on release.
+    auto released = moved.release();
+    BOOST_CHECK_EQUAL(released.second, 4096);
+    BOOST_CHECK_EQUAL(allocator.deallocated, 1);
+    moved.size(128);
+  }
+  BOOST_CHECK_EQUAL(allocator.allocated, 2);
+  BOOST_CHECK_EQUAL(allocator.deallocated, 2);
 }
 
 static
@@ -343,6 +460,85 @@ input()
   BOOST_CHECK_EQUAL(a, 13);
 }
 
+namespace shared
+{
+  static
+  void
+  slices()
+  {
+    auto source = elle::Buffer(1024);
+    for (auto i = 0u; i < source.size(); ++i)
+      source[i] = i % 256;
+    auto const contents = source.contents();
+    auto shared = elle::SharedBuffer(std::move(source));
+    BOOST_CHECK_EQUAL(shared.contents(), contents);
+    BOOST_CHECK_EQUAL(shared.size(), 1024);
+    BOOST_CHECK_EQUAL(shared.use_count(), 1);
+    auto slice = shared.range(256, 512);
+    BOOST_CHECK_EQUAL(slice.contents(), contents + 256);
+    BOOST_CHECK_EQUAL(slice.size(), 256);
+    BOOST_CHECK_EQUAL(shared.use_count(), 2);
+    auto tail = slice.range(-16);
+    BOOST_CHECK_EQUAL(tail.contents(), contents + 496);
+    BOOST_CHECK_EQUAL(tail[0], 496 % 256);
+    // Slices keep the memory alive.
+    shared = elle::SharedBuffer();
+    BOOST_CHECK_EQUAL(shared.use_count(), 0);
+    BOOST_CHECK_EQUAL(slice.use_count(), 2);
+    BOOST_CHECK_EQUAL(slice.copy(), elle::ConstWeakBuffer(slice));
+    BOOST_CHECK_EQUAL(slice[0], 0);
+  }
+
+  static
+  void
+  small()
+  {
+    auto shared = elle::SharedBuffer(elle::Buffer("inline"));
+    auto slice = shared.range(2);
+    shared = elle::SharedBuffer();
+    BOOST_CHECK_EQUAL(slice, "line");
+  }
+
+  static
+  void
+  rope()
+  {
+    auto rope = elle::Rope();
+    BOOST_CHECK(rope.empty());
+    auto const packet = elle::SharedBuffer(elle::Buffer("10 11 12 13"));
+    rope.append(packet.range(0, 6));
+    rope.append(elle::SharedBuffer());
+    rope.append(packet.range(6));
+    rope.append(elle::Buffer(" 14"));
+    BOOST_CHECK_EQUAL(rope.size(), 14);
+    BOOST_CHECK_EQUAL(rope.segments().size(), 3);
+    BOOST_CHECK_EQUAL(rope.segments()[0].contents(), packet.contents());
+    BOOST_CHECK_EQUAL(rope.flatten(), "10 11 12 13 14");
+    auto const weak = rope.weak_segments();
+    BOOST_CHECK_EQUAL(weak.size(), 3);
+    BOOST_CHECK_EQUAL(weak[1].contents(), packet.contents() + 6);
+    elle::IOStream stream(rope.istreambuf());
+    int a, b, c, d, e;
+    stream >> a >> b >> c >> d >> e;
+    BOOST_CHECK_EQUAL(a, 10);
+    BOOST_CHECK_EQUAL(c, 12);
+    BOOST_CHECK_EQUAL(e, 14);
+  }
+
+  static
+  void
+  serialization()
+  {
+    auto const packet = elle::SharedBuffer(
+      elle::serialization::binary::serialize(std::string(4096, 'x'), false));
+    elle::IOStream stream(packet.istreambuf());
+    elle::serialization::binary::SerializerIn input(stream, false);
+    auto s = std::string{};
+    input.serialize_forward(s);
+    BOOST_CHECK_EQUAL(s, std::string(4096, 'x'));
+  }
+}
+
 ELLE_TEST_SUITE()
 {
   auto& master = boost::unit_test::framework::master_test_suite();
@@ -377,6 +573,19 @@ ELLE_TEST_SUITE()
   memory->add(BOOST_TEST_CASE(test_capacity));
   memory->add(BOOST_TEST_CASE(test_release));
   memory->add(BOOST_TEST_CASE(test_assign));
+  memory->add(BOOST_TEST_CASE(test_inline));
+  memory->add(BOOST_TEST_CASE(test_reserve));
+  memory->add(BOOST_TEST_CASE(test_allocator));
+
+  {
+    auto suite = BOOST_TEST_SUITE("SharedBuffer");
+    master.add(suite);
+    using namespace shared;
+    suite->add(BOOST_TEST_CASE(slices));
+    suite->add(BOOST_TEST_CASE(small));
+    suite->add(BOOST_TEST_CASE(rope));
+    suite->add(BOOST_TEST_CASE(serialization));
+  }
 
   boost::unit_test::test_suite* streams = BOOST_TEST_SUITE("streams");
   buffer->add(streams);
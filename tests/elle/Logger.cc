@@ -1,8 +1,10 @@
 //#define ELLE_TEST_NO_MEMFRY
 #include <elle/test.hh>
 
+#include <elle/filesystem/TemporaryFile.hh>
 #include <elle/finally.hh>
 #include <elle/log.hh>
+#include <elle/log/AsyncLogger.hh>
 #include <elle/log/Logger.hh>
 #include <elle/log/TextLogger.hh>
 #include <elle/memory.hh>
@@ -13,9 +15,13 @@
 #include <boost/algorithm/string.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
 
+#include <regex>
 #include <sstream>
 #include <thread>
 
+#include <fcntl.h>
+#include <unistd.h>
+
 template<bool b>
 void
 _message_test(bool env)
@@ -549,6 +555,155 @@ error()
   }
 }
 
+/// Check that disabled log statements are enabled by a more verbose logger,
+/// and measure their cost.
+static
+void
+disabled()
+{
+  ELLE_LOG_COMPONENT("disabled");
+  auto const generate_log = [] (int i)
+  {
+    ELLE_DEBUG("disabled.%s", i);
+  };
+  {
+    std::stringstream output;
+    elle::os::setenv("ELLE_LOG_LEVEL", "LOG", 1);
+    elle::log::logger(std::make_unique<elle::log::TextLogger>(output));
+    auto const iterations = 10000000;
+    auto const start = boost::posix_time::microsec_clock::local_time();
+    for (int i = 0; i < iterations; ++i)
+      generate_log(i);
+    auto const elapsed =
+      boost::posix_time::microsec_clock::local_time() - start;
+    BOOST_CHECK_EQUAL(output.str(), "");
+    BOOST_TEST_MESSAGE(
+      elle::sprintf("disabled ELLE_DEBUG: %sns",
+                    elapsed.total_nanoseconds() * 1.0 / iterations));
+  }
+  {
+    std::stringstream output;
+    elle::os::setenv("ELLE_LOG_LEVEL", "DEBUG", 1);
+    elle::log::logger(std::make_unique<elle::log::TextLogger>(output));
+    generate_log(42);
+    BOOST_CHECK_EQUAL(output.str(), "[disabled] disabled.42\n");
+  }
+  elle::os::unsetenv("ELLE_LOG_LEVEL");
+}
+
+namespace async
+{
+  static
+  std::string
+  read_all(int fd)
+  {
+    auto res = std::string{};
+    char buffer[4096];
+    while (true)
+    {
+      auto n = ::read(fd, buffer, sizeof buffer);
+      if (n <= 0)
+        return res;
+      res.append(buffer, n);
+    }
+  }
+
+  static
+  void
+  write()
+  {
+    int fds[2];
+    BOOST_REQUIRE_EQUAL(::pipe(fds), 0);
+    auto output = std::string{};
+    std::thread reader([&] { output = read_all(fds[0]); });
+    {
+      elle::os::setenv("ELLE_LOG_LEVEL", "DUMP", 1);
+      elle::log::logger(std::make_unique<elle::log::AsyncLogger>(fds[1]));
+      elle::os::unsetenv("ELLE_LOG_LEVEL");
+      ELLE_LOG_COMPONENT("async");
+      ELLE_TRACE("first")
+        ELLE_DEBUG("second");
+      ELLE_TRACE("third");
+      // Destroying the logger writes pending messages.
+      elle::log::logger(nullptr);
+    }
+    ::close(fds[1]);
+    reader.join();
+    ::close(fds[0]);
+    BOOST_CHECK_EQUAL(output,
+                      "[async] first\n"
+                      "[async]   second\n"
+                      "[async] third\n");
+  }
+
+  /// Log to a file opened by the logger, and check it is closed with it.
+  static
+  void
+  file()
+  {
+    auto const f = elle::filesystem::TemporaryFile("async.log");
+    auto fd = -1;
+    {
+      elle::log::AsyncLogger logger(f.path().string(), false, "LOG");
+      fd = logger.fd();
+      logger.message(elle::log::Logger::Level::log,
+                     elle::log::Logger::Type::info,
+                     "async", "logged", __FILE__, __LINE__, "file");
+    }
+    BOOST_CHECK_EQUAL(::fcntl(fd, F_GETFD), -1);
+    auto input = ::open(f.path().string().c_str(), O_RDONLY);
+    BOOST_REQUIRE_GE(input, 0);
+    auto output = read_all(input);
+    ::close(input);
+    BOOST_CHECK_NE(output.find("[async] logged"), std::string::npos);
+  }
+
+  /// Log faster than the writer thread can write to a pipe nobody reads, and
+  /// check overflowing messages are dropped and counted.
+  static
+  void
+  overflow(elle::log::AsyncLogger::Overflow policy)
+  {
+    int fds[2];
+    BOOST_REQUIRE_EQUAL(::pipe(fds), 0);
+    auto const count = 1000;
+    auto const line = std::string(1023, 'x');
+    elle::log::AsyncLogger logger(fds[1], "LOG", policy, 4);
+    for (int i = 0; i < count; ++i)
+      logger.message(elle::log::Logger::Level::log,
+                     elle::log::Logger::Type::info,
+                     "overflow", line, __FILE__, __LINE__, "overflow");
+    BOOST_CHECK_GT(logger.dropped(), 0u);
+    BOOST_CHECK_LE(logger.queue_depth(), 4u);
+    auto output = std::string{};
+    std::thread reader([&] { output = read_all(fds[0]); });
+    logger.flush();
+    ::close(fds[1]);
+    reader.join();
+    ::close(fds[0]);
+    auto lines = 0u;
+    auto reported = 0u;
+    {
+      auto stream = std::stringstream(output);
+      auto l = std::string{};
+      static auto const report = std::regex{".*] ([0-9]+) messages dropped"};
+      while (std::getline(stream, l))
+      {
+        auto m = std::smatch{};
+        if (std::regex_match(l, m, report))
+          reported += std::stoi(m[1]);
+        else if (l.find(line) != std::string::npos)
+          ++lines;
+      }
+    }
+    BOOST_CHECK_EQUAL(lines, count - logger.dropped());
+    if (policy == elle::log::AsyncLogger::Overflow::count)
+      BOOST_CHECK_EQUAL(reported, logger.dropped());
+    else
+      BOOST_CHECK_EQUAL(reported, 0u);
+  }
+}
+
 ELLE_TEST_SUITE()
 {
   elle::log::detail::debug_formats(false);
@@ -572,5 +727,18 @@ ELLE_TEST_SUITE()
   format->add(BOOST_TEST_CASE(trim));
   format->add(BOOST_TEST_CASE(component_width));
   format->add(BOOST_TEST_CASE(nested));
+
+  boost::unit_test::test_suite* performance = BOOST_TEST_SUITE("performance");
+  suite.add(performance);
+  performance->add(BOOST_TEST_CASE(disabled));
+
+  boost::unit_test::test_suite* async = BOOST_TEST_SUITE("async");
+  suite.add(async);
+  async->add(BOOST_TEST_CASE(async::write));
+  async->add(BOOST_TEST_CASE(async::file));
+  async->add(BOOST_TEST_CASE(
+    std::bind(async::overflow, elle::log::AsyncLogger::Overflow::drop)));
+  async->add(BOOST_TEST_CASE(
+    std::bind(async::overflow, elle::log::AsyncLogger::Overflow::count)));
 #endif
 }
@@ -1,3 +1,6 @@
+#include <boost/filesystem/fstream.hpp>
+
+#include <elle/filesystem/TemporaryDirectory.hh>
 #include <elle/serialization/binary.hh>
 #include <elle/serialization/json.hh>
 #include <elle/test.hh>
@@ -6,7 +9,9 @@
 #include <elle/reactor/scheduler.hh>
 #include <elle/reactor/signal.hh>
 
+#include <elle/athena/paxos/BatchClient.hh>
 #include <elle/athena/paxos/Client.hh>
+#include <elle/athena/paxos/Log.hh>
 #include <elle/athena/paxos/Server.hh>
 
 ELLE_LOG_COMPONENT("elle.athena.paxos.test");
@@ -298,8 +303,9 @@ ELLE_TEST_SCHEDULED(concurrent)
   paxos::Client<int, int, int> client_2(2, std::move(peers_2));
   client_2.conflict_backoff(false);
   peer_1_2->propose_barrier.open();
-  peer_1_2->accept_barrier.open();
   peer_1_3->propose_barrier.open();
+  // Client 1 only gets peer 11 to accept before client 2 chooses, and must
+  // then retry after peers 12 and 13 report the conflict.
   elle::reactor::Thread::unique_ptr t1(
     new elle::reactor::Thread(
       "1",
@@ -312,10 +318,576 @@ ELLE_TEST_SCHEDULED(concurrent)
     elle::reactor::Waitables({&peer_1_2->accept_signal, &peer_1_3->accept_signal}));
   auto chosen = client_2.choose(43);
   BOOST_CHECK_EQUAL(chosen->value.get<int>(), 42);
+  peer_1_2->accept_barrier.open();
   peer_1_3->accept_barrier.open();
   elle::reactor::wait(*t1);
 }
 
+ELLE_TEST_SCHEDULED(slow_peer)
+{
+  auto servers = std::vector<std::unique_ptr<paxos::Server<int, int, int>>>{};
+  for (int i = 11; i <= 15; ++i)
+    servers.emplace_back(std::make_unique<paxos::Server<int, int, int>>(
+                           i, paxos::Server<int, int, int>::Quorum{
+                             11, 12, 13, 14, 15}));
+  auto slow = new InstrumentedPeer<int, int, int>(15, *servers[4]);
+  using Peers = paxos::Client<int, int, int>::Peers;
+  auto peers = Peers{};
+  for (int i = 0; i < 4; ++i)
+    peers.emplace_back(
+      std::make_unique<Peer<int, int, int>>(11 + i, *servers[i]));
+  peers.emplace_back(std::unique_ptr<paxos::Client<int, int, int>::Peer>(slow));
+  paxos::Client<int, int, int> client(1, std::move(peers));
+  // The round completes with the majority while the slow peer hangs.
+  BOOST_CHECK(!client.choose(42));
+  BOOST_CHECK(!slow->propose_barrier.opened());
+  BOOST_CHECK_EQUAL(client.get(), 42);
+  slow->propose_barrier.open();
+  slow->accept_barrier.open();
+  slow->confirm_barrier.open();
+}
+
+/// Peer answering every call after a fixed delay.
+template <typename T, typename Version, typename ServerId>
+class DelayedPeer
+  : public Peer<T, Version, ServerId>
+{
+public:
+  using Super = Peer<T, Version, ServerId>;
+  using Client = paxos::Client<T, Version, ServerId>;
+
+  DelayedPeer(ServerId id,
+              paxos::Server<T, Version, ServerId>& paxos,
+              elle::Duration delay)
+    : Super{id, paxos}
+    , delay(delay)
+  {}
+
+
+  boost::optional<typename Client::Accepted>
+  propose(
+    typename Client::Quorum const& q,
+    typename Client::Proposal const& p) override
+  {
+    elle::reactor::sleep(this->delay);
+    return Super::propose(q, p);
+  }
+
+
+  typename Client::Proposal
+  accept(typename Client::Quorum const& q,
+         typename Client::Proposal const& p,
+         elle::Option<T, typename Client::Quorum> const& value) override
+  {
+    elle::reactor::sleep(this->delay);
+    return Super::accept(q, p, value);
+  }
+
+
+  void
+  confirm(typename Client::Quorum const& q,
+          typename Client::Proposal const& p) override
+  {
+    elle::reactor::sleep(this->delay);
+    return Super::confirm(q, p);
+  }
+
+  elle::Duration delay;
+};
+
+/// Time rounds over five peers answering after 1, 2, 3, 4 and 100ms.
+ELLE_TEST_SCHEDULED(slow_peer_benchmark)
+{
+  auto const delays = std::vector<elle::Duration>{
+    1_ms, 2_ms, 3_ms, 4_ms, 100_ms};
+  auto servers = std::vector<std::unique_ptr<paxos::Server<int, int, int>>>{};
+  for (int i = 11; i <= 15; ++i)
+    servers.emplace_back(std::make_unique<paxos::Server<int, int, int>>(
+                           i, paxos::Server<int, int, int>::Quorum{
+                             11, 12, 13, 14, 15}));
+  using Peers = paxos::Client<int, int, int>::Peers;
+  auto peers = Peers{};
+  for (int i = 0; i < 5; ++i)
+    peers.emplace_back(std::make_unique<DelayedPeer<int, int, int>>(
+                         11 + i, *servers[i], delays[i]));
+  paxos::Client<int, int, int> client(1, std::move(peers));
+  int const rounds = RUNNING_ON_VALGRIND ? 4 : 20;
+  using Clock = std::chrono::steady_clock;
+  auto times = std::vector<double>{};
+  for (int i = 0; i < rounds; ++i)
+  {
+    auto const start = Clock::now();
+    BOOST_CHECK(!client.choose(i, i));
+    times.emplace_back(std::chrono::duration<double, std::milli>(
+                         Clock::now() - start).count());
+  }
+  std::sort(times.begin(), times.end());
+  BOOST_TEST_MESSAGE(elle::sprintf(
+    "%s rounds with a 100ms peer: %.1fms p50, %.1fms max",
+    rounds, times[rounds / 2], times.back()));
+  // Each phase waits for the third fastest peer, not the slowest one.
+  BOOST_CHECK_LT(times[rounds / 2], 100);
+}
+
+ELLE_TEST_SCHEDULED(lease)
+{
+  paxos::Server<int, int, int> server_1(11, {11, 12, 13});
+  paxos::Server<int, int, int> server_2(12, {11, 12, 13});
+  paxos::Server<int, int, int> server_3(13, {11, 12, 13});
+  using Peers = paxos::Client<int, int, int>::Peers;
+  auto instrumented = std::vector<InstrumentedPeer<int, int, int>*>{
+    new InstrumentedPeer<int, int, int>(11, server_1, true),
+    new InstrumentedPeer<int, int, int>(12, server_2, true),
+    new InstrumentedPeer<int, int, int>(13, server_3, true),
+  };
+  auto peers_1 = Peers{};
+  for (auto peer: instrumented)
+    peers_1.emplace_back(
+      std::unique_ptr<paxos::Client<int, int, int>::Peer>(peer));
+  paxos::Client<int, int, int> client_1(1, std::move(peers_1));
+  client_1.lease(true);
+  auto peers_2 = Peers{};
+  peers_2.emplace_back(std::make_unique<Peer<int, int, int>>(11, server_1));
+  peers_2.emplace_back(std::make_unique<Peer<int, int, int>>(12, server_2));
+  peers_2.emplace_back(std::make_unique<Peer<int, int, int>>(13, server_3));
+  paxos::Client<int, int, int> client_2(2, std::move(peers_2));
+  BOOST_CHECK(!client_1.choose(1, 1));
+  // Holding the lease, client 1 does not propose anymore.
+  for (auto peer: instrumented)
+    peer->propose_barrier.close();
+  BOOST_CHECK(!client_1.choose(2, 2));
+  BOOST_CHECK_EQUAL(client_1.get(), 2);
+  // Client 2 proposing revokes the lease.
+  {
+    auto chosen = client_2.choose(2, 3);
+    BOOST_CHECK(chosen);
+    BOOST_CHECK_EQUAL(chosen->value.get<int>(), 2);
+  }
+  for (auto peer: instrumented)
+    peer->propose_barrier.open();
+  BOOST_CHECK(!client_1.choose(3, 4));
+  BOOST_CHECK_EQUAL(client_2.get(), 4);
+  // Client 1 got the lease back.
+  for (auto peer: instrumented)
+    peer->propose_barrier.close();
+  BOOST_CHECK(!client_1.choose(4, 5));
+  BOOST_CHECK_EQUAL(client_2.get(), 5);
+}
+
+ELLE_TEST_SCHEDULED(lease_race)
+{
+  paxos::Server<int, int, int> server_1(11, {11, 12, 13});
+  paxos::Server<int, int, int> server_2(12, {11, 12, 13});
+  paxos::Server<int, int, int> server_3(13, {11, 12, 13});
+  using Peers = paxos::Client<int, int, int>::Peers;
+  // The lease holder has the greatest id, so the contender's proposal for
+  // the same version and round is lesser.
+  auto peers_1 = Peers{};
+  peers_1.emplace_back(std::make_unique<Peer<int, int, int>>(11, server_1));
+  peers_1.emplace_back(std::make_unique<Peer<int, int, int>>(12, server_2));
+  peers_1.emplace_back(std::make_unique<Peer<int, int, int>>(13, server_3));
+  paxos::Client<int, int, int> client_1(2, std::move(peers_1));
+  client_1.lease(true);
+  auto instrumented = std::vector<InstrumentedPeer<int, int, int>*>{
+    new InstrumentedPeer<int, int, int>(11, server_1),
+    new InstrumentedPeer<int, int, int>(12, server_2),
+    new InstrumentedPeer<int, int, int>(13, server_3),
+  };
+  auto peers_2 = Peers{};
+  for (auto peer: instrumented)
+  {
+    peer->propose_barrier.open();
+    peer->confirm_barrier.open();
+    peers_2.emplace_back(
+      std::unique_ptr<paxos::Client<int, int, int>::Peer>(peer));
+  }
+  paxos::Client<int, int, int> client_2(1, std::move(peers_2));
+  client_2.conflict_backoff(false);
+  BOOST_CHECK(!client_1.choose(1, 1));
+  // Client 2 proposes version 2 but does not accept yet.
+  elle::reactor::Thread t2(
+    "2",
+    [&]
+    {
+      auto chosen = client_2.choose(2, 3);
+      BOOST_CHECK(chosen);
+      BOOST_CHECK_EQUAL(chosen->value.get<int>(), 2);
+    });
+  elle::reactor::wait(instrumented[0]->accept_signal);
+  // Servers refuse client 1's leased accept, as they promised nothing to it,
+  // and it falls back to proposing.
+  BOOST_CHECK(!client_1.choose(2, 2));
+  for (auto peer: instrumented)
+    peer->accept_barrier.open();
+  elle::reactor::wait(t2);
+  BOOST_CHECK_EQUAL(client_1.get(), 2);
+}
+
+ELLE_TEST_SCHEDULED(batch)
+{
+  using Values = std::vector<int>;
+  paxos::Server<Values, int, int> server_1(11, {11, 12, 13});
+  paxos::Server<Values, int, int> server_2(12, {11, 12, 13});
+  paxos::Server<Values, int, int> server_3(13, {11, 12, 13});
+  using Peers = paxos::Client<Values, int, int>::Peers;
+  auto peers = Peers{};
+  peers.emplace_back(std::make_unique<Peer<Values, int, int>>(11, server_1));
+  peers.emplace_back(std::make_unique<Peer<Values, int, int>>(12, server_2));
+  peers.emplace_back(std::make_unique<Peer<Values, int, int>>(13, server_3));
+  paxos::Client<Values, int, int> client(1, std::move(peers));
+  paxos::BatchClient<int, int, int> batch(client, 1, 4, 10_ms);
+  auto versions = std::vector<int>(10);
+  elle::With<elle::reactor::Scope>() << [&] (elle::reactor::Scope& scope)
+  {
+    for (int i = 0; i < 10; ++i)
+      scope.run_background(
+        elle::sprintf("choose %s", i),
+        [&, i]
+        {
+          versions[i] = batch.choose(i);
+        });
+    elle::reactor::wait(scope);
+  };
+  // Full batches are chosen right away, the last one after the delay.
+  BOOST_CHECK_EQUAL(versions, std::vector<int>({1, 1, 1, 1, 2, 2, 2, 2, 3, 3}));
+  BOOST_CHECK_EQUAL(client.get(), Values({8, 9}));
+  BOOST_CHECK_EQUAL(batch.version(), 4);
+}
+
+/// Peer failing proposals with a standard exception while \a fail is set.
+template <typename T, typename Version, typename ServerId>
+class ThrowingPeer
+  : public Peer<T, Version, ServerId>
+{
+public:
+  using Super = Peer<T, Version, ServerId>;
+  using Client = paxos::Client<T, Version, ServerId>;
+
+  ThrowingPeer(ServerId id, paxos::Server<T, Version, ServerId>& paxos)
+    : Super{id, paxos}
+    , fail(true)
+  {}
+
+
+  boost::optional<typename Client::Accepted>
+  propose(
+    typename Client::Quorum const& q,
+    typename Client::Proposal const& p) override
+  {
+    if (this->fail)
+      throw std::runtime_error("peer failure");
+    return Super::propose(q, p);
+  }
+
+  bool fail;
+};
+
+ELLE_TEST_SCHEDULED(batch_failure)
+{
+  using Values = std::vector<int>;
+  paxos::Server<Values, int, int> server_1(11, {11, 12, 13});
+  paxos::Server<Values, int, int> server_2(12, {11, 12, 13});
+  paxos::Server<Values, int, int> server_3(13, {11, 12, 13});
+  using Peers = paxos::Client<Values, int, int>::Peers;
+  auto peer = new ThrowingPeer<Values, int, int>(11, server_1);
+  auto peers = Peers{};
+  peers.emplace_back(
+    std::unique_ptr<paxos::Client<Values, int, int>::Peer>(peer));
+  peers.emplace_back(std::make_unique<Peer<Values, int, int>>(12, server_2));
+  peers.emplace_back(std::make_unique<Peer<Values, int, int>>(13, server_3));
+  paxos::Client<Values, int, int> client(1, std::move(peers));
+  paxos::BatchClient<int, int, int> batch(client, 1, 1, 10_ms);
+  // Any exception fails the batch, but not the following ones.
+  BOOST_CHECK_THROW(batch.choose(1), std::runtime_error);
+  peer->fail = false;
+  BOOST_CHECK_EQUAL(batch.choose(2), 1);
+  BOOST_CHECK_EQUAL(client.get(), Values({2}));
+}
+
+/// Count values committed by 100 writers over five peers answering after
+/// 1ms, for several batch sizes.
+ELLE_TEST_SCHEDULED(batch_benchmark)
+{
+  using Values = std::vector<int>;
+  using Server = paxos::Server<Values, int, int>;
+  auto const duration = std::chrono::milliseconds(500);
+  auto rates = std::map<int, double>{};
+  for (int size: {1, 16, 64, 128})
+  {
+    auto servers = std::vector<std::unique_ptr<Server>>{};
+    for (int i = 11; i <= 15; ++i)
+      servers.emplace_back(
+        std::make_unique<Server>(i, Server::Quorum{11, 12, 13, 14, 15}));
+    using Peers = paxos::Client<Values, int, int>::Peers;
+    auto peers = Peers{};
+    for (int i = 0; i < 5; ++i)
+      peers.emplace_back(std::make_unique<DelayedPeer<Values, int, int>>(
+                           11 + i, *servers[i], 1_ms));
+    paxos::Client<Values, int, int> client(1, std::move(peers));
+    client.lease(true);
+    paxos::BatchClient<int, int, int> batch(client, 1, size, 5_ms);
+    using Clock = std::chrono::steady_clock;
+    auto const start = Clock::now();
+    auto const end = start + duration;
+    int committed = 0;
+    elle::With<elle::reactor::Scope>() << [&] (elle::reactor::Scope& scope)
+    {
+      for (int i = 0; i < 100; ++i)
+        scope.run_background(
+          elle::sprintf("writer %s", i),
+          [&, i]
+          {
+            while (Clock::now() < end)
+            {
+              batch.choose(i);
+              ++committed;
+            }
+          });
+      elle::reactor::wait(scope);
+    };
+    auto const elapsed =
+      std::chrono::duration<double>(Clock::now() - start).count();
+    rates[size] = committed / elapsed;
+    BOOST_TEST_MESSAGE(elle::sprintf(
+      "batches of %s: %.0f values/s in %s rounds",
+      size, rates[size], batch.version() - 1));
+  }
+  BOOST_CHECK_GT(rates[16], 4 * rates[1]);
+}
+
+ELLE_TEST_SCHEDULED(persistence)
+{
+  using Server = paxos::Server<int, int, int>;
+  using Peers = paxos::Client<int, int, int>::Peers;
+  elle::filesystem::TemporaryDirectory d;
+  auto const path = [&] (int id)
+    {
+      return d.path() / elle::sprintf("%s.log", id);
+    };
+  {
+    paxos::Log log_1(path(11));
+    paxos::Log log_2(path(12));
+    paxos::Log log_3(path(13));
+    Server server_1(11, {11, 12, 13}, log_1);
+    Server server_2(12, {11, 12, 13}, log_2);
+    Server server_3(13, {11, 12, 13}, log_3);
+    auto peer_1 = new InstrumentedPeer<int, int, int>(11, server_1, true);
+    auto peer_2 = new InstrumentedPeer<int, int, int>(12, server_2, true);
+    auto peer_3 = new InstrumentedPeer<int, int, int>(13, server_3, true);
+    auto peers = Peers{};
+    peers.emplace_back(std::unique_ptr<paxos::Client<int, int, int>::Peer>(peer_1));
+    peers.emplace_back(std::unique_ptr<paxos::Client<int, int, int>::Peer>(peer_2));
+    peers.emplace_back(std::unique_ptr<paxos::Client<int, int, int>::Peer>(peer_3));
+    paxos::Client<int, int, int> client(1, std::move(peers));
+    BOOST_CHECK(!client.choose(1, 1));
+    BOOST_CHECK(!client.choose(2, 2));
+    // Crash once version 3 is accepted by 11 and 12 but not confirmed.
+    peer_3->fail = true;
+    peer_1->confirm_barrier.close();
+    peer_2->confirm_barrier.close();
+    elle::reactor::Thread::unique_ptr t(
+      new elle::reactor::Thread(
+        "choose",
+        [&]
+        {
+          client.choose(3, 3);
+        }));
+    elle::reactor::wait(
+      elle::reactor::Waitables({&peer_1->confirm_signal,
+                                &peer_2->confirm_signal}));
+  }
+  // Simulate a crash while writing a record.
+  {
+    boost::filesystem::ofstream output(
+      path(11), std::ios::binary | std::ios::app);
+    output.write("\0\0", 2);
+  }
+  {
+    paxos::Log log_1(path(11));
+    paxos::Log log_2(path(12));
+    paxos::Log log_3(path(13));
+    Server server_1(11, {11, 12, 13}, log_1);
+    Server server_2(12, {11, 12, 13}, log_2);
+    Server server_3(13, {11, 12, 13}, log_3);
+    auto peers = Peers{};
+    peers.emplace_back(std::make_unique<Peer<int, int, int>>(11, server_1));
+    peers.emplace_back(std::make_unique<Peer<int, int, int>>(12, server_2));
+    peers.emplace_back(std::make_unique<Peer<int, int, int>>(13, server_3));
+    paxos::Client<int, int, int> client(2, std::move(peers));
+    // The value accepted before the crash is chosen.
+    auto chosen = client.choose(3, 4);
+    BOOST_REQUIRE(chosen);
+    BOOST_CHECK_EQUAL(chosen->value.get<int>(), 3);
+    BOOST_CHECK_EQUAL(client.get(), 3);
+    BOOST_CHECK(!client.choose(4, 4));
+    BOOST_CHECK_EQUAL(client.get(), 4);
+  }
+}
+
+ELLE_TEST_SCHEDULED(persistence_compaction)
+{
+  using Server = paxos::Server<int, int, int>;
+  elle::filesystem::TemporaryDirectory d;
+  auto const path = d.path() / "11.log";
+  {
+    paxos::Log log(path);
+    Server server(11, {11}, log);
+    auto peers = paxos::Client<int, int, int>::Peers{};
+    peers.emplace_back(std::make_unique<Peer<int, int, int>>(11, server));
+    paxos::Client<int, int, int> client(1, std::move(peers));
+    for (int i = 1; i <= 2000; ++i)
+      BOOST_CHECK(!client.choose(i, i));
+    BOOST_CHECK_GT(log.compacted(), 0);
+    BOOST_CHECK_LT(log.size(), 2 * 65536);
+  }
+  paxos::Log log(path);
+  BOOST_CHECK_LT(log.records().size(), 3 * 2000);
+  Server server(11, {11}, log);
+  BOOST_CHECK_EQUAL(server.get({11})->value.get<int>(), 2000);
+}
+
+ELLE_TEST_SCHEDULED(log_torn)
+{
+  elle::filesystem::TemporaryDirectory d;
+  auto const path = d.path() / "log";
+  auto const records = std::vector<elle::Buffer>{
+    elle::Buffer("one"), elle::Buffer("two")};
+  {
+    paxos::Log log(path);
+    for (auto const& record: records)
+      log.append(record);
+    log.sync();
+  }
+  auto const size = boost::filesystem::file_size(path);
+  // A crash may leave zeroes or garbage past the records.
+  {
+    boost::filesystem::ofstream output(
+      path, std::ios::binary | std::ios::app);
+    output.write(std::string(64, '\0').c_str(), 64);
+  }
+  BOOST_CHECK_EQUAL(paxos::Log(path).records(), records);
+  BOOST_CHECK_EQUAL(boost::filesystem::file_size(path), size);
+  {
+    paxos::Log log(path);
+    log.append(elle::Buffer("three"));
+    log.sync();
+  }
+  {
+    boost::filesystem::fstream output(
+      path, std::ios::binary | std::ios::in | std::ios::out);
+    output.seekp(-1, std::ios::end);
+    output.put('x');
+  }
+  BOOST_CHECK_EQUAL(paxos::Log(path).records(), records);
+}
+
+ELLE_TEST_SCHEDULED(log_close)
+{
+  elle::filesystem::TemporaryDirectory d;
+  auto const path = d.path() / "log";
+  auto const record = elle::Buffer(std::string(16 * 1024 * 1024, 'x'));
+  {
+    paxos::Log log(path);
+    log.append(record);
+    // Let the write start.
+    elle::reactor::yield();
+    elle::reactor::yield();
+  }
+  // Closing the log waited for the write.
+  BOOST_CHECK_EQUAL(paxos::Log(path).records().size(), 1u);
+}
+
+ELLE_TEST_SCHEDULED(log_failure)
+{
+  elle::filesystem::TemporaryDirectory d;
+  auto const path = d.path() / "log";
+  paxos::Log log(path);
+  log.append(elle::Buffer("one"));
+  log.sync();
+  // Prevent the compaction from creating its file.
+  auto compaction = path;
+  compaction += ".new";
+  boost::filesystem::create_directory(compaction);
+  log.compact(elle::Buffer("snapshot"));
+  BOOST_CHECK_THROW(log.sync(), elle::Error);
+  // The log refuses records from then on.
+  BOOST_CHECK_THROW(log.append(elle::Buffer("two")), elle::Error);
+  BOOST_CHECK_THROW(log.sync(), elle::Error);
+}
+
+/// Time choosing \a count values with \a choose over three servers, in
+/// memory or logged to disk.
+template <typename T>
+static
+void
+_persistence_benchmark(
+  std::string const& name,
+  bool durable,
+  int count,
+  std::function<void (paxos::Client<T, int, int>&)> const& choose)
+{
+  using Server = paxos::Server<T, int, int>;
+  elle::filesystem::TemporaryDirectory d;
+  auto logs = std::vector<std::unique_ptr<paxos::Log>>{};
+  auto servers = std::vector<std::unique_ptr<Server>>{};
+  for (int i = 11; i <= 13; ++i)
+    if (durable)
+    {
+      logs.emplace_back(
+        std::make_unique<paxos::Log>(d.path() / elle::sprintf("%s.log", i)));
+      servers.emplace_back(std::make_unique<Server>(
+                             i, typename Server::Quorum{11, 12, 13},
+                             *logs.back()));
+    }
+    else
+      servers.emplace_back(std::make_unique<Server>(
+                             i, typename Server::Quorum{11, 12, 13}));
+  auto peers = typename paxos::Client<T, int, int>::Peers{};
+  for (int i = 0; i < 3; ++i)
+    peers.emplace_back(
+      std::make_unique<Peer<T, int, int>>(11 + i, *servers[i]));
+  paxos::Client<T, int, int> client(1, std::move(peers));
+  using Clock = std::chrono::steady_clock;
+  auto const start = Clock::now();
+  choose(client);
+  auto const elapsed =
+    std::chrono::duration<double>(Clock::now() - start).count();
+  BOOST_TEST_MESSAGE(elle::sprintf(
+    "%s, %s: %.0f values/s",
+    name, durable ? "durable" : "in memory", count / elapsed));
+}
+
+ELLE_TEST_SCHEDULED(persistence_benchmark)
+{
+  int const count = RUNNING_ON_VALGRIND ? 50 : 500;
+  for (bool durable: {false, true})
+    _persistence_benchmark<int>(
+      "sequential", durable, count,
+      [&] (paxos::Client<int, int, int>& client)
+      {
+        for (int i = 1; i <= count; ++i)
+          BOOST_CHECK(!client.choose(i, i));
+      });
+  for (bool durable: {false, true})
+    _persistence_benchmark<std::vector<int>>(
+      "batches of 64", durable, 10 * count,
+      [&] (paxos::Client<std::vector<int>, int, int>& client)
+      {
+        paxos::BatchClient<int, int, int> batch(client, 1, 64, 5_ms);
+        elle::With<elle::reactor::Scope>() << [&] (elle::reactor::Scope& scope)
+        {
+          for (int i = 0; i < 10 * count; ++i)
+            scope.run_background(
+              elle::sprintf("choose %s", i),
+              [&, i]
+              {
+                batch.choose(i);
+              });
+          elle::reactor::wait(scope);
+        };
+      });
+}
+
 ELLE_TEST_SCHEDULED(conflict)
 {
   paxos::Server<int, int, int> server_1(11, {11, 12, 13});
@@ -755,6 +1327,35 @@ public:
   elle::reactor::Signal propose_signal, accept_signal;
 };
 
+/// A peer failing after its promise is replaced by one promising late.
+ELLE_TEST_SCHEDULED(late_promise)
+{
+  paxos::Server<int, int, int> server_1(11, {11, 12, 13});
+  paxos::Server<int, int, int> server_2(12, {11, 12, 13});
+  paxos::Server<int, int, int> server_3(13, {11, 12, 13});
+  auto late = new InstrumentedPeer<int, int, int>(13, server_3);
+  late->accept_barrier.open();
+  late->confirm_barrier.open();
+  using Peers = paxos::Client<int, int, int>::Peers;
+  auto peers = Peers{};
+  peers.emplace_back(
+    std::make_unique<ProposeOnlyPeer<int, int, int>>(11, server_1));
+  peers.emplace_back(std::make_unique<Peer<int, int, int>>(12, server_2));
+  peers.emplace_back(std::unique_ptr<paxos::Client<int, int, int>::Peer>(late));
+  paxos::Client<int, int, int> client(1, std::move(peers));
+  elle::reactor::Thread::unique_ptr t(
+    new elle::reactor::Thread(
+      "choose",
+      [&]
+      {
+        BOOST_CHECK(!client.choose(42));
+      }));
+  elle::reactor::wait(late->propose_signal);
+  late->propose_barrier.open();
+  elle::reactor::wait(*t);
+  BOOST_CHECK_EQUAL(client.get(), 42);
+}
+
 namespace quorum_divergence
 {
   ELLE_TEST_SCHEDULED(one_of_three_thinks_quorum_changed)
@@ -982,6 +1583,19 @@ ELLE_TEST_SUITE()
   suite.add(BOOST_TEST_CASE(one_of_three), 0, valgrind(1));
   suite.add(BOOST_TEST_CASE(already_chosen), 0, valgrind(1));
   suite.add(BOOST_TEST_CASE(concurrent), 0, valgrind(1));
+  suite.add(BOOST_TEST_CASE(slow_peer), 0, valgrind(1));
+  suite.add(BOOST_TEST_CASE(slow_peer_benchmark), 0, valgrind(10));
+  suite.add(BOOST_TEST_CASE(lease), 0, valgrind(1));
+  suite.add(BOOST_TEST_CASE(lease_race), 0, valgrind(1));
+  suite.add(BOOST_TEST_CASE(batch), 0, valgrind(1));
+  suite.add(BOOST_TEST_CASE(batch_failure), 0, valgrind(1));
+  suite.add(BOOST_TEST_CASE(batch_benchmark), 0, valgrind(30));
+  suite.add(BOOST_TEST_CASE(persistence), 0, valgrind(1));
+  suite.add(BOOST_TEST_CASE(persistence_compaction), 0, valgrind(5));
+  suite.add(BOOST_TEST_CASE(log_torn), 0, valgrind(1));
+  suite.add(BOOST_TEST_CASE(log_close), 0, valgrind(5));
+  suite.add(BOOST_TEST_CASE(log_failure), 0, valgrind(1));
+  suite.add(BOOST_TEST_CASE(persistence_benchmark), 0, valgrind(60));
   suite.add(BOOST_TEST_CASE(conflict), 0, valgrind(1));
   suite.add(BOOST_TEST_CASE(versions), 0, valgrind(1));
   suite.add(BOOST_TEST_CASE(versions_partial), 0, valgrind(1));
@@ -991,6 +1605,7 @@ ELLE_TEST_SUITE()
   suite.add(BOOST_TEST_CASE(serialization), 0, valgrind(1));
   suite.add(BOOST_TEST_CASE(partial_state), 0, valgrind(5));
   suite.add(BOOST_TEST_CASE(non_partial_state), 0, valgrind(5));
+  suite.add(BOOST_TEST_CASE(late_promise), 0, valgrind(1));
   {
     auto quorum = BOOST_TEST_SUITE("quorum");
     suite.add(quorum);
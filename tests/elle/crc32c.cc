@@ -0,0 +1,75 @@
+#include <elle/crc32c.hh>
+
+#include <chrono>
+
+#include <elle/bytes.hh>
+#include <elle/printf.hh>
+#include <elle/test.hh>
+
+static
+void
+vectors()
+{
+  BOOST_CHECK_EQUAL(elle::crc32c(""), 0u);
+  BOOST_CHECK_EQUAL(elle::crc32c("123456789"), 0xe3069283u);
+  BOOST_CHECK_EQUAL(elle::detail::crc32c_software("123456789"), 0xe3069283u);
+  auto const zeros = elle::Buffer(std::string(32, '\0'));
+  BOOST_CHECK_EQUAL(elle::crc32c(zeros), 0x8a9136aau);
+}
+
+// The hardware and software kernels agree on every length and alignment.
+static
+void
+kernels()
+{
+  auto data = elle::Buffer(1024);
+  for (auto i = 0u; i < data.size(); ++i)
+    data[i] = (i * 7 + 3) % 256;
+  for (auto start = 0; start < 8; ++start)
+    for (auto end = start; end < 300; end += 13)
+    {
+      auto const range = elle::ConstWeakBuffer(data).range(start, end);
+      BOOST_CHECK_EQUAL(elle::crc32c(range),
+                        elle::detail::crc32c_software(range));
+    }
+}
+
+static
+void
+incremental()
+{
+  auto const data = elle::ConstWeakBuffer("some data to checksum");
+  auto const crc = elle::crc32c(data.range(0, 9));
+  BOOST_CHECK_EQUAL(elle::crc32c(data.range(9), crc), elle::crc32c(data));
+}
+
+static
+void
+throughput()
+{
+  for (auto size: {64_kiB, 1_miB, 16_miB})
+  {
+    auto const data = elle::Buffer(std::string(size, 'x'));
+    auto const rounds = 256_miB / size;
+    auto crc = uint32_t(0);
+    auto const start = std::chrono::steady_clock::now();
+    for (auto i = 0u; i < rounds; ++i)
+      crc = elle::crc32c(data, crc);
+    auto const elapsed = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start);
+    BOOST_CHECK_EQUAL(elle::crc32c(data),
+                      elle::detail::crc32c_software(data));
+    BOOST_TEST_MESSAGE(elle::sprintf(
+      "crc32c of %s packets: %s/s", elle::human_data_size(size, false),
+      elle::human_data_size(rounds * size / elapsed.count(), false)));
+  }
+}
+
+ELLE_TEST_SUITE()
+{
+  auto& master = boost::unit_test::framework::master_test_suite();
+  master.add(BOOST_TEST_CASE(vectors), 0, valgrind(1));
+  master.add(BOOST_TEST_CASE(kernels), 0, valgrind(1));
+  master.add(BOOST_TEST_CASE(incremental), 0, valgrind(1));
+  master.add(BOOST_TEST_CASE(throughput), 0, valgrind(10));
+}
@@ -2,11 +2,15 @@
 
 #include <elle/cryptography/SecretKey.hh>
 #include <elle/cryptography/Cipher.hh>
+#include <elle/cryptography/Error.hh>
 #include <elle/cryptography/Oneway.hh>
 #include <elle/cryptography/random.hh>
+#include <elle/cryptography/raw.hh>
 
 #include <elle/serialization/json.hh>
 
+#include <chrono>
+
 /*----------.
 | Represent |
 `----------*/
@@ -242,6 +246,149 @@ test_operate()
   _test_operate_idea();
 }
 
+/*--------.
+| Chunked |
+`--------*/
+
+static
+void
+_test_chunked_x(elle::cryptography::SecretKey const& key,
+                uint32_t const size,
+                int const threads)
+{
+  uint32_t const chunk = 4096;
+  elle::Buffer plain =
+    elle::cryptography::random::generate<elle::Buffer>(size);
+  elle::Buffer code = key.encipher_chunked(plain, threads, chunk);
+
+  BOOST_CHECK_EQUAL(key.decipher_chunked(code, threads), plain);
+  BOOST_CHECK_EQUAL(key.decipher_chunked(code, 3), plain);
+
+  // Decipher chunks individually, from the header and their bytes only.
+  {
+    namespace chunked = elle::cryptography::raw::symmetric::chunked;
+    elle::ConstWeakBuffer header(code.contents(), chunked::header_size);
+    uint32_t const stride = chunk + chunked::tag_size;
+    for (uint32_t i = 0; i * chunk < size; ++i)
+    {
+      auto const offset = chunked::header_size + i * stride;
+      elle::ConstWeakBuffer bytes(code.contents() + offset,
+                                  std::min<uint64_t>(stride,
+                                                     code.size() - offset));
+      BOOST_CHECK_EQUAL(
+        key.decipher_chunk(header, bytes, i, code.size()),
+        elle::ConstWeakBuffer(plain.contents() + i * chunk,
+                              std::min(chunk, size - i * chunk)));
+      // The chunk is bound to its index.
+      BOOST_CHECK_THROW(key.decipher_chunk(header, bytes, i + 1, code.size()),
+                        elle::cryptography::Error);
+    }
+    // The first chunk is not the last one.
+    if (size > chunk)
+    {
+      elle::ConstWeakBuffer first(code.contents() + chunked::header_size,
+                                  stride);
+      BOOST_CHECK_THROW(
+        key.decipher_chunk(header, first, 0, chunked::header_size + stride),
+        elle::cryptography::Error);
+    }
+  }
+
+  // Alter the code.
+  {
+    elle::Buffer altered(code);
+    altered.mutable_contents()[altered.size() - 1] ^= 1;
+    BOOST_CHECK_THROW(key.decipher_chunked(altered, threads),
+                      elle::cryptography::Error);
+  }
+
+  // Append bytes to the code.
+  {
+    elle::Buffer extended(code);
+    extended.append("garbage", 7);
+    BOOST_CHECK_THROW(key.decipher_chunked(extended, threads),
+                      elle::cryptography::Error);
+  }
+
+  // Truncate the code to its first chunk.
+  if (size > chunk)
+  {
+    elle::Buffer truncated(code.contents(), code.size() - (size - chunk) - 16);
+    BOOST_CHECK_THROW(key.decipher_chunked(truncated, threads),
+                      elle::cryptography::Error);
+  }
+}
+
+static
+void
+test_chunked()
+{
+  elle::cryptography::SecretKey key =
+    test_generate_x<256>();
+
+  for (auto size: {0, 1, 4095, 4096, 4097, 40000})
+    for (auto threads: {1, 4})
+      _test_chunked_x(key, size, threads);
+
+  // Swap chunks.
+  {
+    elle::Buffer plain =
+      elle::cryptography::random::generate<elle::Buffer>(3 * 4096);
+    elle::Buffer code = key.encipher_chunked(plain, 1, 4096);
+    auto const first = code.mutable_contents() + code.size() - 3 * (4096 + 16);
+    std::swap_ranges(first, first + 4096 + 16, first + 4096 + 16);
+    BOOST_CHECK_THROW(key.decipher_chunked(code),
+                      elle::cryptography::Error);
+  }
+
+  // Claim chunks too large to fit in memory.
+  {
+    elle::Buffer code = key.encipher_chunked(_message);
+    code.mutable_contents()[9] = 0x7f;
+    BOOST_CHECK_THROW(key.decipher_chunked(code),
+                      elle::cryptography::Error);
+  }
+
+  // Decipher with another key.
+  {
+    elle::Buffer code = key.encipher_chunked(_message);
+    elle::cryptography::SecretKey other =
+      test_generate_x<256>();
+    BOOST_CHECK_THROW(other.decipher_chunked(code),
+                      elle::cryptography::Error);
+  }
+}
+
+static
+void
+test_chunked_benchmark()
+{
+  elle::cryptography::SecretKey key =
+    test_generate_x<256>();
+  uint32_t const size = RUNNING_ON_VALGRIND ? 1 << 20 : 1 << 30;
+  elle::Buffer plain =
+    elle::cryptography::random::generate<elle::Buffer>(size);
+  using Clock = std::chrono::steady_clock;
+  auto const rate = [&] (Clock::time_point start)
+    {
+      return size / std::chrono::duration<double>(Clock::now() - start).count()
+        / (1 << 30);
+    };
+  for (auto threads: {1, 4, 16})
+  {
+    auto start = Clock::now();
+    elle::Buffer code = key.encipher_chunked(plain, threads);
+    auto const encipher = rate(start);
+    start = Clock::now();
+    elle::Buffer deciphered = key.decipher_chunked(code, threads);
+    auto const decipher = rate(start);
+    BOOST_CHECK(deciphered == plain);
+    BOOST_TEST_MESSAGE(elle::sprintf(
+      "%s threads: encipher %.2f GiB/s, decipher %.2f GiB/s",
+      threads, encipher, decipher));
+  }
+}
+
 /*----------.
 | Serialize |
 `----------*/
@@ -353,6 +500,8 @@ ELLE_TEST_SUITE()
   suite->add(BOOST_TEST_CASE(test_generate));
   suite->add(BOOST_TEST_CASE(test_construct));
   suite->add(BOOST_TEST_CASE(test_operate));
+  suite->add(BOOST_TEST_CASE(test_chunked));
+  suite->add(BOOST_TEST_CASE(test_chunked_benchmark), 0, valgrind(60));
   suite->add(BOOST_TEST_CASE(test_serialize));
 
   boost::unit_test::framework::master_test_suite().add(suite);
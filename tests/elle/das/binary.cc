@@ -0,0 +1,274 @@
+#include <chrono>
+#include <cstdint>
+#include <limits>
+
+#include <elle/serialization/binary.hh>
+#include <elle/test.hh>
+
+#include <elle/das/Symbol.hh>
+#include <elle/das/binary.hh>
+#include <elle/das/printer.hh>
+#include <elle/das/serializer.hh>
+
+ELLE_LOG_COMPONENT("das.binary.test");
+
+namespace symbol
+{
+  ELLE_DAS_SYMBOL(x);
+  ELLE_DAS_SYMBOL(y);
+  ELLE_DAS_SYMBOL(origin);
+  ELLE_DAS_SYMBOL(radius);
+  ELLE_DAS_SYMBOL(visible);
+  ELLE_DAS_SYMBOL(f00);
+  ELLE_DAS_SYMBOL(f01);
+  ELLE_DAS_SYMBOL(f02);
+  ELLE_DAS_SYMBOL(f03);
+  ELLE_DAS_SYMBOL(f04);
+  ELLE_DAS_SYMBOL(f05);
+  ELLE_DAS_SYMBOL(f06);
+  ELLE_DAS_SYMBOL(f07);
+  ELLE_DAS_SYMBOL(f08);
+  ELLE_DAS_SYMBOL(f09);
+  ELLE_DAS_SYMBOL(f10);
+  ELLE_DAS_SYMBOL(f11);
+  ELLE_DAS_SYMBOL(f12);
+  ELLE_DAS_SYMBOL(f13);
+  ELLE_DAS_SYMBOL(f14);
+  ELLE_DAS_SYMBOL(f15);
+  ELLE_DAS_SYMBOL(f16);
+  ELLE_DAS_SYMBOL(f17);
+  ELLE_DAS_SYMBOL(f18);
+  ELLE_DAS_SYMBOL(f19);
+}
+
+/// A struct without ctor.
+struct Point
+{
+  bool
+  operator ==(Point const& rhs) const
+  {
+    return this->x == rhs.x && this->y == rhs.y;
+  }
+
+  int32_t x;
+  int64_t y;
+
+  using Model = elle::das::Model<
+    Point, decltype(elle::meta::list(symbol::x, symbol::y))>;
+};
+
+/// A struct with a ctor and a nested struct.
+struct Circle
+{
+  Circle(Point origin, double radius, bool visible)
+    : origin(origin)
+    , radius(radius)
+    , visible(visible)
+  {}
+
+  bool
+  operator ==(Circle const& rhs) const
+  {
+    return this->origin == rhs.origin && this->radius == rhs.radius &&
+      this->visible == rhs.visible;
+  }
+
+  Point origin;
+  double radius;
+  bool visible;
+
+  using Model = elle::das::Model<
+    Circle,
+    decltype(elle::meta::list(symbol::origin,
+                              symbol::radius,
+                              symbol::visible))>;
+};
+
+/// Point, with a narrower x.
+struct SmallPoint
+{
+  int8_t x;
+  int64_t y;
+
+  using Model = elle::das::Model<
+    SmallPoint, decltype(elle::meta::list(symbol::x, symbol::y))>;
+};
+
+/// A typical fixed layout record.
+struct Record
+{
+  bool
+  operator ==(Record const& rhs) const
+  {
+    return std::tie(f00, f01, f02, f03, f04, f05, f06, f07, f08, f09,
+                    f10, f11, f12, f13, f14, f15, f16, f17, f18, f19) ==
+      std::tie(rhs.f00, rhs.f01, rhs.f02, rhs.f03, rhs.f04, rhs.f05,
+               rhs.f06, rhs.f07, rhs.f08, rhs.f09, rhs.f10, rhs.f11,
+               rhs.f12, rhs.f13, rhs.f14, rhs.f15, rhs.f16, rhs.f17,
+               rhs.f18, rhs.f19);
+  }
+
+  int64_t f00;
+  int64_t f01;
+  uint64_t f02;
+  int32_t f03;
+  int32_t f04;
+  uint32_t f05;
+  int16_t f06;
+  uint16_t f07;
+  int8_t f08;
+  uint8_t f09;
+  bool f10;
+  bool f11;
+  double f12;
+  double f13;
+  int64_t f14;
+  int32_t f15;
+  uint32_t f16;
+  int64_t f17;
+  uint64_t f18;
+  double f19;
+
+  using Model = elle::das::Model<
+    Record,
+    decltype(elle::meta::list(
+               symbol::f00, symbol::f01, symbol::f02, symbol::f03,
+               symbol::f04, symbol::f05, symbol::f06, symbol::f07,
+               symbol::f08, symbol::f09, symbol::f10, symbol::f11,
+               symbol::f12, symbol::f13, symbol::f14, symbol::f15,
+               symbol::f16, symbol::f17, symbol::f18, symbol::f19))>;
+};
+
+ELLE_DAS_SERIALIZE(Point);
+ELLE_DAS_SERIALIZE(Circle);
+ELLE_DAS_SERIALIZE(SmallPoint);
+ELLE_DAS_SERIALIZE(Record);
+
+using elle::das::operator <<;
+
+static_assert(elle::das::binary::Layout<Record>::fixed, "Record is fixed");
+static_assert(!elle::das::binary::Layout<std::string>::fixed,
+              "strings are not fixed");
+
+static
+Record
+record(int64_t i)
+{
+  return Record{
+    i, -i * 1000003, (uint64_t(i) * 0x9e3779b97f4a7c15ull) >> 1,
+      int32_t(i * 7919), -int32_t(i), uint32_t(i * 31), int16_t(i),
+      uint16_t(i * 3), int8_t(i), uint8_t(i * 5), i % 2 == 0, i % 3 == 0,
+      i / 3.0, -i * 1.5, i << 20, int32_t(i % 64), uint32_t(i % 8192),
+      -(i << 40), uint64_t(i % 100000), 0.25};
+}
+
+static
+void
+equivalence()
+{
+  for (auto v: {int64_t(0), int64_t(1), int64_t(63), int64_t(64),
+                int64_t(0x1fff), int64_t(0x2000), int64_t(0xfffff),
+                int64_t(0x100000), int64_t(1) << 40,
+                std::numeric_limits<int64_t>::max()})
+    for (auto sign: {1, -1})
+    {
+      auto const p = Point{int32_t(v), sign * v};
+      auto const buffer = elle::das::binary::serialize(p);
+      BOOST_CHECK_EQUAL(buffer, elle::serialization::binary::serialize(p));
+      BOOST_CHECK_EQUAL(elle::das::binary::deserialize<Point>(buffer), p);
+      BOOST_CHECK_EQUAL(
+        elle::serialization::binary::deserialize<Point>(buffer), p);
+    }
+  for (int i = 0; i < 1000; i += 37)
+  {
+    auto const r = record(i);
+    auto const buffer = elle::das::binary::serialize(r);
+    BOOST_CHECK_EQUAL(buffer, elle::serialization::binary::serialize(r));
+    BOOST_CHECK(elle::das::binary::deserialize<Record>(buffer) == r);
+  }
+  // Serializations are appended.
+  auto buffer = elle::Buffer("header");
+  elle::das::binary::serialize(Point{1, 2}, buffer);
+  BOOST_CHECK_EQUAL(buffer, elle::Buffer("header\x00\x01\x02", 9));
+}
+
+static
+void
+nested()
+{
+  auto const c = Circle(Point{-3, 1} , 2.5, true);
+  auto const buffer = elle::das::binary::serialize(c);
+  BOOST_CHECK_EQUAL(buffer, elle::serialization::binary::serialize(c));
+  BOOST_CHECK_EQUAL(elle::das::binary::deserialize<Circle>(buffer), c);
+}
+
+static
+void
+errors()
+{
+  using elle::das::binary::deserialize;
+  auto const buffer = elle::das::binary::serialize(Circle({1, 1}, 1, false));
+  for (auto size = 0u; size < buffer.size(); ++size)
+    BOOST_CHECK_THROW(
+      deserialize<Circle>(elle::ConstWeakBuffer(buffer.contents(), size)),
+                      elle::serialization::Error);
+  BOOST_CHECK_THROW(deserialize<Circle>(elle::ConstWeakBuffer("\x01")),
+                    elle::serialization::Error);
+  auto const large = elle::das::binary::serialize(Point{128, 0});
+  BOOST_CHECK_THROW(deserialize<SmallPoint>(large),
+                    elle::serialization::json::Overflow);
+  auto const small = elle::das::binary::serialize(Point{-128, 0});
+  BOOST_CHECK_EQUAL(deserialize<SmallPoint>(small).x, -128);
+}
+
+static
+void
+benchmark()
+{
+  using Clock = std::chrono::steady_clock;
+  auto const count = 100000;
+  std::vector<Record> records;
+  for (int i = 0; i < count; ++i)
+    records.emplace_back(record(i));
+  auto ns = [&] (Clock::duration d)
+    {
+      return std::chrono::duration<double, std::nano>(d).count() / count;
+    };
+  std::vector<elle::Buffer> buffers;
+  auto start = Clock::now();
+  for (auto const& r: records)
+    buffers.emplace_back(elle::serialization::binary::serialize(r));
+  auto const generic_out = Clock::now() - start;
+  auto generic_sum = int64_t(0);
+  start = Clock::now();
+  for (auto const& b: buffers)
+    generic_sum +=
+      elle::serialization::binary::deserialize<Record>(b).f01;
+  auto const generic_in = Clock::now() - start;
+  start = Clock::now();
+  for (int i = 0; i < count; ++i)
+    buffers[i] = elle::das::binary::serialize(records[i]);
+  auto const fast_out = Clock::now() - start;
+  auto fast_sum = int64_t(0);
+  start = Clock::now();
+  for (auto const& b: buffers)
+    fast_sum += elle::das::binary::deserialize<Record>(b).f01;
+  auto const fast_in = Clock::now() - start;
+  BOOST_CHECK_EQUAL(fast_sum, generic_sum);
+  for (int i = 0; i < count; i += 997)
+    BOOST_CHECK(
+      elle::das::binary::deserialize<Record>(buffers[i]) == records[i]);
+  BOOST_TEST_MESSAGE(elle::sprintf(
+    "20 fields record: serialize %.0fns, deserialize %.0fns, "
+    "with a Serializer %.0fns and %.0fns",
+    ns(fast_out), ns(fast_in), ns(generic_out), ns(generic_in)));
+}
+
+ELLE_TEST_SUITE()
+{
+  auto& suite = boost::unit_test::framework::master_test_suite();
+  suite.add(BOOST_TEST_CASE(equivalence), 0, valgrind(1));
+  suite.add(BOOST_TEST_CASE(nested), 0, valgrind(1));
+  suite.add(BOOST_TEST_CASE(errors), 0, valgrind(1));
+  suite.add(BOOST_TEST_CASE(benchmark), 0, valgrind(10));
+}
@@ -1,11 +1,55 @@
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <new>
+#include <random>
 #include <sstream>
 
+#include <boost/optional.hpp>
+
+#include <json_spirit/reader_template.h>
+#include <json_spirit/value.h>
+
+#include <elle/json/Document.hh>
+#include <elle/json/exceptions.hh>
 #include <elle/json/json.hh>
+#include <elle/json/scan.hh>
+// Count allocations instead of frying them, to compare memory footprints.
+#define ELLE_TEST_NO_MEMFRY
 #include <elle/test.hh>
 #include <elle/log.hh>
 
 ELLE_LOG_COMPONENT("Test");
 
+/// Bytes currently allocated with new.
+static std::atomic<std::size_t> allocated(0);
+
+void*
+operator new(std::size_t size)
+{
+  // Keep the size in front of the block, preserving alignment.
+  auto const res = static_cast<std::max_align_t*>(
+    std::malloc(size + sizeof(std::max_align_t)));
+  if (!res)
+    throw std::bad_alloc();
+  *reinterpret_cast<std::size_t*>(res) = size;
+  allocated += size;
+  return res + 1;
+}
+
+void
+operator delete(void* p) noexcept
+{
+  if (!p)
+    return;
+  auto const block = static_cast<std::max_align_t*>(p) - 1;
+  allocated -= *reinterpret_cast<std::size_t*>(block);
+  std::free(block);
+}
+
 static
 void
 read_int()
@@ -145,6 +189,377 @@ pretty_printer_utf_8()
   BOOST_CHECK_EQUAL(boost::any_cast<std::string>(read_object["utf-8"]), name);
 }
 
+static
+void
+read_numbers()
+{
+  auto array = boost::any_cast<elle::json::Array>(elle::json::read(
+    "[0, -12, 1.5, -2e3, 1E-2, 9223372036854775807, -9223372036854775808, "
+    "18446744073709551615, 1e400, 36893488147419103232]"));
+  BOOST_CHECK_EQUAL(array.size(), 10);
+  BOOST_CHECK_EQUAL(boost::any_cast<int64_t>(array[0]), 0);
+  BOOST_CHECK_EQUAL(boost::any_cast<int64_t>(array[1]), -12);
+  BOOST_CHECK_EQUAL(boost::any_cast<double>(array[2]), 1.5);
+  BOOST_CHECK_EQUAL(boost::any_cast<double>(array[3]), -2000);
+  BOOST_CHECK_EQUAL(boost::any_cast<double>(array[4]), 0.01);
+  BOOST_CHECK_EQUAL(boost::any_cast<int64_t>(array[5]),
+                    std::numeric_limits<int64_t>::max());
+  BOOST_CHECK_EQUAL(boost::any_cast<int64_t>(array[6]),
+                    std::numeric_limits<int64_t>::min());
+  // Unsigned 64 bits values are returned as int64_t, as they always were.
+  BOOST_CHECK_EQUAL(uint64_t(boost::any_cast<int64_t>(array[7])),
+                    std::numeric_limits<uint64_t>::max());
+  BOOST_CHECK_EQUAL(boost::any_cast<double>(array[8]), HUGE_VAL);
+  BOOST_CHECK_EQUAL(boost::any_cast<double>(array[9]), 36893488147419103232.);
+}
+
+static
+void
+read_nested()
+{
+  auto json = elle::json::read(
+    "{\"a\": [true, false, null, {}], \"b\": {\"c\": [[]]}, "
+    "\"d\\\"e\": \"{[:,]}\", \"a\": 1}");
+  auto object = boost::any_cast<elle::json::Object>(json);
+  BOOST_CHECK_EQUAL(object.size(), 3);
+  // The first of duplicate keys wins.
+  auto const& a = boost::any_cast<elle::json::Array const&>(object["a"]);
+  BOOST_CHECK_EQUAL(a.size(), 4);
+  BOOST_CHECK(boost::any_cast<bool>(a[0]));
+  BOOST_CHECK(!boost::any_cast<bool>(a[1]));
+  boost::any_cast<elle::json::NullType>(a[2]);
+  BOOST_CHECK(boost::any_cast<elle::json::Object>(a[3]).empty());
+  auto const& b = boost::any_cast<elle::json::Object const&>(object["b"]);
+  BOOST_CHECK_EQUAL(
+    boost::any_cast<elle::json::Array>(b.at("c")).size(), 1);
+  BOOST_CHECK_EQUAL(boost::any_cast<std::string>(object["d\"e"]), "{[:,]}");
+}
+
+static
+void
+read_surrogate_pair()
+{
+  BOOST_CHECK_EQUAL(
+    boost::any_cast<std::string>(elle::json::read("\"\\ud83d\\ude00\"")),
+    "\xF0\x9F\x98\x80");
+  BOOST_CHECK_EQUAL(
+    boost::any_cast<std::string>(elle::json::read("\"\\\\\\/\\b\\f\\n\\r\\t\"")),
+    "\\/\b\f\n\r\t");
+}
+
+static
+void
+parse_error()
+{
+  for (auto const& text: {"", "  ", "{\"a\" 1}", "{1: 2}", "[1 2]", "[1,",
+                          "\"open", "tru", "nulll", "01", "-", "1.", "1e",
+                          "+1", "\"\\x\"", "\"\\u12\"", "\"\\u12g4\"", "]"})
+  {
+    BOOST_TEST_MESSAGE(elle::sprintf("parse %s", text));
+    BOOST_CHECK_THROW(elle::json::read(text), elle::json::ParseError);
+  }
+  BOOST_CHECK_THROW(elle::json::read("1 2"), elle::Error);
+  BOOST_CHECK_THROW(elle::json::read("{} x"), elle::Error);
+}
+
+/// A stream buffer that fails instead of waiting for more input.
+class Unending
+  : public std::streambuf
+{
+public:
+  Unending(std::string text)
+    : _text(std::move(text))
+  {
+    this->setg(&this->_text[0], &this->_text[0],
+               &this->_text[0] + this->_text.size());
+  }
+
+protected:
+  int_type
+  underflow() override
+  {
+    throw std::runtime_error("read past the available input");
+  }
+
+private:
+  std::string _text;
+};
+
+/// Read values one at a time, leaving what follows in the stream.
+static
+void
+read_stream()
+{
+  std::stringstream input("{\"a\": 1} [2, 3]\n\"four\"");
+  BOOST_CHECK_EQUAL(
+    boost::any_cast<int64_t>(
+      boost::any_cast<elle::json::Object>(elle::json::read(input)).at("a")),
+    1);
+  BOOST_CHECK_EQUAL(input.peek(), ' ');
+  BOOST_CHECK_EQUAL(
+    boost::any_cast<elle::json::Array>(elle::json::read(input)).size(), 2);
+  BOOST_CHECK_EQUAL(
+    boost::any_cast<std::string>(elle::json::read(input)), "four");
+  // A value is read without waiting for the end of the stream.
+  Unending buffer("{\"a\": [1, 2]} {\"b\"");
+  std::istream unending(&buffer);
+  BOOST_CHECK_EQUAL(
+    boost::any_cast<elle::json::Object>(elle::json::read(unending)).size(),
+    1);
+}
+
+/// Check SIMD structure detection against the scalar one, with strings,
+/// escapes and scalars straddling 64 bytes blocks.
+static
+void
+scan()
+{
+  auto generator = std::mt19937(42);
+  char const alphabet[] = "\"\\\\\\{}[]:, \n1a";
+  auto pick = std::uniform_int_distribution<int>(0, sizeof alphabet - 2);
+  for (int i = 0; i < 2000; ++i)
+  {
+    auto text = std::string(i % 300, ' ');
+    for (auto& c: text)
+      c = alphabet[pick(generator)];
+    auto scalar = boost::optional<elle::json::detail::Structure>{};
+    try
+    {
+      scalar = elle::json::detail::structure_scalar(text.data(), text.size());
+    }
+    catch (elle::json::ParseError const&)
+    {
+      BOOST_CHECK_THROW(
+        elle::json::detail::structure(text.data(), text.size()),
+        elle::json::ParseError);
+      continue;
+    }
+    auto const simd = elle::json::detail::structure(text.data(), text.size());
+    BOOST_CHECK_EQUAL_COLLECTIONS(simd.begin(), simd.end(),
+                                  scalar->begin(), scalar->end());
+  }
+  // An escaped backslash and an escaped quote across blocks.
+  for (auto const& end: {"\\\\\" 1", "\\\"\" 1"})
+  {
+    auto const text = '"' + std::string(62, ' ') + end;
+    auto const structure =
+      elle::json::detail::structure(text.data(), text.size());
+    BOOST_CHECK_EQUAL(structure.size(), 3);
+    BOOST_CHECK_EQUAL(structure.at(0), 0);
+    BOOST_CHECK_EQUAL(structure.at(1), 65);
+    BOOST_CHECK_EQUAL(structure.at(2), 67);
+  }
+}
+
+static
+void
+document()
+{
+  auto const document = elle::json::Document(
+    "{\"a\": [true, null, 1, 1.5, \"x\"], \"b\": {\"c\": \"x\"}, "
+    "\"d\\\"e\": \"f\\u00e9\", \"a\": 2}");
+  using Type = elle::json::Document::Type;
+  auto const root = document.root();
+  BOOST_CHECK_EQUAL(root.type(), Type::object);
+  BOOST_CHECK_EQUAL(root.size(), 4);
+  BOOST_CHECK_EQUAL(root.key(2), std::string("d\"e"));
+  BOOST_CHECK_EQUAL(root.value(2).string(), "f\xc3\xa9");
+  BOOST_CHECK(!root.get("e"));
+  // The first of duplicate keys wins.
+  auto const a = root.get("a").get();
+  BOOST_CHECK_EQUAL(a.type(), Type::array);
+  BOOST_CHECK_EQUAL(a.size(), 5);
+  BOOST_CHECK(a[0].boolean());
+  BOOST_CHECK_EQUAL(a[1].type(), Type::null);
+  BOOST_CHECK_EQUAL(a[2].integer(), 1);
+  BOOST_CHECK_EQUAL(a[3].real(), 1.5);
+  auto const c = root.get("b")->get("c").get();
+  BOOST_CHECK_EQUAL(c.string(), "x");
+  // Equal strings are stored once.
+  BOOST_CHECK(a[4].bytes().contents() == c.bytes().contents());
+  BOOST_CHECK_THROW(elle::json::Document("[1] 2"), elle::json::ParseError);
+  BOOST_CHECK_THROW(elle::json::Document("[1"), elle::json::ParseError);
+  {
+    std::stringstream input("{\"a\": 1} junk");
+    BOOST_CHECK_THROW(elle::json::Document{input}, elle::json::ParseError);
+  }
+  {
+    std::stringstream input(" [1, 2] \n");
+    BOOST_CHECK_EQUAL(elle::json::Document(input).root().size(), 2);
+  }
+  {
+    // Only what is already buffered is checked.
+    Unending buffer("[1, 2] ");
+    std::istream input(&buffer);
+    BOOST_CHECK_EQUAL(elle::json::Document(input).root().size(), 2);
+  }
+}
+
+static
+void
+document_json()
+{
+  auto const json = elle::json::read(
+    "{\"list\": [1, -2.5, \"three\", false, null, {\"four\": [[]]}], "
+    "\"empty\": {}}");
+  auto const document = elle::json::Document(json);
+  auto const root = document.root();
+  BOOST_CHECK_EQUAL(root.size(), 2);
+  BOOST_CHECK_EQUAL(root.get("list")->size(), 6);
+  BOOST_CHECK_EQUAL((*root.get("list"))[1].real(), -2.5);
+  BOOST_CHECK_EQUAL((*root.get("list"))[2].string(), "three");
+  std::stringstream expected;
+  elle::json::write(expected, json, false);
+  std::stringstream converted;
+  elle::json::write(converted, root.json(), false);
+  BOOST_CHECK_EQUAL(converted.str(), expected.str());
+}
+
+namespace benchmark
+{
+  /// A bucket listing, like S3 ListObjectsV2 responses.
+  static
+  std::string
+  listing(int count)
+  {
+    auto res = std::string("{\"Name\": \"bucket\", \"KeyCount\": ");
+    res += std::to_string(count) + ", \"Contents\": [";
+    for (int i = 0; i < count; ++i)
+      res += elle::sprintf(
+        "%s{\"Key\": \"photos/2016/%06d/IMG_%04d.jpg\", "
+        "\"LastModified\": \"2016-10-%02dT12:34:56.000Z\", "
+        "\"ETag\": \"\\\"%032x\\\"\", \"Size\": %s, "
+        "\"StorageClass\": \"STANDARD\", "
+        "\"Owner\": {\"ID\": \"%064x\", \"DisplayName\": \"owner\"}}",
+        i ? ", " : "", i, i % 10000, i % 28 + 1, i * 7919, i * 1031 + 4096,
+        i * 104729);
+    res += "], \"IsTruncated\": false}";
+    return res;
+  }
+
+  /// A folder listing, like Dropbox list_folder responses.
+  static
+  std::string
+  folder(int count)
+  {
+    auto res = std::string("{\"entries\": [");
+    for (int i = 0; i < count; ++i)
+      res += elle::sprintf(
+        "%s{\".tag\": \"file\", \"name\": \"Document %s.pdf\", "
+        "\"id\": \"id:a4ayc_80_OEAAAAAAAA%05d\", "
+        "\"client_modified\": \"2016-07-15T12:24:13Z\", "
+        "\"path_lower\": \"/homework/math/document %s.pdf\", "
+        "\"path_display\": \"/Homework/math/Document %s.pdf\", "
+        "\"sharing_info\": {\"read_only\": true, "
+        "\"parent_shared_folder_id\": \"84528192421\", "
+        "\"modified_by\": \"dbid:AAH4f99T0taONIb-OurWxbNQ6ywGRopQngc\"}, "
+        "\"size\": %s, \"content_hash\": \"%064x\", "
+        "\"has_explicit_shared_members\": false, \"ratio\": %s.25}",
+        i ? ", " : "", i, i, i, i, i * 31 + 7, i * 104729, i % 100);
+    res += "], \"cursor\": \"ZtkX9_EHj3x7PMkVuFIhwKYXEpwpLwyxp9vMKomUhllil9q7"
+      "eWiAu\", \"has_more\": false}";
+    return res;
+  }
+
+  /// Compare reading typical API responses with the former json_spirit
+  /// parser.
+  static
+  void
+  read()
+  {
+    using Clock = std::chrono::steady_clock;
+    auto rate = [] (std::size_t size, Clock::duration elapsed)
+      {
+        return elle::sprintf(
+          "%.1f MiB/s",
+          size / std::chrono::duration<double>(elapsed).count() / (1 << 20));
+      };
+    for (auto const& api: {std::make_pair("S3 listing", &listing),
+                           std::make_pair("Dropbox listing", &folder)})
+      for (auto count: {10, 10000})
+      {
+        auto const text = api.second(count);
+        auto const rounds = std::max(1, (32 << 20) / int(text.size()));
+        auto start = Clock::now();
+        for (int i = 0; i < rounds; ++i)
+        {
+          auto const structure =
+            elle::json::detail::structure(text.data(), text.size());
+          BOOST_CHECK(!structure.empty());
+        }
+        auto const scan = Clock::now() - start;
+        start = Clock::now();
+        for (int i = 0; i < rounds; ++i)
+          elle::json::read(text);
+        auto const read = Clock::now() - start;
+        start = Clock::now();
+        for (int i = 0; i < rounds; ++i)
+        {
+          json_spirit::Value value;
+          BOOST_CHECK(json_spirit::read_string(text, value));
+        }
+        auto const spirit = Clock::now() - start;
+        auto const bytes = text.size() * rounds;
+        BOOST_TEST_MESSAGE(elle::sprintf(
+          "%s of %s bytes: scan %s, read %s, json_spirit %s",
+          api.first, text.size(),
+          rate(bytes, scan), rate(bytes, read), rate(bytes, spirit)));
+      }
+  }
+
+  /// Compare the footprint and traversal of a Document and a Json tree.
+  static
+  void
+  document()
+  {
+    using Clock = std::chrono::steady_clock;
+    auto const text = folder(10000);
+    auto before = allocated.load();
+    auto const json = elle::json::read(text);
+    auto const json_memory = allocated - before;
+    before = allocated.load();
+    auto const document = elle::json::Document(text);
+    auto const document_memory = allocated - before;
+    BOOST_CHECK_LT(document_memory, json_memory);
+    auto const rounds = 20;
+    auto start = Clock::now();
+    auto json_sum = int64_t(0);
+    for (int i = 0; i < rounds; ++i)
+      for (auto const& entry: boost::any_cast<elle::json::Array const&>(
+             boost::any_cast<elle::json::Object const&>(json).at("entries")))
+      {
+        auto const& object = boost::any_cast<elle::json::Object const&>(entry);
+        json_sum += boost::any_cast<int64_t>(object.at("size"));
+        json_sum += boost::any_cast<std::string const&>(
+          object.at("path_lower")).size();
+      }
+    auto const json_traversal = Clock::now() - start;
+    start = Clock::now();
+    auto document_sum = int64_t(0);
+    for (int i = 0; i < rounds; ++i)
+    {
+      auto const entries = document.root().get("entries").get();
+      for (std::size_t e = 0; e < entries.size(); ++e)
+      {
+        auto const entry = entries[e];
+        document_sum += entry.get("size")->integer();
+        document_sum += entry.get("path_lower")->bytes().size();
+      }
+    }
+    auto const document_traversal = Clock::now() - start;
+    BOOST_CHECK_EQUAL(document_sum, json_sum);
+    auto ms = [] (Clock::duration d)
+      {
+        return std::chrono::duration<double, std::milli>(d).count();
+      };
+    BOOST_TEST_MESSAGE(elle::sprintf(
+      "%s bytes of JSON: Document takes %s bytes (%s reported), "
+      "Json %s bytes; %s traversals take %.1fms, %.1fms with Json",
+      text.size(), document_memory, document.memory(), json_memory,
+      rounds, ms(document_traversal), ms(json_traversal)));
+  }
+}
+
 ELLE_TEST_SUITE()
 {
   auto timeout = 3;
@@ -159,4 +574,14 @@ ELLE_TEST_SUITE()
   suite.add(BOOST_TEST_CASE(read_escaped_utf_8), 0, timeout);
   suite.add(BOOST_TEST_CASE(write_utf_8), 0, timeout);
   suite.add(BOOST_TEST_CASE(pretty_printer_utf_8), 0, timeout);
+  suite.add(BOOST_TEST_CASE(read_numbers), 0, timeout);
+  suite.add(BOOST_TEST_CASE(read_nested), 0, timeout);
+  suite.add(BOOST_TEST_CASE(read_surrogate_pair), 0, timeout);
+  suite.add(BOOST_TEST_CASE(parse_error), 0, timeout);
+  suite.add(BOOST_TEST_CASE(read_stream), 0, timeout);
+  suite.add(BOOST_TEST_CASE(scan), 0, timeout);
+  suite.add(BOOST_TEST_CASE(document), 0, timeout);
+  suite.add(BOOST_TEST_CASE(document_json), 0, timeout);
+  suite.add(BOOST_TEST_CASE(benchmark::read), 0, 60);
+  suite.add(BOOST_TEST_CASE(benchmark::document), 0, 60);
 }
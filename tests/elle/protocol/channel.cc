@@ -6,6 +6,7 @@ ELLE_LOG_COMPONENT("elle.protocol.Channel.test");
 
 #include <elle/protocol/ChanneledStream.hh>
 #include <elle/protocol/Serializer.hh>
+#include <elle/reactor/Scope.hh>
 #include <elle/reactor/network/Error.hh>
 #include <elle/reactor/network/TCPServer.hh>
 #include <elle/reactor/network/TCPSocket.hh>
@@ -74,6 +75,319 @@ ELLE_TEST_SCHEDULED(eof_read)
     });
 }
 
+ELLE_TEST_SCHEDULED(read_shared)
+{
+  auto data = elle::Buffer(4 * 1024 * 1024);
+  for (auto i = 0u; i < data.size(); ++i)
+    data[i] = i % 251;
+  _eof(
+    [&] (elle::protocol::ChanneledStream& channels)
+    {
+      elle::protocol::Channel c(channels);
+      c.write(data);
+      elle::reactor::sleep();
+    },
+    [&] (elle::protocol::ChanneledStream& channels)
+    {
+      auto c = channels.accept();
+      auto packet = c.read_shared();
+      BOOST_TEST(packet == data);
+      // The ChanneledStream does not hold on the received packet.
+      BOOST_TEST(packet.use_count() == 1);
+    });
+}
+
+ELLE_TEST_SCHEDULED(batch, (elle::Version, version))
+{
+  int const count = 100;
+  elle::reactor::network::TCPServer server;
+  server.listen();
+  elle::reactor::Thread receiver(
+    "receiver",
+    [&]
+    {
+      auto socket = server.accept();
+      elle::protocol::Serializer ser(*socket, version);
+      elle::protocol::ChanneledStream channels(ser);
+      auto received = std::vector<bool>(count, false);
+      for (int i = 0; i < count; ++i)
+      {
+        auto c = channels.accept();
+        auto const packet = c.read();
+        auto const n = std::stoi(packet.string());
+        BOOST_TEST(!received[n]);
+        received[n] = true;
+        c.write(packet);
+      }
+      elle::reactor::sleep();
+    });
+  elle::reactor::network::TCPSocket socket("127.0.0.1", server.port());
+  elle::protocol::Serializer ser(socket, version);
+  elle::protocol::ChanneledStream channels(ser);
+  elle::With<elle::reactor::Scope>() << [&] (elle::reactor::Scope& scope)
+  {
+    for (int i = 0; i < count; ++i)
+      scope.run_background(
+        elle::sprintf("sender %s", i),
+        [&, i]
+        {
+          elle::protocol::Channel c(channels);
+          auto const packet = elle::Buffer(std::to_string(i));
+          c.write(packet);
+          BOOST_TEST(c.read() == packet);
+        });
+    elle::reactor::wait(scope);
+  };
+  BOOST_TEST(channels.packets_sent() == count);
+  BOOST_TEST_MESSAGE(elle::sprintf(
+    "%s: %s packets in %s frames", version,
+    channels.packets_sent(), channels.frames_sent()));
+  if (version >= elle::Version(0, 6, 0))
+    // All senders write during the same scheduler round.
+    BOOST_TEST(channels.frames_sent() == 1);
+  else
+    BOOST_TEST(channels.frames_sent() == count);
+  receiver.terminate_now();
+}
+
+ELLE_TEST_SCHEDULED(flow_control)
+{
+  auto const version = elle::Version(0, 7, 0);
+  auto const window = 64 * 1024;
+  auto const packet = elle::Buffer(16 * 1024);
+  int const in_flight = window / packet.size();
+  elle::reactor::network::TCPServer server;
+  server.listen();
+  elle::reactor::Barrier reading;
+  int read = 0;
+  elle::reactor::Thread receiver(
+    "receiver",
+    [&]
+    {
+      auto socket = server.accept();
+      elle::protocol::Serializer ser(*socket, version);
+      elle::protocol::ChanneledStream channels(ser, window);
+      auto c = channels.accept();
+      elle::reactor::wait(reading);
+      while (true)
+      {
+        BOOST_TEST(c.read().size() == packet.size());
+        ++read;
+      }
+    });
+  elle::reactor::network::TCPSocket socket("127.0.0.1", server.port());
+  elle::protocol::Serializer ser(socket, version);
+  elle::protocol::ChanneledStream channels(ser, window);
+  BOOST_TEST(channels.peer_window() == window);
+  elle::protocol::Channel c(channels);
+  int written = 0;
+  elle::reactor::Thread sender(
+    "sender",
+    [&]
+    {
+      while (true)
+      {
+        c.write(packet);
+        ++written;
+      }
+    });
+  // The sender stops once the window is full, although nothing is read.
+  elle::reactor::sleep(100_ms);
+  BOOST_TEST(written == in_flight);
+  // And resumes as the receiver reads.
+  reading.open();
+  while (written < 16 * in_flight)
+  {
+    BOOST_TEST(written - read <= in_flight);
+    elle::reactor::yield();
+  }
+  sender.terminate_now();
+  receiver.terminate_now();
+}
+
+ELLE_TEST_SCHEDULED(flow_control_broken)
+{
+  auto const version = elle::Version(0, 7, 0);
+  auto const window = 64 * 1024;
+  auto const packet = elle::Buffer(16 * 1024);
+  int const in_flight = window / packet.size();
+  elle::reactor::network::TCPServer server;
+  server.listen();
+  elle::reactor::Thread sender(
+    "sender",
+    [&]
+    {
+      auto socket = server.accept();
+      elle::protocol::Serializer ser(*socket, version);
+      elle::protocol::ChanneledStream channels(ser, window);
+      elle::protocol::Channel c(channels);
+      for (int i = 0; i < in_flight; ++i)
+        c.write(packet);
+    });
+  elle::reactor::network::TCPSocket socket("127.0.0.1", server.port());
+  elle::protocol::Serializer ser(socket, version);
+  elle::protocol::ChanneledStream channels(ser, window);
+  auto c = channels.accept();
+  elle::reactor::wait(sender);
+  // Granting credit to the closed peer fails, but every received packet is
+  // still read.
+  for (int i = 0; i < in_flight; ++i)
+  {
+    BOOST_TEST(c.read().size() == packet.size());
+    elle::reactor::sleep(10_ms);
+  }
+  BOOST_CHECK_THROW(c.read(), elle::reactor::network::ConnectionClosed);
+}
+
+/// Position among \a bulk channels writing \a payload at which a channel
+/// opened last and writing \a packet reaches the peer.
+static
+int
+_overtake(int bulk,
+          elle::Buffer const& payload,
+          elle::Buffer const& packet,
+          int priority)
+{
+  auto const version = elle::Version(0, 7, 0);
+  elle::reactor::network::TCPServer server;
+  server.listen();
+  int position = -1;
+  elle::reactor::Thread receiver(
+    "receiver",
+    [&]
+    {
+      auto socket = server.accept();
+      elle::protocol::Serializer ser(*socket, version);
+      elle::protocol::ChanneledStream channels(ser);
+      // Channels are accepted in the order of their first packet.
+      for (int i = 0; i <= bulk; ++i)
+      {
+        auto c = channels.accept();
+        if (c.read() == packet)
+          position = i;
+      }
+    });
+  elle::reactor::network::TCPSocket socket("127.0.0.1", server.port());
+  elle::protocol::Serializer ser(socket, version);
+  elle::protocol::ChanneledStream channels(ser);
+  elle::With<elle::reactor::Scope>() << [&] (elle::reactor::Scope& scope)
+  {
+    for (int i = 0; i < bulk; ++i)
+      scope.run_background(
+        elle::sprintf("bulk %s", i),
+        [&]
+        {
+          elle::protocol::Channel c(channels);
+          c.write(payload);
+        });
+    scope.run_background(
+      "last",
+      [&]
+      {
+        elle::protocol::Channel c(channels);
+        c.priority(priority);
+        c.write(packet);
+      });
+    elle::reactor::wait(scope);
+  };
+  elle::reactor::wait(receiver);
+  BOOST_TEST(position >= 0);
+  return position;
+}
+
+ELLE_TEST_SCHEDULED(fairness)
+{
+  // A small packet is not stuck behind large ones of the same priority.
+  int const bulk = 8;
+  auto const position = _overtake(
+    bulk, elle::Buffer(1024 * 1024), elle::Buffer("ping"), 0);
+  BOOST_TEST(position < bulk / 2);
+}
+
+ELLE_TEST_SCHEDULED(priority)
+{
+  // A packet of higher priority overtakes packets of the same size.
+  int const bulk = 8;
+  auto const payload = elle::Buffer(1024 * 1024);
+  auto urgent = elle::Buffer(payload.size());
+  for (auto& c: urgent)
+    c = 1;
+  BOOST_TEST(_overtake(bulk, payload, urgent, 1) < bulk / 2);
+}
+
+/// Ping a peer busy reading a bulk transfer slowly, reporting the bulk
+/// transfer backlog and the ping round trip times.
+ELLE_TEST_SCHEDULED(benchmark, (elle::Version, version))
+{
+  auto const bulk = elle::Buffer(256 * 1024);
+  int const count = RUNNING_ON_VALGRIND ? 20 : 200;
+  elle::reactor::network::TCPServer server;
+  server.listen();
+  int64_t sent = 0;
+  int64_t received = 0;
+  elle::reactor::Thread peer(
+    "peer",
+    [&]
+    {
+      auto socket = server.accept();
+      elle::protocol::Serializer ser(*socket, version, false);
+      elle::protocol::ChanneledStream channels(ser);
+      auto reader = channels.accept();
+      elle::reactor::Thread slow(
+        "slow",
+        [&]
+        {
+          while (true)
+          {
+            received += reader.read().size();
+            elle::reactor::sleep(2_ms);
+          }
+        });
+      auto pings = channels.accept();
+      while (true)
+        pings.write(pings.read());
+    });
+  elle::reactor::network::TCPSocket socket("127.0.0.1", server.port());
+  elle::protocol::Serializer ser(socket, version, false);
+  elle::protocol::ChanneledStream channels(ser);
+  elle::protocol::Channel c(channels);
+  elle::reactor::Thread writer(
+    "bulk",
+    [&]
+    {
+      while (true)
+      {
+        c.write(bulk);
+        sent += bulk.size();
+      }
+    });
+  elle::reactor::sleep(10_ms);
+  elle::protocol::Channel pings(channels);
+  pings.priority(1);
+  using Clock = std::chrono::steady_clock;
+  auto times = std::vector<double>{};
+  int64_t backlog = 0;
+  for (int i = 0; i < count; ++i)
+  {
+    auto const start = Clock::now();
+    pings.write(elle::Buffer("ping"));
+    BOOST_TEST(pings.read() == elle::Buffer("ping"));
+    times.emplace_back(std::chrono::duration<double, std::milli>(
+                         Clock::now() - start).count());
+    backlog = std::max(backlog, sent - received);
+    elle::reactor::sleep(5_ms);
+  }
+  writer.terminate_now();
+  peer.terminate_now();
+  std::sort(times.begin(), times.end());
+  BOOST_TEST_MESSAGE(elle::sprintf(
+    "%s: %s KiB backlog at most, ping %.2fms p50, %.2fms p99",
+    version, backlog / 1024, times[count / 2], times[count * 99 / 100]));
+  // Flow control bounds the backlog to the window and the packets in flight.
+  if (version >= elle::Version(0, 7, 0))
+    BOOST_TEST(backlog <= channels.peer_window() + 2 * bulk.size());
+}
+
 ELLE_TEST_SUITE()
 {
   auto& suite = boost::unit_test::framework::master_test_suite();
@@ -83,4 +397,29 @@ ELLE_TEST_SUITE()
     eof->add(ELLE_TEST_CASE(eof_accept, "accept"), 0, valgrind(1));
     eof->add(ELLE_TEST_CASE(eof_read, "read"), 0, valgrind(1));
   }
+  suite.add(BOOST_TEST_CASE(read_shared), 0, valgrind(5));
+  {
+    auto sub = BOOST_TEST_SUITE("batch");
+    suite.add(sub);
+    for (auto const& version: {
+        elle::Version(0, 5, 0),
+        elle::Version(0, 6, 0),
+          })
+      sub->add(ELLE_TEST_CASE(std::bind(batch, version),
+                              elle::sprintf("%s", version)), 0, valgrind(5));
+  }
+  suite.add(BOOST_TEST_CASE(flow_control), 0, valgrind(5));
+  suite.add(BOOST_TEST_CASE(flow_control_broken), 0, valgrind(5));
+  suite.add(BOOST_TEST_CASE(fairness), 0, valgrind(5));
+  suite.add(BOOST_TEST_CASE(priority), 0, valgrind(5));
+  {
+    auto sub = BOOST_TEST_SUITE("benchmark");
+    suite.add(sub);
+    for (auto const& version: {
+        elle::Version(0, 6, 0),
+        elle::Version(0, 7, 0),
+          })
+      sub->add(ELLE_TEST_CASE(std::bind(benchmark, version),
+                              elle::sprintf("%s", version)), 0, valgrind(10));
+  }
 }
@@ -2,6 +2,8 @@
 #include <elle/protocol/RPC.hh>
 #include <elle/protocol/Serializer.hh>
 
+#include <elle/reactor/Channel.hh>
+#include <elle/reactor/Scope.hh>
 #include <elle/reactor/asio.hh>
 #include <elle/reactor/network/Error.hh>
 #include <elle/reactor/network/TCPServer.hh>
@@ -11,6 +13,8 @@
 #include <elle/reactor/semaphore.hh>
 #include <elle/reactor/Thread.hh>
 
+#include <elle/serialization/binary.hh>
+
 #include <elle/test.hh>
 
 ELLE_LOG_COMPONENT("elle.protocol.test");
@@ -20,34 +24,90 @@ struct TestConfig
   bool sync;
   bool checksum;
   elle::Version version;
+  /// Requests the parallel server processes at once, 0 for no limit.
+  int concurrency = 0;
+  /// Whether the server sends the backtraces of failures.
+  bool backtraces = false;
 };
 
 static
 elle::reactor::Thread* suicide_thread(nullptr);
 
+/// Unversioned binary serializers with the stream operators RPC expects.
+struct BinaryOut
+  : public elle::serialization::binary::SerializerOut
+{
+  BinaryOut(elle::Buffer& output)
+    : elle::serialization::binary::SerializerOut(output, false)
+  {}
+
+  template <typename T>
+  BinaryOut&
+  operator <<(T v)
+  {
+    this->serialize_forward(v);
+    return *this;
+  }
+
+  BinaryOut&
+  operator <<(char c)
+  {
+    return *this << static_cast<unsigned char>(c);
+  }
+};
+
+struct BinaryIn
+  : public elle::serialization::binary::SerializerIn
+{
+  BinaryIn(elle::ConstWeakBuffer input)
+    : elle::serialization::binary::SerializerIn(input, false)
+  {}
+
+  template <typename T>
+  BinaryIn&
+  operator >>(T& v)
+  {
+    this->serialize_forward(v);
+    return *this;
+  }
+
+  BinaryIn&
+  operator >>(char& c)
+  {
+    unsigned char v;
+    *this >> v;
+    c = v;
+    return *this;
+  }
+};
+
 struct DummyRPC:
-  public elle::protocol::RPC<elle::serialize::InputBinaryArchive,
-                                elle::serialize::OutputBinaryArchive>
+  public elle::protocol::RPC<BinaryIn, BinaryOut>
 {
   DummyRPC(elle::protocol::ChanneledStream& channels)
-    : elle::protocol::RPC<elle::serialize::InputBinaryArchive,
-                             elle::serialize::OutputBinaryArchive>(channels)
+    : elle::protocol::RPC<BinaryIn, BinaryOut>(channels)
     , answer("answer", *this)
     , square("square", *this)
     , concat("concat", *this)
     , raise("raise", *this)
+    , fail("fail", *this)
     , suicide("suicide", *this)
     , count("count", *this)
     , wait("wait", *this)
+    , delay("delay", *this)
+    , grow("grow", *this)
   {}
 
   RemoteProcedure<int> answer;
   RemoteProcedure<int, int> square;
   RemoteProcedure<std::string, std::string const&, std::string const&> concat;
   RemoteProcedure<void> raise;
+  RemoteProcedure<void> fail;
   RemoteProcedure<void> suicide;
   RemoteProcedure<int> count;
   RemoteProcedure<void> wait;
+  RemoteProcedure<int, int> delay;
+  RemoteProcedure<int> grow;
 };
 
 class RPCServer
@@ -56,6 +116,8 @@ public:
   RPCServer(TestConfig config)
     : _config(config)
     , _counter(0)
+    , _in_flight(0)
+    , _in_flight_max(0)
     , _server()
     , _thread(elle::sprintf("%s runner", *this), [this] { this->_run(); })
   {
@@ -84,8 +146,8 @@ public:
   {
     auto& sched = *elle::reactor::Scheduler::scheduler();
     auto socket = this->_server.accept();
-    elle::protocol::Serializer s(sched, *socket, _config.version, _config.checksum);
-    elle::protocol::ChanneledStream channels(sched, s, _config.version);
+    elle::protocol::Serializer s(*socket, _config.version, _config.checksum);
+    elle::protocol::ChanneledStream channels(sched, s);
 
     DummyRPC rpc(channels);
     rpc.answer = [] { return 42; };
@@ -93,16 +155,15 @@ public:
     rpc.concat = []
       (std::string const& a, std::string const& b) { return a + b; };
     rpc.raise = [] { throw std::runtime_error("blablabla"); };
+    rpc.fail = [] { throw elle::Error("permission denied"); };
+    rpc.backtraces(this->_config.backtraces);
     rpc.suicide = []
       {
         suicide_thread->terminate();
         suicide_thread = nullptr;
-        elle::reactor::yield();
-        elle::reactor::yield();
-        elle::reactor::yield();
-        elle::reactor::yield();
-        elle::reactor::yield();
-        elle::reactor::yield();
+        // Losing the caller terminates the procedure, through the server's
+        // scope when it runs in parallel.
+        elle::reactor::sleep(500_ms);
         BOOST_CHECK(false);
       };
     rpc.count =
@@ -113,12 +174,26 @@ public:
         return this->_counter;
       };
     rpc.wait = [this] { ++this->_counter; elle::reactor::sleep(); };
+    rpc.delay = [this] (int ms)
+      {
+        this->_in_flight_max =
+          std::max(this->_in_flight_max, ++this->_in_flight);
+        elle::reactor::sleep(boost::posix_time::milliseconds(ms));
+        --this->_in_flight;
+        return ms;
+      };
+    rpc.grow = [&rpc]
+      {
+        for (int i = 0; i < 100; ++i)
+          rpc.add<int>(elle::sprintf("extra %s", i));
+        return 100;
+      };
     try
     {
       if (this->_config.sync)
         rpc.run();
       else
-        rpc.parallel_run();
+        rpc.parallel_run(this->_config.concurrency);
     }
     catch (elle::reactor::network::ConnectionClosed&)
     {}
@@ -126,6 +201,8 @@ public:
 
   ELLE_ATTRIBUTE_R(TestConfig, config);
   ELLE_ATTRIBUTE_R(int, counter);
+  ELLE_ATTRIBUTE(int, in_flight);
+  ELLE_ATTRIBUTE_R(int, in_flight_max);
   ELLE_ATTRIBUTE_RX(elle::reactor::Barrier, count_barrier)
   ELLE_ATTRIBUTE(elle::reactor::network::TCPServer, server);
   ELLE_ATTRIBUTE(elle::reactor::Thread, thread);
@@ -140,7 +217,7 @@ ELLE_TEST_SCHEDULED(rpc, (TestConfig, config))
   RPCServer server(config);
   elle::reactor::network::TCPSocket socket("127.0.0.1", server.port());
   elle::protocol::Serializer s(socket, config.version, config.checksum);
-  elle::protocol::ChanneledStream channels(s, config.version);
+  elle::protocol::ChanneledStream channels(s);
   DummyRPC rpc(channels);
   BOOST_CHECK_EQUAL(rpc.answer(), 42);
   BOOST_CHECK_EQUAL(rpc.square(8), 64);
@@ -161,7 +238,7 @@ ELLE_TEST_SCHEDULED(terminate, (TestConfig, config))
     {
       elle::reactor::network::TCPSocket socket("127.0.0.1", server.port());
       elle::protocol::Serializer s(socket, config.version, config.checksum);
-      elle::protocol::ChanneledStream channels(s, config.version);
+      elle::protocol::ChanneledStream channels(s);
       DummyRPC rpc(channels);
       suicide_thread = &thread;
       BOOST_CHECK_THROW(rpc.suicide(), std::runtime_error);
@@ -178,7 +255,7 @@ ELLE_TEST_SCHEDULED(parallel, (TestConfig, config))
   RPCServer server(config);
   elle::reactor::network::TCPSocket socket("127.0.0.1", server.port());
   elle::protocol::Serializer s(socket, config.version, config.checksum);
-  elle::protocol::ChanneledStream channels(s, config.version);
+  elle::protocol::ChanneledStream channels(s);
   DummyRPC rpc(channels);
   std::vector<elle::reactor::Thread*> threads;
   std::list<int> inserted;
@@ -211,6 +288,285 @@ ELLE_TEST_SCHEDULED(parallel, (TestConfig, config))
   BOOST_CHECK(inserted.empty());
 }
 
+/*----------.
+| Pipelined |
+`----------*/
+
+ELLE_TEST_SCHEDULED(pipelined, (TestConfig, config))
+{
+  RPCServer server(config);
+  elle::reactor::network::TCPSocket socket("127.0.0.1", server.port());
+  elle::protocol::Serializer s(socket, config.version, config.checksum);
+  elle::protocol::ChanneledStream channels(s);
+  DummyRPC rpc(channels);
+  // Send all calls before reading any response, which the parallel server
+  // sends back shortest first.
+  auto slow = rpc.delay.async(valgrind(200, 10));
+  auto fast = rpc.delay.async(0);
+  auto square = rpc.square.async(7);
+  auto raise = rpc.raise.async();
+  BOOST_CHECK_EQUAL(square.get(), 49);
+  BOOST_CHECK_EQUAL(fast.get(), 0);
+  BOOST_CHECK_THROW(raise.get(), std::runtime_error);
+  BOOST_CHECK_EQUAL(slow.get(), valgrind(200, 10));
+}
+
+/// Drop calls without reading their response, which must not disturb the
+/// following ones.
+ELLE_TEST_SCHEDULED(abandoned, (TestConfig, config))
+{
+  RPCServer server(config);
+  elle::reactor::network::TCPSocket socket("127.0.0.1", server.port());
+  elle::protocol::Serializer s(socket, config.version, config.checksum);
+  elle::protocol::ChanneledStream channels(s);
+  DummyRPC rpc(channels);
+  {
+    auto square = rpc.square.async(3);
+    auto raise = rpc.raise.async();
+  }
+  BOOST_CHECK_EQUAL(rpc.square(8), 64);
+  BOOST_CHECK_EQUAL(rpc.answer(), 42);
+}
+
+ELLE_TEST_SCHEDULED(concurrency)
+{
+  auto config = TestConfig{false, false, elle::Version(0, 2, 0), 2};
+  RPCServer server(config);
+  elle::reactor::network::TCPSocket socket("127.0.0.1", server.port());
+  elle::protocol::Serializer s(socket, config.version, config.checksum);
+  elle::protocol::ChanneledStream channels(s);
+  DummyRPC rpc(channels);
+  auto calls = std::vector<DummyRPC::PendingCall<int>>{};
+  for (int i = 0; i < 6; ++i)
+    calls.emplace_back(rpc.delay.async(10));
+  for (auto& call: calls)
+    BOOST_CHECK_EQUAL(call.get(), 10);
+  BOOST_CHECK_EQUAL(server.in_flight_max(), 2);
+}
+
+/*-----------.
+| Backtraces |
+`-----------*/
+
+ELLE_TEST_SCHEDULED(backtraces)
+{
+  for (bool backtraces: {false, true})
+    for (bool sync: {true, false})
+    {
+      auto config =
+        TestConfig{sync, false, elle::Version(0, 2, 0), 0, backtraces};
+      RPCServer server(config);
+      elle::reactor::network::TCPSocket socket("127.0.0.1", server.port());
+      elle::protocol::Serializer s(socket, config.version, config.checksum);
+      elle::protocol::ChanneledStream channels(s);
+      DummyRPC rpc(channels);
+      try
+      {
+        rpc.fail();
+        BOOST_FAIL("remote procedure should have failed");
+      }
+      catch (elle::protocol::RPCError const& e)
+      {
+        try
+        {
+          std::rethrow_exception(e.inner_exception());
+        }
+        catch (elle::Exception const& inner)
+        {
+          BOOST_CHECK_EQUAL(inner.what(), std::string("permission denied"));
+          BOOST_CHECK_EQUAL(inner.backtrace().frames().empty(), !backtraces);
+        }
+      }
+      // The connection is still usable.
+      BOOST_CHECK_EQUAL(rpc.answer(), 42);
+    }
+}
+
+/*-----.
+| Grow |
+`-----*/
+
+/// Add procedures from within a call, which must not invalidate the running
+/// one. A procedure the server does not know is unknown until grow adds it,
+/// then non-local since it only has a name there.
+ELLE_TEST_SCHEDULED(grow)
+{
+  auto error = [] (std::function<int ()> const& call)
+    {
+      try
+      {
+        call();
+      }
+      catch (elle::protocol::RPCError const& e)
+      {
+        return std::string(e.what());
+      }
+      BOOST_FAIL("remote procedure should have failed");
+      return std::string();
+    };
+  for (bool sync: {true, false})
+  {
+    auto config = TestConfig{sync, false, elle::Version(0, 2, 0)};
+    RPCServer server(config);
+    elle::reactor::network::TCPSocket socket("127.0.0.1", server.port());
+    elle::protocol::Serializer s(socket, config.version, config.checksum);
+    elle::protocol::ChanneledStream channels(s);
+    DummyRPC rpc(channels);
+    auto extra = rpc.add<int>("extra");
+    BOOST_CHECK_NE(error(extra).find("unknown procedure"), std::string::npos);
+    BOOST_CHECK_EQUAL(rpc.grow(), 100);
+    BOOST_CHECK_EQUAL(rpc.answer(), 42);
+    BOOST_CHECK_NE(error(extra).find("non-local procedure: extra 0"),
+                   std::string::npos);
+  }
+}
+
+/*----------.
+| Benchmark |
+`----------*/
+
+/// Deliver packets read from a Stream after a delay, as a slow link would.
+class LatencyStream
+  : public elle::protocol::Stream
+{
+public:
+  LatencyStream(elle::protocol::Stream& backend, elle::Duration latency)
+    : _backend(backend)
+    , _latency(latency)
+    , _packets()
+    , _thread(elle::sprintf("%s", *this), [this] { this->_receive(); })
+  {}
+
+  ~LatencyStream()
+  {
+    this->_thread.terminate_now();
+  }
+
+  ELLE_attribute_r(elle::Version, version, override)
+  {
+    return this->_backend.version();
+  }
+
+  void
+  print(std::ostream& stream) const override
+  {
+    elle::fprintf(stream, "LatencyStream(%s)", this->_latency);
+  }
+
+protected:
+  elle::Buffer
+  _read() override
+  {
+    auto packet = this->_packets.get();
+    auto const now = boost::posix_time::microsec_clock::universal_time();
+    if (packet.first > now)
+      elle::reactor::sleep(packet.first - now);
+    return std::move(packet.second);
+  }
+
+  void
+  _write(elle::Buffer const& packet) override
+  {
+    this->_backend.write(packet);
+  }
+
+private:
+  void
+  _receive()
+  {
+    try
+    {
+      while (true)
+      {
+        auto packet = this->_backend.read();
+        this->_packets.put(std::make_pair(
+          boost::posix_time::microsec_clock::universal_time() + this->_latency,
+          std::move(packet)));
+      }
+    }
+    catch (elle::Error const&)
+    {
+      this->_packets.raise(std::current_exception());
+    }
+  }
+
+  ELLE_ATTRIBUTE(elle::protocol::Stream&, backend);
+  ELLE_ATTRIBUTE(elle::Duration, latency);
+  ELLE_ATTRIBUTE(
+    (elle::reactor::Channel<std::pair<boost::posix_time::ptime, elle::Buffer>>),
+    packets);
+  ELLE_ATTRIBUTE(elle::reactor::Thread, thread);
+};
+
+ELLE_TEST_SCHEDULED(benchmark)
+{
+  auto config = TestConfig{false, false, elle::Version(0, 2, 0), 0};
+  RPCServer server(config);
+  elle::reactor::network::TCPSocket socket("127.0.0.1", server.port());
+  elle::protocol::Serializer s(socket, config.version, config.checksum);
+  LatencyStream slow(s, 20_ms);
+  elle::protocol::ChanneledStream channels(slow);
+  DummyRPC rpc(channels);
+  int const count = 100;
+  using Clock = std::chrono::steady_clock;
+  auto rate = [&] (Clock::duration elapsed)
+    {
+      return count / std::chrono::duration<double>(elapsed).count();
+    };
+  auto start = Clock::now();
+  for (int i = 0; i < count; ++i)
+    BOOST_CHECK_EQUAL(rpc.square(i), i * i);
+  auto const sequential = Clock::now() - start;
+  start = Clock::now();
+  {
+    auto calls = std::vector<DummyRPC::PendingCall<int>>{};
+    for (int i = 0; i < count; ++i)
+      calls.emplace_back(rpc.square.async(i));
+    for (int i = 0; i < count; ++i)
+      BOOST_CHECK_EQUAL(calls[i].get(), i * i);
+  }
+  auto const pipelined = Clock::now() - start;
+  BOOST_TEST_MESSAGE(elle::sprintf(
+    "%s calls with 20ms latency: %.0f calls/s sequential, %.0f pipelined "
+    "(%.1fx)",
+    count, rate(sequential), rate(pipelined),
+    rate(pipelined) / rate(sequential)));
+}
+
+/// Time successful and failing calls, the latter with and without
+/// backtraces.
+ELLE_TEST_SCHEDULED(call_paths)
+{
+  int const count = RUNNING_ON_VALGRIND ? 100 : 10000;
+  using Clock = std::chrono::steady_clock;
+  auto rate = [&] (Clock::duration elapsed)
+    {
+      return count / std::chrono::duration<double>(elapsed).count();
+    };
+  for (bool backtraces: {false, true})
+  {
+    auto config =
+      TestConfig{true, false, elle::Version(0, 2, 0), 0, backtraces};
+    RPCServer server(config);
+    elle::reactor::network::TCPSocket socket("127.0.0.1", server.port());
+    elle::protocol::Serializer s(socket, config.version, config.checksum);
+    elle::protocol::ChanneledStream channels(s);
+    DummyRPC rpc(channels);
+    auto start = Clock::now();
+    for (int i = 0; i < count; ++i)
+      BOOST_CHECK_EQUAL(rpc.square(i), i * i);
+    auto const success = Clock::now() - start;
+    start = Clock::now();
+    for (int i = 0; i < count; ++i)
+      BOOST_CHECK_THROW(rpc.fail(), elle::protocol::RPCError);
+    auto const failure = Clock::now() - start;
+    BOOST_TEST_MESSAGE(elle::sprintf(
+      "%s calls%s: %.0f successes/s, %.0f failures/s",
+      count, backtraces ? " with backtraces" : "",
+      rate(success), rate(failure)));
+  }
+}
+
 /*--------------.
 | Disconnection |
 `--------------*/
@@ -220,7 +576,7 @@ ELLE_TEST_SCHEDULED(disconnection, (TestConfig, config))
   RPCServer server(config);
   elle::reactor::network::TCPSocket socket("127.0.0.1", server.port());
   elle::protocol::Serializer s(socket, config.version, config.checksum);
-  elle::protocol::ChanneledStream channels(s, config.version);
+  elle::protocol::ChanneledStream channels(s);
   DummyRPC rpc(channels);
   elle::reactor::Thread call_1("call 1",
                          [&]
@@ -245,9 +601,6 @@ ELLE_TEST_SCHEDULED(disconnection, (TestConfig, config))
 | Test suite |
 `-----------*/
 
-#define ELLE_TEST_NAMED_CASE(func, name)\
-  ::boost::unit_test::make_test_case(func, name)
-
 ELLE_TEST_SUITE()
 {
   auto& suite = boost::unit_test::framework::master_test_suite();
@@ -263,12 +616,26 @@ ELLE_TEST_SUITE()
   };
   auto test = [&](std::string const& name, std::function<void(TestConfig)> f)
   {
-    for (int i=0; i<8; ++i)
-      suite.add(
-        BOOST_TEST_CASE(std::bind(f, configs[i])), 0, valgrind(1, 10));
+    auto sub = BOOST_TEST_SUITE(name);
+    suite.add(sub);
+    for (auto const& config: configs)
+      sub->add(
+        ELLE_TEST_CASE(
+          std::bind(f, config),
+          elle::sprintf("%s_%s_%s", config.sync ? "sync" : "async",
+                        config.checksum ? "checksum" : "plain",
+                        config.version)),
+        0, valgrind(1, 10));
   };
   test("rpc", &rpc);
   test("terminate", &terminate);
   test("parallel", &parallel);
+  test("pipelined", &pipelined);
+  test("abandoned", &abandoned);
   test("disconnection", &disconnection);
+  suite.add(BOOST_TEST_CASE(concurrency), 0, valgrind(1, 10));
+  suite.add(BOOST_TEST_CASE(backtraces), 0, valgrind(1, 10));
+  suite.add(BOOST_TEST_CASE(grow), 0, valgrind(1, 10));
+  suite.add(BOOST_TEST_CASE(benchmark), 0, valgrind(10));
+  suite.add(BOOST_TEST_CASE(call_paths), 0, valgrind(30));
 }
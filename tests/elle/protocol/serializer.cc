@@ -3,6 +3,7 @@
 #include <elle/IOStream.hh>
 #include <elle/ScopedAssignment.hh>
 #include <elle/With.hh>
+#include <elle/bytes.hh>
 #include <elle/cast.hh>
 #include <elle/test.hh>
 
@@ -618,6 +619,33 @@ ELLE_TEST_SCHEDULED(corruption)
   CASES(_corruption);
 }
 
+/// Check a corrupted chunk is reported once its whole packet is read, leaving
+/// the stream usable.
+ELLE_TEST_SCHEDULED(chunk_corruption)
+{
+  auto const packet = elle::Buffer(std::string(3 * (2 << 16), 'x'));
+  dialog<SocketInstrumentation>(
+    elle::Version(0, 5, 0),
+    true,
+    [] (SocketInstrumentation& sockets)
+    {
+      sockets.alice_routed(0);
+      sockets.bob_routed(0);
+      // Somewhere in the second chunk.
+      sockets.alice_corrupt(3 * (2 << 15));
+    },
+    [&] (elle::protocol::Serializer& s)
+    {
+      s.write(packet);
+      s.write(packet);
+    },
+    [&] (elle::protocol::Serializer& s)
+    {
+      BOOST_CHECK_THROW(s.read(), elle::protocol::ChecksumError);
+      BOOST_CHECK_EQUAL(s.read(), packet);
+    });
+}
+
 static
 void
 _interruption(elle::Version const& version,
@@ -1091,6 +1119,169 @@ ELLE_TEST_SCHEDULED(read_interruption, (elle::Version, version))
   elle::reactor::wait(elle::reactor::Waitables({&writer, &reader}));
 }
 
+/// Count writes and bytes going through the stream buffer, which copies them.
+class CountingSocket
+  : public elle::reactor::network::TCPSocket
+{
+public:
+  using Super = elle::reactor::network::TCPSocket;
+  using Super::Super;
+
+  void
+  write(elle::ConstWeakBuffer buffer) override
+  {
+    ++this->writes;
+    this->copied += buffer.size();
+    Super::write(buffer);
+  }
+
+  void
+  write(std::vector<elle::ConstWeakBuffer> const& buffers) override
+  {
+    ++this->writes;
+    Super::write(buffers);
+  }
+
+  int writes = 0;
+  elle::Buffer::Size copied = 0;
+};
+
+/// Check packets are sent to sockets with one gather write per chunk, without
+/// copying their payload.
+ELLE_TEST_SCHEDULED(gather)
+{
+  auto const packets = 16;
+  auto const chunk_size = elle::Buffer::Size(2 << 16);
+  auto const packet = elle::Buffer(std::string(4 * chunk_size, 'x'));
+  elle::reactor::network::TCPServer server;
+  server.listen();
+  CountingSocket client("127.0.0.1", server.port());
+  auto peer = server.accept();
+  for (auto const& version: {elle::Version(0, 1, 0),
+                             elle::Version(0, 2, 0),
+                             elle::Version(0, 3, 0),
+                             elle::Version(0, 5, 0)})
+  {
+    std::unique_ptr<elle::protocol::Serializer> alice;
+    std::unique_ptr<elle::protocol::Serializer> bob;
+    elle::reactor::Thread setup(
+      "setup",
+      [&]
+      {
+        bob.reset(new elle::protocol::Serializer(*peer, version));
+      });
+    alice.reset(new elle::protocol::Serializer(client, version));
+    elle::reactor::wait(setup);
+    client.writes = 0;
+    client.copied = 0;
+    elle::reactor::Thread reader(
+      "reader",
+      [&]
+      {
+        for (int i = 0; i < packets; ++i)
+          BOOST_CHECK_EQUAL(bob->read(), packet);
+      });
+    for (int i = 0; i < packets; ++i)
+      alice->write(packet);
+    elle::reactor::wait(reader);
+    ELLE_LOG("%s: %s writes and %s bytes copied per packet",
+             version, double(client.writes) / packets,
+             double(client.copied) / packets);
+    BOOST_CHECK_EQUAL(client.copied, 0u);
+    if (version >= elle::Version(0, 2, 0))
+      BOOST_CHECK_EQUAL(client.writes, packets * 4);
+    else
+      BOOST_CHECK_EQUAL(client.writes, packets);
+  }
+}
+
+/// Check peers agree on the checksum of the older of their versions.
+ELLE_TEST_SCHEDULED(checksum_negotiation)
+{
+  auto const packet = elle::Buffer(std::string(4096, 'x'));
+  auto const v3 = elle::Version(0, 3, 0);
+  auto const v4 = elle::Version(0, 4, 0);
+  auto const v5 = elle::Version(0, 5, 0);
+  for (auto const& versions: {std::make_pair(v3, v4),
+                              std::make_pair(v4, v3),
+                              std::make_pair(v4, v4),
+                              std::make_pair(v4, v5),
+                              std::make_pair(v5, v4),
+                              std::make_pair(v5, v5)})
+  {
+    elle::reactor::network::TCPServer server;
+    server.listen();
+    elle::reactor::network::TCPSocket client("127.0.0.1", server.port());
+    auto peer = server.accept();
+    std::unique_ptr<elle::protocol::Serializer> bob;
+    elle::reactor::Thread setup(
+      "setup",
+      [&]
+      {
+        bob.reset(new elle::protocol::Serializer(*peer, versions.second));
+      });
+    elle::protocol::Serializer alice(client, versions.first);
+    elle::reactor::wait(setup);
+    BOOST_CHECK_EQUAL(alice.version(),
+                      std::min(versions.first, versions.second));
+    BOOST_CHECK_EQUAL(bob->version(), alice.version());
+    elle::reactor::Thread reader(
+      "reader",
+      [&]
+      {
+        BOOST_CHECK_EQUAL(bob->read(), packet);
+        bob->write(packet);
+      });
+    alice.write(packet);
+    BOOST_CHECK_EQUAL(alice.read(), packet);
+    elle::reactor::wait(reader);
+  }
+}
+
+/// Measure the throughput of checksummed packets with the sha1 of versions
+/// before 0.4.0, the CRC-32C of whole packets after and the pipelined CRC-32C
+/// of chunks from 0.5.0.
+ELLE_TEST_SCHEDULED(checksum_throughput)
+{
+  for (auto const& version: {elle::Version(0, 3, 0),
+                             elle::Version(0, 4, 0),
+                             elle::Version(0, 5, 0)})
+    for (auto size: {64_kiB, 1_miB, 16_miB})
+    {
+      elle::reactor::network::TCPServer server;
+      server.listen();
+      elle::reactor::network::TCPSocket client("127.0.0.1", server.port());
+      auto peer = server.accept();
+      std::unique_ptr<elle::protocol::Serializer> bob;
+      elle::reactor::Thread setup(
+        "setup",
+        [&]
+        {
+          bob.reset(new elle::protocol::Serializer(*peer, version));
+        });
+      elle::protocol::Serializer alice(client, version);
+      elle::reactor::wait(setup);
+      auto const packet = elle::Buffer(std::string(size, 'x'));
+      auto const packets = 64_miB / size;
+      auto const start = std::chrono::steady_clock::now();
+      elle::reactor::Thread reader(
+        "reader",
+        [&]
+        {
+          for (auto i = 0u; i < packets; ++i)
+            BOOST_CHECK_EQUAL(bob->read().size(), size);
+        });
+      for (auto i = 0u; i < packets; ++i)
+        alice.write(packet);
+      elle::reactor::wait(reader);
+      auto const elapsed = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start);
+      ELLE_LOG("%s, %s packets: %s/s",
+               version, elle::human_data_size(size, false),
+               elle::human_data_size(packets * size / elapsed.count(), false));
+    }
+}
+
 ELLE_TEST_SUITE()
 {
   auto& suite = boost::unit_test::framework::master_test_suite();
@@ -1099,6 +1290,7 @@ ELLE_TEST_SUITE()
   suite.add(BOOST_TEST_CASE(connection_lost_reader), 0, valgrind(3, 10));
   suite.add(BOOST_TEST_CASE(connection_lost_sender), 0, valgrind(3, 10));
   suite.add(BOOST_TEST_CASE(corruption), 0, valgrind(3, 10));
+  suite.add(BOOST_TEST_CASE(chunk_corruption), 0, valgrind(3, 10));
   suite.add(BOOST_TEST_CASE(interruption), 0, valgrind(6, 15));
   suite.add(BOOST_TEST_CASE(interruption2), 0, valgrind(6, 15));
   {
@@ -1115,4 +1307,7 @@ ELLE_TEST_SUITE()
   suite.add(BOOST_TEST_CASE(eof), 0, valgrind(3));
   suite.add(BOOST_TEST_CASE(message), 0, valgrind(3));
   suite.add(BOOST_TEST_CASE(ping), 0, valgrind(3));
+  suite.add(BOOST_TEST_CASE(gather), 0, valgrind(10));
+  suite.add(BOOST_TEST_CASE(checksum_negotiation), 0, valgrind(3));
+  suite.add(BOOST_TEST_CASE(checksum_throughput), 0, valgrind(60));
 }
@@ -8,6 +8,8 @@
 
 #include <boost/bind.hpp>
 
+ELLE_LOG_COMPONENT("elle.reactor.backend.test");
+
 using elle::reactor::backend::Thread;
 
 elle::reactor::backend::Backend* m = nullptr;
@@ -102,6 +104,69 @@ test_status()
   delete m;
 }
 
+#if defined(REACTOR_CORO_BACKEND_BOOST_CONTEXT)
+static
+void
+stack_pool()
+{
+  elle::reactor::backend::boost_context::Backend backend;
+  m = &backend;
+  backend.stack_pool_capacity(2);
+  auto misses = backend.stack_pool_misses();
+  {
+    auto t1 = backend.make_thread("one", empty);
+    auto t2 = backend.make_thread("two", empty);
+    auto t3 = backend.make_thread("three", empty);
+    t1->step();
+    t2->step();
+    t3->step();
+  }
+  BOOST_CHECK_EQUAL(backend.stack_pool_misses(), misses + 3);
+  BOOST_CHECK_EQUAL(backend.stack_pool_hits(), 0);
+  for (int i = 0; i < 4; ++i)
+  {
+    auto t = backend.make_thread("recycled", one_yield);
+    t->step();
+    t->step();
+  }
+  BOOST_CHECK_EQUAL(backend.stack_pool_misses(), misses + 3);
+  BOOST_CHECK_EQUAL(backend.stack_pool_hits(), 4);
+  backend.stack_pool_capacity(0);
+  {
+    auto t = backend.make_thread("unpooled", empty);
+    t->step();
+  }
+  BOOST_CHECK_EQUAL(backend.stack_pool_misses(), misses + 4);
+  m = nullptr;
+}
+
+/// Spawn and tear down coroutines, with and without stack pooling.
+static
+void
+stack_pool_bench()
+{
+  int const n = RUNNING_ON_VALGRIND ? 1000 : 100000;
+  for (auto capacity: {0, 64})
+  {
+    elle::reactor::backend::boost_context::Backend backend;
+    m = &backend;
+    backend.stack_pool_capacity(capacity);
+    auto start = boost::posix_time::microsec_clock::local_time();
+    for (int i = 0; i < n; ++i)
+    {
+      auto t = backend.make_thread("bench", one_yield);
+      t->step();
+      t->step();
+    }
+    auto elapsed = boost::posix_time::microsec_clock::local_time() - start;
+    ELLE_LOG("pool capacity %s: %s ns per spawn/teardown, %s hits, %s misses",
+             capacity, elapsed.total_nanoseconds() / n,
+             backend.stack_pool_hits(), backend.stack_pool_misses());
+    m = nullptr;
+  }
+}
+#endif
+
 ELLE_TEST_SUITE()
 {
   boost::unit_test::test_suite* backend = BOOST_TEST_SUITE("Backend");
@@ -125,4 +190,8 @@ ELLE_TEST_SUITE()
   TEST(test_deadlock_creation);
   TEST(test_deadlock_switch);
   TEST(test_status);
+#if defined(REACTOR_CORO_BACKEND_BOOST_CONTEXT)
+  backend->add(BOOST_TEST_CASE(stack_pool), 0, 10);
+  backend->add(BOOST_TEST_CASE(stack_pool_bench), 0, valgrind(30, 5));
+#endif
 }
@@ -5,6 +5,7 @@
 #include "reactor.hh"
 
 #include <elle/finally.hh>
+#include <elle/os/environ.hh>
 #include <elle/test.hh>
 
 #include <elle/reactor/BackgroundFuture.hh>
@@ -13,6 +14,7 @@
 #include <elle/reactor/MultiLockBarrier.hh>
 #include <elle/reactor/OrWaitable.hh>
 #include <elle/reactor/Scope.hh>
+#include <elle/reactor/ShardedScheduler.hh>
 #include <elle/reactor/TimeoutGuard.hh>
 #include <elle/reactor/asio.hh>
 #include <elle/reactor/duration.hh>
@@ -703,6 +705,61 @@ namespace barrier
     BOOST_CHECK(!opened);
     b.close();
   }
+
+  /// Count context switches per second with pairs of threads ping-ponging
+  /// through barriers. Set ELLE_REACTOR_BENCH_THREADS to 100000 for the
+  /// full-size run.
+  ELLE_TEST_SCHEDULED(ping_pong)
+  {
+    int const threads = RUNNING_ON_VALGRIND ?
+      100 : elle::os::getenv("ELLE_REACTOR_BENCH_THREADS", 10000);
+    int const rounds = 20;
+    int done = 0;
+    std::vector<std::unique_ptr<elle::reactor::Barrier>> barriers;
+    std::vector<std::unique_ptr<elle::reactor::Thread>> pairs;
+    auto start = boost::posix_time::microsec_clock::local_time();
+    for (int i = 0; i < threads / 2; ++i)
+    {
+      barriers.emplace_back(std::make_unique<elle::reactor::Barrier>());
+      auto& ping = *barriers.back();
+      barriers.emplace_back(std::make_unique<elle::reactor::Barrier>());
+      auto& pong = *barriers.back();
+      pairs.emplace_back(
+        new elle::reactor::Thread(
+          "ping",
+          [&]
+          {
+            for (int r = 0; r < rounds; ++r)
+            {
+              ping.open();
+              elle::reactor::wait(pong);
+              pong.close();
+            }
+            ++done;
+          }));
+      pairs.emplace_back(
+        new elle::reactor::Thread(
+          "pong",
+          [&]
+          {
+            for (int r = 0; r < rounds; ++r)
+            {
+              elle::reactor::wait(ping);
+              ping.close();
+              pong.open();
+            }
+            ++done;
+          }));
+    }
+    for (auto& t: pairs)
+      elle::reactor::wait(*t);
+    auto elapsed = boost::posix_time::microsec_clock::local_time() - start;
+    BOOST_CHECK_EQUAL(done, threads / 2 * 2);
+    // Each round freezes and wakes both threads of a pair once.
+    auto switches = double(threads / 2) * 2 * rounds;
+    ELLE_LOG("%s threads: %s context switches per second",
+             threads, uint64_t(switches * 1000000 / elapsed.total_microseconds()));
+  }
 }
 
 /*------------------.
@@ -3357,6 +3414,217 @@ namespace for_each
       });
     BOOST_CHECK_EQUAL(c, std::vector<int>({1, 1, 2}));
   }
+
+  ELLE_TEST_SCHEDULED(quorum)
+  {
+    std::vector<int> c{0, 1, 2};
+    elle::reactor::Barrier b;
+    auto done = 0;
+    auto reached = elle::reactor::for_each_quorum(
+      c, 2,
+      [&] (int c)
+      {
+        if (c == 2)
+          elle::reactor::wait(b);
+        ++done;
+        return true;
+      });
+    BOOST_CHECK_EQUAL(reached, 2);
+    BOOST_CHECK_EQUAL(done, 2);
+    // The slow call was terminated.
+    b.open();
+    elle::reactor::yield();
+    BOOST_CHECK_EQUAL(done, 2);
+  }
+
+  ELLE_TEST_SCHEDULED(quorum_stragglers)
+  {
+    std::vector<int> c{0, 1, 2};
+    elle::reactor::Barrier b;
+    auto done = std::make_shared<int>(0);
+    auto stragglers = std::vector<elle::reactor::Thread::unique_ptr>{};
+    auto reached = elle::reactor::for_each_quorum(
+      c, 2,
+      [&b, done] (int c)
+      {
+        if (c == 2)
+          elle::reactor::wait(b);
+        ++*done;
+        return true;
+      },
+      "quorum",
+      &stragglers);
+    BOOST_CHECK_EQUAL(reached, 2);
+    BOOST_CHECK_EQUAL(stragglers.size(), 1u);
+    b.open();
+    elle::reactor::wait(*stragglers.front());
+    BOOST_CHECK_EQUAL(*done, 3);
+  }
+
+  ELLE_TEST_SCHEDULED(quorum_unreachable)
+  {
+    std::vector<int> c{0, 1, 2};
+    elle::reactor::Barrier b;
+    auto reached = elle::reactor::for_each_quorum(
+      c, 2,
+      [&] (int c)
+      {
+        if (c == 0)
+          elle::reactor::wait(b);
+        return c == 0;
+      });
+    BOOST_CHECK_EQUAL(reached, 0);
+    BOOST_CHECK(!b.opened());
+  }
+}
+
+/*-----------------.
+| ShardedScheduler |
+`-----------------*/
+
+namespace sharded
+{
+  static
+  void
+  spawn()
+  {
+    elle::reactor::ShardedScheduler shards(4);
+    std::atomic<int> count(0);
+    for (int i = 0; i < 100; ++i)
+      shards.spawn("count", [&] { elle::reactor::yield(); ++count; });
+    shards.stop();
+    shards.run();
+    BOOST_CHECK_EQUAL(count, 100);
+    for (int i = 0; i < shards.size(); ++i)
+      BOOST_CHECK_EQUAL(shards.load(i), 0);
+  }
+
+  static
+  void
+  shard()
+  {
+    elle::reactor::ShardedScheduler shards(3, false);
+    std::atomic<int> mismatches(0);
+    for (int i = 0; i < 30; ++i)
+      shards.spawn(
+        "check",
+        [&, i]
+        {
+          if (elle::reactor::Scheduler::scheduler() != &shards.shard(i % 3))
+            ++mismatches;
+        },
+        i % 3);
+    shards.stop();
+    shards.run();
+    BOOST_CHECK_EQUAL(mismatches, 0);
+    BOOST_CHECK_EQUAL(shards.steals(), 0);
+  }
+
+  static
+  void
+  least_loaded()
+  {
+    elle::reactor::ShardedScheduler shards(3);
+    shards.spawn("one", [] {}, 0);
+    shards.spawn("two", [] {}, 0);
+    shards.spawn("three", [] {}, 2);
+    BOOST_CHECK_EQUAL(shards.least_loaded(), 1);
+    BOOST_CHECK_EQUAL(shards.load(0), 2);
+    shards.stop();
+    shards.run();
+  }
+
+  static
+  void
+  steal()
+  {
+    elle::reactor::ShardedScheduler shards(2);
+    std::atomic<int> foreign(0);
+    for (int i = 0; i < 50; ++i)
+      shards.spawn(
+        "busy",
+        [&]
+        {
+          if (elle::reactor::Scheduler::scheduler() != &shards.shard(0))
+            ++foreign;
+          ::usleep(1000);
+        },
+        0);
+    shards.stop();
+    shards.run();
+    BOOST_CHECK_GT(shards.steals(), 0);
+    BOOST_CHECK_EQUAL(foreign, shards.steals());
+  }
+
+  static
+  void
+  exception()
+  {
+    elle::reactor::ShardedScheduler shards(2, false);
+    shards.spawn("sleeper", [] { elle::reactor::sleep(); }, 0);
+    shards.spawn("thrower", [] { throw BeaconException(); }, 1);
+    BOOST_CHECK_THROW(shards.run(), BeaconException);
+  }
+
+  /// Weak scaling of request/response round-trips: each shard serves the
+  /// same number of client/server coroutine pairs, so requests per second
+  /// should grow linearly with the number of shards, up to the number of
+  /// cores.
+  static
+  void
+  bench()
+  {
+    int const pairs = 64;
+    int const requests = RUNNING_ON_VALGRIND ? 20 : 2000;
+    auto cores = std::max(1u, std::thread::hardware_concurrency());
+    double base = 0;
+    for (unsigned n = 1; n <= std::min(16u, cores); n *= 2)
+    {
+      elle::reactor::ShardedScheduler shards(n, false);
+      std::atomic<uint64_t> served(0);
+      for (unsigned i = 0; i < pairs * n; ++i)
+        shards.spawn(
+          "connection",
+          [&]
+          {
+            elle::reactor::Channel<int> questions;
+            elle::reactor::Channel<int> answers;
+            elle::reactor::Thread server(
+              "server",
+              [&]
+              {
+                for (int r = 0; r < requests; ++r)
+                {
+                  auto q = questions.get();
+                  // Stand for the request decoding and handling.
+                  uint64_t h = q;
+                  for (int k = 0; k < 64; ++k)
+                    h = h * 6364136223846793005ull + 1442695040888963407ull;
+                  answers.put(int(h & 0xff));
+                }
+              });
+            for (int r = 0; r < requests; ++r)
+            {
+              questions.put(r);
+              answers.get();
+            }
+            elle::reactor::wait(server);
+            served += requests;
+          },
+          i % n);
+      shards.stop();
+      auto start = boost::posix_time::microsec_clock::local_time();
+      shards.run();
+      auto elapsed =
+        boost::posix_time::microsec_clock::local_time() - start;
+      BOOST_CHECK_EQUAL(served, uint64_t(pairs) * n * requests);
+      auto rate = served * 1000000. / elapsed.total_microseconds();
+      if (n == 1)
+        base = rate;
+      ELLE_LOG("%s shards: %s requests/s, speedup %s",
+               n, uint64_t(rate), rate / base);
+    }
+  }
 }
 
 /*-----.
@@ -3420,6 +3688,7 @@ ELLE_TEST_SUITE()
     barrier->add(BOOST_TEST_CASE(exception), 0, valgrind(1, 5));
     barrier->add(BOOST_TEST_CASE(inverted), 0, valgrind(1, 5));
     barrier->add(BOOST_TEST_CASE(opened), 0, valgrind(1, 5));
+    barrier->add(BOOST_TEST_CASE(ping_pong), 0, valgrind(60, 5));
   }
 
   boost::unit_test::test_suite* multilock_barrier =
@@ -3629,5 +3898,30 @@ ELLE_TEST_SUITE()
     s->add(BOOST_TEST_CASE(parallel));
     auto parallel_break = &for_each::parallel_break;
     s->add(BOOST_TEST_CASE(parallel_break));
+    auto quorum = &for_each::quorum;
+    s->add(BOOST_TEST_CASE(quorum));
+    auto quorum_stragglers = &for_each::quorum_stragglers;
+    s->add(BOOST_TEST_CASE(quorum_stragglers));
+    auto quorum_unreachable = &for_each::quorum_unreachable;
+    s->add(BOOST_TEST_CASE(quorum_unreachable));
   }
+
+#if !defined INFINIT_ANDROID
+  {
+    boost::unit_test::test_suite* s = BOOST_TEST_SUITE("sharded");
+    boost::unit_test::framework::master_test_suite().add(s);
+    auto spawn = &sharded::spawn;
+    s->add(BOOST_TEST_CASE(spawn), 0, valgrind(1, 5));
+    auto shard = &sharded::shard;
+    s->add(BOOST_TEST_CASE(shard), 0, valgrind(1, 5));
+    auto least_loaded = &sharded::least_loaded;
+    s->add(BOOST_TEST_CASE(least_loaded), 0, valgrind(1, 5));
+    auto steal = &sharded::steal;
+    s->add(BOOST_TEST_CASE(steal), 0, valgrind(3, 5));
+    auto exception = &sharded::exception;
+    s->add(BOOST_TEST_CASE(exception), 0, valgrind(1, 5));
+    auto bench = &sharded::bench;
+    s->add(BOOST_TEST_CASE(bench), 0, valgrind(30, 5));
+  }
+#endif
 }
@@ -1,3 +1,4 @@
+#include <chrono>
 #include <deque>
 #include <list>
 #include <sstream>
@@ -6,8 +7,10 @@
 #include <utility>
 #include <vector>
 
+#include <elle/IOStream.hh>
 #include <elle/attribute.hh>
 #include <elle/filesystem/path.hh>
+#include <elle/json/Document.hh>
 #include <elle/serialization/binary.hh>
 #include <elle/serialization/json.hh>
 #include <elle/serialization/json/Error.hh>
@@ -1489,6 +1492,447 @@ json_optionals()
   }
 }
 
+static
+void
+json_escapes()
+{
+  auto const strings = std::vector<std::string>{
+    "", "plain", "\"quoted\"", "back\\slash", "new\nline\ttab\r",
+    std::string("nul\0byte", 8), "\x01\x1f", "éé 😘", "{[,:]}",
+  };
+  for (auto pretty: {false, true})
+  {
+    std::stringstream stream;
+    {
+      elle::serialization::json::SerializerOut output(stream, false, pretty);
+      output.serialize("strings", strings);
+    }
+    ELLE_LOG("serialized: %s", stream.str());
+    elle::serialization::json::SerializerIn input(stream, false);
+    BOOST_CHECK_EQUAL(input.deserialize<std::vector<std::string>>("strings"),
+                      strings);
+  }
+}
+
+static
+void
+json_unordered_keys()
+{
+  std::stringstream stream(
+    "{"
+    "  \"skipped\": {\"a\": [1, \"]}\", {\"b\": null}], \"c\": \"\\\"\"},"
+    "  \"second\": [1, 2.5, -3e2],"
+    "  \"first\": \"\\u00e9\","
+    "  \"empty\": {}"
+    "}");
+  elle::serialization::json::SerializerIn input(stream, false);
+  BOOST_CHECK_EQUAL(input.deserialize<std::string>("first"), "é");
+  BOOST_CHECK_EQUAL(input.deserialize<std::vector<double>>("second"),
+                    (std::vector<double>{1, 2.5, -300}));
+  BOOST_CHECK_EQUAL(input.deserialize<std::string>("first"), "é");
+  BOOST_CHECK((input.deserialize<std::unordered_map<std::string, int>>(
+                 "empty").empty()));
+}
+
+static
+void
+json_reals()
+{
+  std::stringstream stream;
+  {
+    elle::serialization::json::SerializerOut output(stream, false);
+    output.serialize("reals", std::vector<double>{1, -300, 0.5});
+  }
+  BOOST_CHECK_EQUAL(stream.str(), "{\"reals\":[1.0,-300.0,0.5]}\n");
+}
+
+static
+void
+json_parse_error()
+{
+  for (auto const& json: {"", "{", "{\"a\": }", "{\"a\" 1}", "[1 2]",
+                          "\"unterminated", "tru", "{\"a\": 01}",
+                          "\"\\x\"", "-"})
+  {
+    std::stringstream stream(json);
+    BOOST_CHECK_THROW(elle::serialization::json::SerializerIn(stream, false),
+                      elle::serialization::Error);
+  }
+  // Only the first value is read.
+  std::stringstream stream("{\"a\": 1} {\"a\": 2}");
+  BOOST_CHECK_EQUAL(
+    elle::serialization::json::deserialize<int>(stream, "a", false), 1);
+  BOOST_CHECK_EQUAL(
+    elle::serialization::json::deserialize<int>(stream, "a", false), 2);
+}
+
+static
+void
+json_document()
+{
+  auto const document = elle::json::Document(
+    "{\"count\": 3, \"name\": \"doc\", \"ratio\": 0.5, "
+    "\"tags\": [\"a\", \"b\"], \"data\": \"AQID\"}");
+  // The same document can be read several times.
+  for (int i = 0; i < 2; ++i)
+  {
+    elle::serialization::json::SerializerIn input(document, false);
+    int count;
+    std::string name;
+    double ratio;
+    std::vector<std::string> tags;
+    elle::Buffer data;
+    input.serialize("tags", tags);
+    input.serialize("name", name);
+    input.serialize("count", count);
+    input.serialize("data", data);
+    input.serialize("ratio", ratio);
+    BOOST_CHECK_EQUAL(count, 3);
+    BOOST_CHECK_EQUAL(name, "doc");
+    BOOST_CHECK_EQUAL(ratio, 0.5);
+    BOOST_CHECK_EQUAL(tags, (std::vector<std::string>{"a", "b"}));
+    BOOST_CHECK_EQUAL(data, elle::Buffer("\x01\x02\x03"));
+    BOOST_CHECK_THROW(input.serialize("missing", count),
+                      elle::serialization::MissingKey);
+  }
+}
+
+static
+void
+binary_buffer()
+{
+  auto const text = std::string(300, 'x');
+  auto const big = -(int64_t(1) << 40);
+  auto const ratio = 0.5;
+  auto const small = -7;
+  auto const write = [&] (elle::serialization::binary::SerializerOut& output)
+  {
+    output.serialize("text", text);
+    output.serialize("big", big);
+    output.serialize("ratio", ratio);
+    output.serialize("small", small);
+  };
+  elle::Buffer streamed;
+  {
+    elle::IOStream stream(streamed.ostreambuf());
+    elle::serialization::binary::SerializerOut output(stream, false);
+    BOOST_CHECK_EQUAL(&output.output(), &stream);
+    write(output);
+  }
+  elle::Buffer direct("prefix");
+  {
+    elle::serialization::binary::SerializerOut output(direct, false);
+    write(output);
+  }
+  // Buffers are appended to, in the same format as streams.
+  BOOST_CHECK_EQUAL(direct.range(6), streamed);
+  {
+    elle::serialization::binary::SerializerIn input(
+      elle::ConstWeakBuffer(streamed), false);
+    std::string t;
+    int64_t b;
+    double r;
+    int s;
+    input.serialize("text", t);
+    input.serialize("big", b);
+    input.serialize("ratio", r);
+    input.serialize("small", s);
+    BOOST_CHECK_EQUAL(t, text);
+    BOOST_CHECK_EQUAL(b, big);
+    BOOST_CHECK_EQUAL(r, ratio);
+    BOOST_CHECK_EQUAL(s, small);
+  }
+  {
+    elle::IOStream stream(streamed.istreambuf());
+    elle::serialization::binary::SerializerIn input(stream, false);
+    BOOST_CHECK_EQUAL(&input.input(), &stream);
+    BOOST_CHECK_EQUAL(input.deserialize<std::string>("text"), text);
+  }
+  // Truncated input.
+  for (auto size: {0, 1, 3, 200})
+  {
+    auto truncated = elle::ConstWeakBuffer(streamed.contents(), size);
+    BOOST_CHECK_THROW(
+      {
+        elle::serialization::binary::SerializerIn input(truncated, false);
+        std::string t;
+        input.serialize("text", t);
+      },
+      elle::serialization::Error);
+  }
+}
+
+static
+void
+binary_date()
+{
+  using boost::posix_time::ptime;
+  auto const now = boost::posix_time::microsec_clock().universal_time();
+  // Times written as ISO 8601 strings are still read.
+  {
+    elle::Buffer buffer;
+    {
+      elle::serialization::binary::SerializerOut output(buffer, false);
+      auto iso = boost::posix_time::to_iso_extended_string(now);
+      output.serialize("date", iso);
+      auto utc = std::string("2016-06-20T10:00:00+0200");
+      output.serialize("utc", utc);
+    }
+    elle::serialization::binary::SerializerIn input(
+      elle::ConstWeakBuffer(buffer), false);
+    ptime date;
+    input.serialize("date", date);
+    BOOST_CHECK_EQUAL(date, now);
+    input.serialize("utc", date);
+    BOOST_CHECK_EQUAL(date, boost::posix_time::time_from_string(
+                        "2016-06-20 08:00:00"));
+  }
+  // Times are written natively for targets reading them.
+  auto const current = elle::serialization::Serializer::Versions{
+    {elle::type_info<elle::serialization_tag>(),
+     elle::serialization_tag::version}};
+  for (auto date: {now,
+                   ptime(boost::gregorian::date(1900, 1, 1)),
+                   ptime(boost::posix_time::not_a_date_time),
+                   ptime(boost::posix_time::pos_infin),
+                   ptime(boost::posix_time::neg_infin)})
+  {
+    elle::Buffer buffer;
+    {
+      elle::serialization::binary::SerializerOut output(
+        buffer, current, false);
+      output.serialize("date", date);
+    }
+    elle::serialization::binary::SerializerIn input(
+      elle::ConstWeakBuffer(buffer), false);
+    ptime res;
+    input.serialize("date", res);
+    BOOST_CHECK_EQUAL(res, date);
+  }
+  // Times are still written as ISO 8601 strings for older or unknown
+  // targets.
+  {
+    elle::Buffer iso;
+    {
+      elle::serialization::binary::SerializerOut output(iso, false);
+      auto s = boost::posix_time::to_iso_extended_string(now);
+      output.serialize("date", s);
+    }
+    auto const old = elle::serialization::Serializer::Versions{
+      {elle::type_info<elle::serialization_tag>(), elle::Version(0, 1, 0)}};
+    for (auto const& versions:
+           {old, elle::serialization::Serializer::Versions{}})
+    {
+      elle::Buffer buffer;
+      {
+        elle::serialization::binary::SerializerOut output(
+          buffer, versions, false);
+        auto date = now;
+        output.serialize("date", date);
+      }
+      BOOST_CHECK_EQUAL(buffer, iso);
+    }
+    {
+      elle::Buffer buffer;
+      {
+        elle::serialization::binary::SerializerOut output(buffer, false);
+        auto date = now;
+        output.serialize("date", date);
+      }
+      BOOST_CHECK_EQUAL(buffer, iso);
+    }
+  }
+}
+
+namespace dates
+{
+  struct Record
+  {
+    Record(int id)
+      : id(id)
+      , name(elle::sprintf("record %s", id))
+      , created(boost::posix_time::ptime(boost::gregorian::date(2017, 1, 1)) +
+                boost::posix_time::seconds(id))
+      , modified(this->created + boost::posix_time::microseconds(id))
+    {}
+
+    Record(elle::serialization::SerializerIn& s)
+    {
+      this->serialize(s);
+    }
+
+    void
+    serialize(elle::serialization::Serializer& s)
+    {
+      s.serialize("id", this->id);
+      s.serialize("name", this->name);
+      s.serialize("created", this->created);
+      s.serialize("modified", this->modified);
+    }
+
+    int id;
+    std::string name;
+    boost::posix_time::ptime created;
+    boost::posix_time::ptime modified;
+  };
+
+  /// Decode 1M records with two times each from memory, written as ISO 8601
+  /// strings without a target version and natively for the current one.
+  static
+  void
+  benchmark()
+  {
+    using Clock = std::chrono::steady_clock;
+    auto const count = 1000000;
+    auto records = std::vector<Record>{};
+    for (int i = 0; i < count; ++i)
+      records.emplace_back(i);
+    auto const current = elle::serialization::Serializer::Versions{
+      {elle::type_info<elle::serialization_tag>(),
+       elle::serialization_tag::version}};
+    auto const decode = [&] (elle::Buffer const& buffer)
+      {
+        auto const start = Clock::now();
+        elle::serialization::binary::SerializerIn input(
+          elle::ConstWeakBuffer(buffer), false);
+        auto const read = input.deserialize<std::vector<Record>>("records");
+        auto const elapsed = Clock::now() - start;
+        BOOST_CHECK_EQUAL(read.size(), records.size());
+        BOOST_CHECK(read.back().modified == records.back().modified);
+        return std::chrono::duration<double>(elapsed).count();
+      };
+    elle::Buffer iso;
+    {
+      elle::serialization::binary::SerializerOut output(iso, false);
+      output.serialize("records", records);
+    }
+    elle::Buffer native;
+    {
+      elle::serialization::binary::SerializerOut output(
+        native, current, false);
+      output.serialize("records", records);
+    }
+    BOOST_TEST_MESSAGE(elle::sprintf(
+      "%s records: %.2fs from ISO strings (%s bytes), "
+      "%.2fs natively (%s bytes)",
+      count, decode(iso), iso.size(), decode(native), native.size()));
+  }
+}
+
+namespace streaming
+{
+  class Record
+  {
+  public:
+    Record(int id)
+      : _id(id)
+      , _name(elle::sprintf("record %s", id))
+      , _tags{"alpha", "beta \"quoted\""}
+      , _score(id + 0.5)
+    {}
+
+    Record(elle::serialization::SerializerIn& s)
+    {
+      this->serialize(s);
+    }
+
+    Record(elle::json::Object const& json)
+      : _id(boost::any_cast<int64_t>(json.at("id")))
+      , _name(boost::any_cast<std::string>(json.at("name")))
+      , _score(boost::any_cast<double>(json.at("score")))
+    {
+      for (auto const& tag:
+             boost::any_cast<elle::json::Array const&>(json.at("tags")))
+        this->_tags.emplace_back(boost::any_cast<std::string>(tag));
+    }
+
+    void
+    serialize(elle::serialization::Serializer& s)
+    {
+      s.serialize("id", this->_id);
+      s.serialize("name", this->_name);
+      s.serialize("tags", this->_tags);
+      s.serialize("score", this->_score);
+    }
+
+    elle::json::Json
+    json() const
+    {
+      return elle::json::Object{
+        {"id", int64_t(this->_id)},
+        {"name", this->_name},
+        {"tags", elle::json::Array(this->_tags.begin(), this->_tags.end())},
+        {"score", this->_score},
+      };
+    }
+
+    ELLE_ATTRIBUTE_R(int, id);
+    ELLE_ATTRIBUTE_R(std::string, name);
+    ELLE_ATTRIBUTE_R(std::vector<std::string>, tags);
+    ELLE_ATTRIBUTE_R(double, score);
+  };
+
+  /// Compare the streaming serializers with writing and reading the
+  /// equivalent JSON document, as the serializers formerly did.
+  static
+  void
+  benchmark()
+  {
+    using Clock = std::chrono::steady_clock;
+    auto rate = [] (std::size_t size, Clock::duration elapsed)
+      {
+        return elle::sprintf(
+          "%.1f MiB/s",
+          size / std::chrono::duration<double>(elapsed).count() / (1 << 20));
+      };
+    for (auto size: {1 << 10, 1 << 20, 100 << 20})
+    {
+      auto records = std::vector<Record>{};
+      for (int i = 0; records.size() * 80 < std::size_t(size); ++i)
+        records.emplace_back(i);
+      auto start = Clock::now();
+      std::stringstream streamed;
+      {
+        elle::serialization::json::SerializerOut output(streamed, false);
+        output.serialize("records", records);
+      }
+      auto const streamed_write = Clock::now() - start;
+      start = Clock::now();
+      std::stringstream document;
+      elle::json::write(
+        document,
+        elle::json::Object{
+          {"records", elle::json::make_array(
+              records, [] (Record const& r) { return r.json(); })}});
+      auto const document_write = Clock::now() - start;
+      start = Clock::now();
+      {
+        elle::serialization::json::SerializerIn input(streamed, false);
+        auto const read = input.deserialize<std::vector<Record>>("records");
+        BOOST_CHECK_EQUAL(read.size(), records.size());
+      }
+      auto const streamed_read = Clock::now() - start;
+      start = Clock::now();
+      {
+        auto const json = elle::json::read(document);
+        auto read = std::vector<Record>{};
+        for (auto const& r: boost::any_cast<elle::json::Array const&>(
+               boost::any_cast<elle::json::Object const&>(json).at("records")))
+          read.emplace_back(boost::any_cast<elle::json::Object const&>(r));
+        BOOST_CHECK_EQUAL(read.size(), records.size());
+      }
+      auto const document_read = Clock::now() - start;
+      auto const bytes = streamed.str().size();
+      BOOST_TEST_MESSAGE(elle::sprintf(
+        "%s bytes: write %s streamed, %s with a document, "
+        "read %s streamed, %s with a document",
+        bytes,
+        rate(bytes, streamed_write), rate(bytes, document_write),
+        rate(bytes, streamed_read), rate(bytes, document_read)));
+    }
+  }
+}
+
 template <typename Format>
 static
 void
@@ -1717,6 +2161,33 @@ convert()
   }
 }
 
+/// Round-trip small messages, the bulk of RPC traffic, and measure their cost.
+template <typename Format>
+static
+void
+small_messages()
+{
+  auto const iterations = 100000;
+  auto const allocations = elle::Buffer::allocations();
+  auto const reallocations = elle::Buffer::reallocations();
+  auto const start = std::chrono::steady_clock::now();
+  auto last = Point();
+  for (int i = 0; i < iterations; ++i)
+  {
+    auto const buffer = elle::serialization::serialize<Format>(Point(i, -i));
+    last = elle::serialization::deserialize<Format, Point>(buffer);
+  }
+  auto const elapsed = std::chrono::steady_clock::now() - start;
+  BOOST_CHECK_EQUAL(last, Point(iterations - 1, 1 - iterations));
+  BOOST_TEST_MESSAGE(elle::sprintf(
+    "small message round-trip: %sns, %s buffer allocations, "
+    "%s reallocations",
+    std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() /
+      iterations,
+    (elle::Buffer::allocations() - allocations) * 1.0 / iterations,
+    (elle::Buffer::reallocations() - reallocations) * 1.0 / iterations));
+}
+
 #define FOR_ALL_SERIALIZATION_TYPES(Name)                               \
   {                                                                     \
     boost::unit_test::test_suite* subsuite = BOOST_TEST_SUITE(#Name);   \
@@ -1782,6 +2253,7 @@ ELLE_TEST_SUITE()
   FOR_ALL_SERIALIZATION_TYPES(exceptions);
   FOR_ALL_SERIALIZATION_TYPES(text_parser);
   FOR_ALL_SERIALIZATION_TYPES(convert);
+  FOR_ALL_SERIALIZATION_TYPES(small_messages);
   suite.add(BOOST_TEST_CASE(in_place));
   suite.add(BOOST_TEST_CASE(unordered_map_string_legacy));
   suite.add(BOOST_TEST_CASE(json_type_error));
@@ -1790,4 +2262,13 @@ ELLE_TEST_SUITE()
   suite.add(BOOST_TEST_CASE(json_iso8601));
   suite.add(BOOST_TEST_CASE(json_unicode_surrogate));
   suite.add(BOOST_TEST_CASE(json_optionals));
+  suite.add(BOOST_TEST_CASE(json_escapes));
+  suite.add(BOOST_TEST_CASE(json_unordered_keys));
+  suite.add(BOOST_TEST_CASE(json_reals));
+  suite.add(BOOST_TEST_CASE(json_parse_error));
+  suite.add(BOOST_TEST_CASE(json_document));
+  suite.add(BOOST_TEST_CASE(binary_buffer));
+  suite.add(BOOST_TEST_CASE(binary_date));
+  suite.add(BOOST_TEST_CASE(streaming::benchmark));
+  suite.add(BOOST_TEST_CASE(dates::benchmark));
 }